@@ -0,0 +1,191 @@
+/****************************************************************************
+ Module
+   Battery.c
+
+ Revision
+   1.0.1
+
+ Description
+   Watches the drive pack through a divider on A/D pin 7 and scales PWM
+   duties so the motors see the same average voltage as the pack drains.
+   The drive and flywheel duties were tuned on a full pack at 
+   BATTERY_NOMINAL; at a lower reading every duty handed to the PWM is
+   raised by NOMINAL/reading, so timed moves keep their distance.
+
+ Notes
+   CheckBattery samples every BATTERY_TIME and runs a first order filter
+   in fixed point: the filtered reading is kept scaled by 2^FILTER_SHIFT.
+   It never posts an event.
+   The factor is in 256ths and held between COMP_MIN and COMP_MAX. 
+   Below BATTERY_MISSING the divider is taken as unplugged and the factor
+   stays at 1.
+   A duty is rescaled when it is written, and when the factor changes the
+   ramped outputs are all written again (RewriteRamps), so a held duty
+   follows the pack too.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 05/01/14 12:00 PS      Held duties rewritten when the factor changes
+ 04/28/14 11:20 PS      Filter drops the old share before adding the reading
+ 04/27/14 11:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Timers.h"
+#include "Battery.h"
+#include "Ramp.h"
+#include "Sensors.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+//A/D reading of the pack the duties were tuned on
+#ifndef BATTERY_NOMINAL
+#define BATTERY_NOMINAL 820
+#endif
+#define BATTERY_MISSING 100
+
+#define BATTERY_TIME 49      //sample period (timer ticks), about 50ms
+#define FILTER_SHIFT 4       //time constant of 16 samples, about 0.8s
+
+//Limits on the factor: 0.9 for a pack above nominal, 1.5 for a flat one
+#define COMP_MIN 230
+#define COMP_MAX 384
+
+/*---------------------------- Module Functions ---------------------------*/
+static void UpdateComp(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   bool Started;
+   unsigned int LastSample;
+   unsigned int Filtered;   //reading * 2^FILTER_SHIFT
+   unsigned int Comp;
+} BatteryVars_t;
+
+static BatteryVars_t Vars = {false, 0, 0, BATTERY_UNITY};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   CheckBattery
+
+ Returns
+   bool, always false as nothing is posted
+
+ Description
+   Event checker. Takes a pack reading every BATTERY_TIME and updates the
+   compensation factor, writing the motor outputs again if it changed.
+****************************************************************************/
+bool CheckBattery(void)
+{
+   unsigned int Now = ES_Timer_GetTime();
+   unsigned int Reading;
+   unsigned int LastComp = Vars.Comp;
+   
+   if(Vars.Started && (unsigned int)(Now - Vars.LastSample) < BATTERY_TIME)
+      return false;
+   Vars.LastSample = Now;
+   
+   Reading = (unsigned int)ReadSensor(SENSOR_BATTERY);
+   if(!Vars.Started)
+   {
+      Vars.Filtered = Reading << FILTER_SHIFT;
+      Vars.Started = true;
+   }
+   else
+   {
+      Vars.Filtered -= Vars.Filtered >> FILTER_SHIFT;
+      Vars.Filtered += Reading;
+   }
+   UpdateComp();
+   if(Vars.Comp != LastComp)
+      RewriteRamps();
+   return false;
+}
+
+/****************************************************************************
+ Function
+   GetBatteryReading
+
+ Returns
+   unsigned int, filtered pack reading in A/D counts
+****************************************************************************/
+unsigned int GetBatteryReading(void)
+{
+   return Vars.Filtered >> FILTER_SHIFT;
+}
+
+/****************************************************************************
+ Function
+   GetBatteryComp
+
+ Returns
+   unsigned int, the compensation factor, BATTERY_UNITY for none
+****************************************************************************/
+unsigned int GetBatteryComp(void)
+{
+   return Vars.Comp;
+}
+
+/****************************************************************************
+ Function
+   CompensateDuty
+
+ Parameters
+   signed int : duty as tuned on a full pack, either sign
+
+ Returns
+   signed int, the duty to write for the pack as it is now. Range limits
+   are up to the caller.
+****************************************************************************/
+signed int CompensateDuty(signed int Duty)
+{
+   return (signed int)(((signed long)Duty * Vars.Comp) / BATTERY_UNITY);
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetBatteryVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetBatteryVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Function: UpdateComp
+  -----------------------
+  Factor = nominal/reading in 256ths, clamped.
+*/
+static void UpdateComp(void)
+{
+   unsigned int Reading = Vars.Filtered >> FILTER_SHIFT;
+   unsigned long Comp;
+   
+   if(Reading < BATTERY_MISSING)
+   {
+      Vars.Comp = BATTERY_UNITY;
+      return;
+   }
+   Comp = ((unsigned long)BATTERY_NOMINAL * BATTERY_UNITY) / Reading;
+   if(Comp < COMP_MIN)
+      Comp = COMP_MIN;
+   else if(Comp > COMP_MAX)
+      Comp = COMP_MAX;
+   Vars.Comp = (unsigned int)Comp;
+}
+/*------------------------------ End of file ------------------------------*/
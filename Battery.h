@@ -0,0 +1,25 @@
+/****************************************************************************
+ 
+  Header file for the supply voltage monitor and duty compensation
+
+*****************************************************************************/
+
+#ifndef Battery_H
+#define Battery_H
+
+#include "ES_Types.h"
+#include "Snapshot.h"
+
+//Compensation factor scale: BATTERY_UNITY is 1.0
+#define BATTERY_UNITY 256
+
+// Public Function Prototypes
+bool CheckBattery(void);
+unsigned int GetBatteryReading(void);
+unsigned int GetBatteryComp(void);
+signed int CompensateDuty(signed int Duty);
+#ifdef SNAPSHOT
+StateBlock_t GetBatteryVars(void);
+#endif
+
+#endif /* Battery_H */
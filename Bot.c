@@ -1,373 +1,620 @@
-/****************************************************************************
- Module
-   Bot.c
-
- Revision
-   1.0.1
-
- Description
-   This is the source code the flat state machine of the jousting autonomous
-   robot for ME 218B project. Project is divided into 3 different rounds (with
-   a sudden death if necessary) and short recess between each round.
-
- History
- When           Who           What/Why
- -------------- ---           --------
- 03/28/14 15:15 PS,CB,AH,LK   Revised template for use with project
- 01/15/12 11:12 jec           revisions for Gen2 framework
- 11/07/11 11:26 jec           made the queue static
- 10/30/11 17:59 jec           fixed references to CurrentEvent in RunTemplateSM
- 10/23/11 18:20 jec           began conversion from SMTemplate.c (02/20/07 rev)
-****************************************************************************/
-/*----------------------------- Include Files -----------------------------*/
-#include "ES_Configure.h"
-#include "ES_Framework.h"
-
-#include "Bot.h"
-#include "IR_Detect.h"
-#include "Servos.h"
-#include "Shoot.h"
-#include "IRemitter.h"
-#include "Orientation.h"
-#include "DCMotor.h"
-#include "JSRcommand.h"
-
-#include <stdio.h>
-#include <hidef.h>
-#include <mc9s12e128.h>     /* derivative information for the E128 */
-#include <S12E128bits.h>    /* bit definitions for the E128 */ 
-#include <Bin_Const.h>
-#include <termio.h>
-#include "S12eVec.h"
-#include "ads12.h"
-
-
-/*----------------------------- Module Defines ----------------------------*/
-//LED hardware pin/port
-#define LED_ADDRESS DDRP
-#define LED_PORT PTP
-#define MATCH_LED BIT4HI
-#define RELOAD_LED BIT5HI
-#define RECESS_LED BIT3HI
-
-//IR target frequencies
-#define BOT_FREQ 1250
-#define GOAL_FREQ 2083
-
-#define MOTOR_SPEED 100
-
-//JSR Commands
-#define STATUS_QUERY 0x3F
-#define SCORE_QUERY  0xC3
-#define NOTHING      0xFF
-#define WAIT         0x00
-#define START_ROUND  0x01
-#define RECESS       0x03
-#define SUDDEN_DEATH 0x04
-#define END	         0x05
-                               
-//Tape Sensors Options
-#define WHITE 0
-#define RED 1
-#define GREEN 2
-#define BLACK 3
-
-//This time assumes a 1.024mS/tick timing
-#define ONE_SEC 976
-/*---------------------------- Module Functions ---------------------------*/
-
-/*---------------------------- Module Variables ---------------------------*/
-static uint8_t MyPriority;
-static BotState_t CurrentState;
-static unsigned char CurrentRound;
-
-static unsigned int RELOAD_STATUS = DARK_RELOAD_STATUS;
-static bool DontChangeKnightFlag = false;
-
-/*------------------------------ Module Code ------------------------------*/
-/****************************************************************************
- Function
-     InitBot
-
- Parameters
-     uint8_t : the priorty of this service
-
- Returns
-     bool, false if error in initialization, true otherwise
-
- Description
-     Saves away the priority, sets up the initial transition and does any
-     other required initialization for this state machine
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 18:55
-****************************************************************************/
-bool InitBot( uint8_t Priority )
-{
-   MyPriority = Priority;
-
-   // put us into the Initial State
-   LED_ADDRESS |= MATCH_LED | RELOAD_LED | RECESS_LED; //Pins for LEDS as Outputs
-   LED_PORT &= ~(MATCH_LED | RELOAD_LED | RECESS_LED); //LEDs start off
-  
-   CurrentState = Recess; 
-   CurrentRound = 0;
-   return true;
-}
-
-/****************************************************************************
- Function
-     PostBot
-
- Parameters
-     EF_Event ThisEvent , the event to post to the queue
-
- Returns
-     boolean False if the Enqueue operation failed, True otherwise
-
- Description
-     Posts an event to this state machine's queue
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:25
-****************************************************************************/
-bool PostBot( ES_Event ThisEvent )
-{
-   return ES_PostToService( MyPriority, ThisEvent);
-}
-
-/****************************************************************************
- Function
-    RunBot
-
- Parameters
-   ES_Event : the event to process
-
- Returns
-   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
-
- Description
-   Main code for control of robot to play jousting games. In charge of
-   responding to different events depending on the state and round of
-   the game play.
-
- Notes
-   uses nested switch/case to implement the machine.
-
- Author
-   J. Edward Carryer, 01/15/12, 15:23
-****************************************************************************/
-ES_Event RunBot( ES_Event ThisEvent )
-{
-   ES_Event ReturnEvent, NewEvent;
-   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-  
-   //Read switch to determine side of robot 
-   if (RED_DARK_PORT & RED_DARK_PIN == RED_DARK_PIN) 
-   {
-      RELOAD_STATUS = RED_RELOAD_STATUS;  //RED KNIGHT
-      DontChangeKnightFlag = true;
-   }
-   else if (DontChangeKnightFlag == false)
-   {
-      RELOAD_STATUS = DARK_RELOAD_STATUS; //DARK KNIGHT
-   }	
-  
-   /*
-   If Game ends: 
-      Stop moving
-      Turn off "Active Game" LED
-      Turn off all motors/servos
-      Set state to recess
-   */
-   if(ThisEvent.EventType == NEW_COMMAND_RECEIVED && ThisEvent.EventParam == END)
-   {
-      translateMotor(0);
-      LED_PORT &= ~MATCH_LED; 
-      CurrentState = Recess; 
-      NewEvent.EventType = StopAligning;
-      PostIR_Detect(NewEvent);
-      NewEvent.EventType = StopShootingMotors;
-      PostShoot(NewEvent);
-   }
- 
-   /*
-   If Round ends:
-      Stop moving
-      Start motors for shooting foam balls
-      Aim for goal
-   */ 
-   if(ThisEvent.EventType == NEW_COMMAND_RECEIVED && ThisEvent.EventParam == WAIT)
-   {
-      CurrentRound = 0;
-      translateMotor(0);
-      LED_PORT &= ~MATCH_LED; 
-      CurrentState = Recess;
-      NewEvent.EventType = StartShootingMotors;
-      PostShoot(NewEvent);
-      SetServo(1, 1500);
-   }
-
-   /*
-   After shooting all foam balls at goal:
-      Start moving backswards
-      Begin searching for opponent
-   */
-   if(ThisEvent.EventType == ES_TIMEOUT){
-      rightMotor(-75);
-      leftMotor(74);
-      
-      NewEvent.EventType = StartAlign;
-      NewEvent.EventParam = BOT_FREQ;
-      PostIR_Detect(NewEvent); 
-   }
- 
-   //Respond to all other events based on current robot state and game round 
-   switch ( CurrentState )
-   {
-      case(Recess):
-         //New Command from JSR
-         if(ThisEvent.EventType == NEW_COMMAND_RECEIVED)
-         {
-            //New Round starts: Begin moving on game board
-            if(ThisEvent.EventParam == START_ROUND || 
-               ThisEvent.EventParam == SUDDEN_DEATH)
-            {
-               if(CurrentRound == 0)
-	               LED_PORT |= MATCH_LED;//Turn on MatchIndicator LED
-	            LED_PORT &= ~RECESS_LED; 
-			   	CurrentRound++;
-	            CurrentState = PasDArmes;
-
-               //Start looking for green tape on game board
-	            NewEvent.EventType = UpdateTargetColor;
-	            NewEvent.EventParam = GREEN;
-	            PostOrientation(NewEvent);
-	          
-	         
-               //For Round 2, 4. Try to shoot foams balls in goal
-               if(CurrentRound == 2 || CurrentRound == 4)
-               {
-                  ES_Timer_InitTimer(StopMoving_Timer, 25*ONE_SEC);
-                  if(QueryIR_Detect() == Aligned)
-                  {
-                     //Shoot Balls
-                     NewEvent.EventType = Shoot_Ball;
-                     NewEvent.EventParam = 5;
-                     PostShoot(NewEvent);
-                     ES_Timer_InitTimer(Bot_Timer, 5*ONE_SEC);
-                  }
-                  else
-                  {
-                     NewEvent.EventType = StopAligning;
-                     NewEvent.EventParam = 1;
-                     PostIR_Detect(NewEvent); 
-                     
-                     NewEvent.EventType = Shoot_Ball; 
-                     NewEvent.EventParam = 5;
-			            PostShoot(NewEvent); 
-                     
-                     ES_Timer_InitTimer(Bot_Timer, 6*ONE_SEC);
-                  }
-               }
-
-               //For Round 1, 3 start moving foward and start looking for
-               //opponent robot 
-               if(CurrentRound == 1 || CurrentRound ==3)
-               {
-                  NewEvent.EventType = StartShootingMotors;
-                  PostShoot(NewEvent);
-   
-                  ES_Timer_InitTimer(StopMoving_Timer, 25*ONE_SEC);
- 
-                  NewEvent.EventType = StartAlign;
-			         NewEvent.EventParam = BOT_FREQ;
-                  PostIR_Detect(NewEvent);
-			   
-                  rightMotor(75);
-                  leftMotor(-74);
-               }
-            }
-	      }
-         break; //End CurrentState = Recess
-
-      case(PasDArmes):
-         if(ThisEvent.EventType == NEW_COMMAND_RECEIVED && 
-            ThisEvent.EventParam == RECESS)
-         {
-            LED_PORT |= RECESS_LED;
-            //Try to align with goal. Aiming for foam balls
-            if(CurrentRound == 1 || CurrentRound == 3)
-            { 
-               //Align with goal
-               NewEvent.EventType = StartAlign;
-               NewEvent.EventParam = GOAL_FREQ;
-               PostIR_Detect(NewEvent);
-
-               NewEvent.EventType = StartShootingMotors;
-               PostShoot(NewEvent);
-            }
-       
-            //Reload balls at reloading stations 
-            if(CurrentRound == 2)
-            {
-               SetServo(1, 1485);
-               NewEvent.EventType = StopShootingMotors;
-               PostShoot(NewEvent);
-         
-               NewEvent.EventType = RELOAD_BALLS;
-               PostShoot(NewEvent);
-               PostIRemitter(NewEvent);
-         
-               NewEvent.EventType = StopAligning;
-               PostIR_Detect(NewEvent);
-            }
-      
-            CurrentState = Recess;
-         }
-         break; 
-   }// end switch on Current State
-
-   return ReturnEvent;
-}
-
-/****************************************************************************
- Function
-     QueryBot
-
- Parameters
-     None
-
- Returns
-     TemplateState_t The current state of the Template state machine
-
- Description
-     returns the current state of the Template state machine
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:21
-****************************************************************************/
-BotState_t QueryBot(void)
-{
-   return(CurrentState);
-}
-
-
-/****************************************************************************
- Function
-   GetCurrentRound
-
- Description
-   Return the current round of the game.
-****************************************************************************/
-unsigned char GetCurrentRound(void)
-{
-   return(CurrentRound);
-}
-/***************************************************************************
- private functions
- ***************************************************************************/
-
+/****************************************************************************
+ Module
+   Bot.c
+
+ Revision
+   1.0.1
+
+ Description
+   This is the source code the state machine of the jousting autonomous
+   robot for ME 218B project. Project is divided into 3 different rounds (with
+   a sudden death if necessary) and short recess between each round.
+
+ Notes
+   States, run by the HSM runtime:
+     Top            END and WAIT
+       Idle         before the first round and after END/WAIT
+       Round        round LEDs and count, a sudden death round
+         Attack     rounds 1 and 3, flywheels on and after the opponent
+         Shoot      rounds 2 and 4
+       Recess       recess LED
+         Rest       after round 4 or a sudden death round
+         Aim        after rounds 1 and 3, flywheels on and on the goal
+         Reload     after round 2
+   The setup each phase always needs is done by its entry action. The 
+   rest of what the robot does in each round and recess is in the 
+   RoundScripts and RecessScripts tables, run by the round script 
+   interpreter once the phase has been entered. A build
+   with ROUND_SCRIPTS set to a header file takes its tables from there
+   instead, so another strategy can be tried in the host simulator
+   (host/scripts) without touching this file.
+
+ History
+ When           Who           What/Why
+ -------------- ---           --------
+ 05/01/14 10:00 PS            Rounds and recesses nested again, LEDs,
+                              flywheels and alignment set up on entry
+ 04/30/14 16:00 PS            Script tables can come from a ROUND_SCRIPTS file
+ 04/26/14 10:20 PS            Running state gathered into Vars for snapshots
+ 04/25/14 09:30 PS            Home margin overridable from the build
+ 04/22/14 14:20 PS            Home time and shoot/reload go-ahead from the
+                              match clock
+ 04/21/14 10:40 PS            Round and recess behaviour moved into script
+                              tables
+ 04/20/14 13:00 PS            Nested states on the HSM runtime, round and
+                              recess work moved into entry actions
+ 04/18/14 16:10 PS            Expressed as a transition table for the FSM
+                              engine
+ 03/28/14 15:15 PS,CB,AH,LK   Revised template for use with project
+ 01/15/12 11:12 jec           revisions for Gen2 framework
+ 11/07/11 11:26 jec           made the queue static
+ 10/30/11 17:59 jec           fixed references to CurrentEvent in RunTemplateSM
+ 10/23/11 18:20 jec           began conversion from SMTemplate.c (02/20/07 rev)
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "Bot.h"
+#include "Fault.h"
+#include "HSM.h"
+#include "RoundScript.h"
+#include "IR_Detect.h"
+#include "Servos.h"
+#include "Shoot.h"
+#include "IRemitter.h"
+#include "Orientation.h"
+#include "DCMotor.h"
+#include "JSRcommand.h"
+
+#include <stdio.h>
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */ 
+#include <Bin_Const.h>
+#include <termio.h>
+#include "S12eVec.h"
+#include "ads12.h"
+
+
+/*----------------------------- Module Defines ----------------------------*/
+//LED hardware pin/port
+#define LED_ADDRESS DDRP
+#define LED_PORT PTP
+#define MATCH_LED BIT4HI
+#define RELOAD_LED BIT0HI //PP5 carries the left drive PWM
+#define RECESS_LED BIT3HI
+
+//IR target frequencies
+#define BOT_FREQ 1250
+#define GOAL_FREQ 2083
+
+#define MOTOR_SPEED 100
+
+//Balls requested from the depot at the round 2 recess
+#define BALLS_TO_RELOAD 5
+
+//JSR Commands
+#define STATUS_QUERY 0x3F
+#define SCORE_QUERY  0xC3
+#define NOTHING      0xFF
+#define WAIT         0x00
+#define START_ROUND  0x01
+#define RECESS       0x03
+#define SUDDEN_DEATH 0x04
+#define END	         0x05
+                               
+//Tape Sensors Options
+#define WHITE 0
+#define RED 1
+#define GREEN 2
+#define BLACK 3
+
+//This time assumes a 1.024mS/tick timing
+#define ONE_SEC 976
+
+//Head home this long before the end of a round (match clock). May be set
+//from the build to try other values
+#ifndef HOME_MARGIN
+#define HOME_MARGIN (5*ONE_SEC)
+#endif
+
+//Rounds with a script, a sudden death round has none
+#define NUM_ROUNDS 4
+
+//State ids for the HSM runtime
+enum {TOP_ID, IDLE_ID, ROUND_ID, ATTACK_ID, SHOOT_ID, RECESS_ID, REST_ID, 
+      AIM_ID, RELOAD_ID};
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool IsEnd(ES_Event ThisEvent);
+static bool IsWait(ES_Event ThisEvent);
+static bool IsRoundStart(ES_Event ThisEvent);
+static bool IsAttackRound(ES_Event ThisEvent);
+static bool IsShootRound(ES_Event ThisEvent);
+static bool IsRecess(ES_Event ThisEvent);
+static bool IsReloadRecess(ES_Event ThisEvent);
+static void EndGame(ES_Event ThisEvent);
+static void EndRound(ES_Event ThisEvent);
+static void EnterIdle(void);
+static void EnterRound(void);
+static void EnterAttack(void);
+static void EnterShoot(void);
+static void EnterRecess(void);
+static void ExitRecess(void);
+static void EnterRest(void);
+static void EnterAim(void);
+static void EnterReload(void);
+static void StartPhaseScript(const unsigned char * const *Scripts);
+static void PostAlign(unsigned int Freq);
+static void PostMotorsOn(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   HSM_t BotHSM;
+   unsigned char CurrentRound;
+   unsigned int RELOAD_STATUS;
+   bool DontChangeKnightFlag;
+} BotVars_t;
+
+static BotVars_t Vars = {{0}, 0, DARK_RELOAD_STATUS, false};
+
+#ifdef ROUND_SCRIPTS
+#include ROUND_SCRIPTS
+#else
+//Rounds 1 and 3: drive out after the opponent
+static const unsigned char AttackScript[] =
+{
+   RS_TAPE(GREEN),
+   RS_HOME_BY(HOME_MARGIN),
+   RS_DRIVE(75),
+   RS_END()
+};
+
+//Rounds 2 and 4: shoot at the goal, straight away if still aligned from
+//the recess, then back out looking for the opponent. No burst is started
+//that would not be done before heading home
+static const unsigned char ShootScript[] =
+{
+   RS_TAPE(GREEN),
+   RS_HOME_BY(HOME_MARGIN),
+   RS_SKIP_NO_SHOOT(7, 5),
+   RS_SKIP_ALIGNED(4),
+   RS_STOP_ALIGN(1),
+   RS_SHOOT(5),
+   RS_WAIT_TIME(6*ONE_SEC),
+   RS_SKIP(2),
+   RS_SHOOT(5),
+   RS_WAIT_TIME(5*ONE_SEC),
+   RS_DRIVE(-75),
+   RS_ALIGN(BOT_FREQ),
+   RS_END()
+};
+
+//After round 2: reload balls at reloading station
+static const unsigned char ReloadScript[] =
+{
+   RS_AIM(1485),
+   RS_MOTORS_OFF(),
+   RS_SKIP_NO_RELOAD(1, BALLS_TO_RELOAD),
+   RS_RELOAD(BALLS_TO_RELOAD),
+   RS_STOP_ALIGN(0),
+   RS_END()
+};
+
+static const unsigned char * const RoundScripts[NUM_ROUNDS] =
+{
+   AttackScript, ShootScript, AttackScript, ShootScript
+};
+
+static const unsigned char * const RecessScripts[NUM_ROUNDS] =
+{
+   0, ReloadScript, 0, 0
+};
+#endif
+
+static const HSMState_t TopState, IdleState, RoundState, AttackState, 
+                        ShootState, RecessState, RestState, AimState, 
+                        ReloadState;
+
+//END and WAIT apply in every state
+static const HSMRow_t TopRows[] = 
+{
+   {NEW_COMMAND_RECEIVED, IsEnd,  EndGame,  &IdleState},
+   {NEW_COMMAND_RECEIVED, IsWait, EndRound, &IdleState}
+};
+
+//A round start from Idle or Recess picks the child from the next round 
+static const HSMRow_t StartRows[] =
+{
+   {NEW_COMMAND_RECEIVED, IsAttackRound, 0, &AttackState},
+   {NEW_COMMAND_RECEIVED, IsShootRound,  0, &ShootState},
+   {NEW_COMMAND_RECEIVED, IsRoundStart,  0, &RoundState}
+};
+
+static const HSMRow_t RoundRows[] =
+{
+   {NEW_COMMAND_RECEIVED, IsRecess, 0, &RestState}
+};
+
+static const HSMRow_t AttackRows[] =
+{
+   {NEW_COMMAND_RECEIVED, IsRecess, 0, &AimState}
+};
+
+static const HSMRow_t ShootRows[] =
+{
+   {NEW_COMMAND_RECEIVED, IsReloadRecess, 0, &ReloadState}
+};
+
+static const HSMState_t TopState = 
+   {0, 0, 0, &IdleState, TopRows, ARRAY_SIZE(TopRows), TOP_ID, false};
+static const HSMState_t IdleState = 
+   {&TopState, EnterIdle, 0, 0, StartRows, ARRAY_SIZE(StartRows), IDLE_ID, 
+    false};
+static const HSMState_t RoundState = 
+   {&TopState, EnterRound, StopRoundScript, 0, RoundRows, 
+    ARRAY_SIZE(RoundRows), ROUND_ID, false};
+static const HSMState_t AttackState = 
+   {&RoundState, EnterAttack, 0, 0, AttackRows, ARRAY_SIZE(AttackRows), 
+    ATTACK_ID, false};
+static const HSMState_t ShootState = 
+   {&RoundState, EnterShoot, 0, 0, ShootRows, ARRAY_SIZE(ShootRows), 
+    SHOOT_ID, false};
+static const HSMState_t RecessState = 
+   {&TopState, EnterRecess, ExitRecess, &RestState, StartRows, 
+    ARRAY_SIZE(StartRows), RECESS_ID, false};
+static const HSMState_t RestState = 
+   {&RecessState, EnterRest, 0, 0, 0, 0, REST_ID, false};
+static const HSMState_t AimState = 
+   {&RecessState, EnterAim, 0, 0, 0, 0, AIM_ID, false};
+static const HSMState_t ReloadState = 
+   {&RecessState, EnterReload, 0, 0, 0, 0, RELOAD_ID, false};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitBot
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, sets up the initial transition and does any
+     other required initialization for this state machine
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 18:55
+****************************************************************************/
+bool InitBot( uint8_t Priority )
+{
+   MyPriority = Priority;
+
+   // put us into the Initial State
+   LED_ADDRESS |= MATCH_LED | RELOAD_LED | RECESS_LED; //Pins for LEDS as Outputs
+   LED_PORT &= ~(MATCH_LED | RELOAD_LED | RECESS_LED); //LEDs start off
+  
+   Vars.CurrentRound = 0;
+   InitHSM(&Vars.BotHSM, &TopState);
+   return true;
+}
+
+/****************************************************************************
+ Function
+     PostBot
+
+ Parameters
+     EF_Event ThisEvent , the event to post to the queue
+
+ Returns
+     boolean False if the Enqueue operation failed, True otherwise
+
+ Description
+     Posts an event to this state machine's queue
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:25
+****************************************************************************/
+bool PostBot( ES_Event ThisEvent )
+{
+   FAULT_POST(ThisEvent);
+   return ES_PostToService( MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunBot
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   Main code for control of robot to play jousting games. In charge of
+   responding to different events depending on the state and round of
+   the game play.
+
+ Notes
+   Transitions are in the state rows above and run by the HSM runtime.
+   Other events go to the round script.
+
+ Author
+   J. Edward Carryer, 01/15/12, 15:23
+****************************************************************************/
+ES_Event RunBot( ES_Event ThisEvent )
+{
+   ES_Event ReturnEvent;
+   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+  
+   //Read switch to determine side of robot 
+   if ((RED_DARK_PORT & RED_DARK_PIN) == RED_DARK_PIN) 
+   {
+      Vars.RELOAD_STATUS = RED_RELOAD_STATUS;  //RED KNIGHT
+      Vars.DontChangeKnightFlag = true;
+   }
+   else if (Vars.DontChangeKnightFlag == false)
+   {
+      Vars.RELOAD_STATUS = DARK_RELOAD_STATUS; //DARK KNIGHT
+   }	
+  
+   //Whatever the states do not take may be what the script waits for
+   if(!RunHSM(&Vars.BotHSM, ThisEvent))
+      RunRoundScript(ThisEvent);
+   return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+     QueryBot
+
+ Parameters
+     None
+
+ Returns
+     BotState_t PasDArmes while a round is on, Recess otherwise
+
+ Description
+     returns the current state of the Bot state machine
+ Notes
+     Only the top level is reported, the nested states stay private.
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:21
+****************************************************************************/
+BotState_t QueryBot(void)
+{
+   if(IsInHSMState(&Vars.BotHSM, &RoundState))
+      return(PasDArmes);
+   return(Recess);
+}
+
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetBotVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetBotVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/****************************************************************************
+ Function
+   GetCurrentRound
+
+ Description
+   Return the current round of the game.
+****************************************************************************/
+unsigned char GetCurrentRound(void)
+{
+   return(Vars.CurrentRound);
+}
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Guards on the JSR command */
+static bool IsEnd(ES_Event ThisEvent)
+{
+   return ThisEvent.EventParam == END;
+}
+
+static bool IsWait(ES_Event ThisEvent)
+{
+   return ThisEvent.EventParam == WAIT;
+}
+
+static bool IsRoundStart(ES_Event ThisEvent)
+{
+   return ThisEvent.EventParam == START_ROUND || 
+          ThisEvent.EventParam == SUDDEN_DEATH;
+}
+
+static bool IsRecess(ES_Event ThisEvent)
+{
+   return ThisEvent.EventParam == RECESS;
+}
+
+/* Rounds 1 and 3 go out after the opponent, 2 and 4 shoot at the goal */
+static bool IsAttackRound(ES_Event ThisEvent)
+{
+   return IsRoundStart(ThisEvent) && 
+          (Vars.CurrentRound + 1 == 1 || Vars.CurrentRound + 1 == 3);
+}
+
+static bool IsShootRound(ES_Event ThisEvent)
+{
+   return IsRoundStart(ThisEvent) && 
+          (Vars.CurrentRound + 1 == 2 || Vars.CurrentRound + 1 == 4);
+}
+
+/* Only the recess after round 2 reloads */
+static bool IsReloadRecess(ES_Event ThisEvent)
+{
+   return IsRecess(ThisEvent) && Vars.CurrentRound == 2;
+}
+
+/* Function: EndGame
+  --------------------
+  Game over: stop moving, turn off "Active Game" LED and all motors.
+*/
+static void EndGame(ES_Event ThisEvent)
+{
+   ES_Event NewEvent;
+   
+   brakeMotorNow();
+   NewEvent.EventType = StopAligning;
+   PostIR_Detect(NewEvent);
+   NewEvent.EventType = StopShootingMotors;
+   PostShoot(NewEvent);
+}
+
+/* Function: EndRound
+  ---------------------
+  Round over: stop moving, start motors for shooting foam balls and aim 
+  for goal.
+*/
+static void EndRound(ES_Event ThisEvent)
+{
+   Vars.CurrentRound = 0;
+   translateMotor(0);
+   PostMotorsOn();
+   SetServo(1, 1500);
+}
+
+/* Function: EnterIdle
+  ------------------------
+  No match on: "Active Game" LED off.
+*/
+static void EnterIdle(void)
+{
+   LED_PORT &= ~MATCH_LED; 
+}
+
+/* Function: EnterRound
+  ------------------------
+  New round starts: "Active Game" LED on and count the round. A sudden 
+  death round stops here, it has no script.
+*/
+static void EnterRound(void)
+{
+   LED_PORT |= MATCH_LED;
+   Vars.CurrentRound++;
+}
+
+/* Function: EnterAttack
+  ------------------------
+  Rounds 1 and 3: flywheels up and look for the opponent, then the 
+  round's script.
+*/
+static void EnterAttack(void)
+{
+   PostMotorsOn();
+   PostAlign(BOT_FREQ);
+   StartPhaseScript(RoundScripts);
+}
+
+/* Function: EnterShoot
+  -----------------------
+  Rounds 2 and 4: the round's script decides whether to realign first.
+*/
+static void EnterShoot(void)
+{
+   StartPhaseScript(RoundScripts);
+}
+
+/* Function(s): EnterRecess, ExitRecess
+  ---------------------------------------
+  Recess LED for as long as the recess lasts, the script stops with it.
+*/
+static void EnterRecess(void)
+{
+   LED_PORT |= RECESS_LED;
+}
+
+static void ExitRecess(void)
+{
+   LED_PORT &= ~RECESS_LED; 
+   StopRoundScript();
+}
+
+/* Function: EnterRest
+  ----------------------
+  Recess after round 4 or a sudden death round: only a script, if the 
+  tables give one.
+*/
+static void EnterRest(void)
+{
+   StartPhaseScript(RecessScripts);
+}
+
+/* Function: EnterAim
+  ---------------------
+  Recess after rounds 1 and 3: align with goal, aiming for foam balls.
+*/
+static void EnterAim(void)
+{
+   PostAlign(GOAL_FREQ);
+   PostMotorsOn();
+   StartPhaseScript(RecessScripts);
+}
+
+/* Function: EnterReload
+  ------------------------
+  Recess after round 2: reload balls at reloading stations.
+*/
+static void EnterReload(void)
+{
+   StartPhaseScript(RecessScripts);
+}
+
+/* Function: StartPhaseScript
+  -----------------------------
+  Run this round's entry in Scripts, RoundScripts or RecessScripts. 
+  Rounds past NUM_ROUNDS have none.
+*/
+static void StartPhaseScript(const unsigned char * const *Scripts)
+{
+   if(Vars.CurrentRound >= 1 && Vars.CurrentRound <= NUM_ROUNDS)
+      StartRoundScript(Scripts[Vars.CurrentRound - 1]);
+}
+
+/* Function(s): PostAlign, PostMotorsOn
+  ---------------------------------------
+  Setup posted on entry: align with the beacon at Freq, flywheels on.
+*/
+static void PostAlign(unsigned int Freq)
+{
+   ES_Event NewEvent;
+   
+   NewEvent.EventType = StartAlign;
+   NewEvent.EventParam = Freq;
+   PostIR_Detect(NewEvent);
+}
+
+static void PostMotorsOn(void)
+{
+   ES_Event NewEvent;
+   
+   NewEvent.EventType = StartShootingMotors;
+   PostShoot(NewEvent);
+}
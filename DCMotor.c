@@ -1,290 +1,922 @@
-/****************************************************************************
- Module
-   DC_Motor.c
- 
- Revision
-   1.0.1
-
- Description
-   This is a template file for implementing a simple service under the 
-   Gen2 Events and Services Framework. Service handles the generation of
-   PWM Signal for a DC Motor as required by project. 
-
- Notes
-
- History
- When           Who        What/Why
- -------------- ---        --------
- 03/15/14 12:10 PS, LK     Updated file for use with project
- 01/25/14 16:09 pds05      Changed file for use with DC Motor for lab 7
- 01/10/14 17:26 pds05      Converted template for use in Lab 5
- 01/16/12 09:58 jec        began conversion from TemplateFSM.c
-
-****************************************************************************/
-/*----------------------------- Include Files -----------------------------*/
-#include "ES_Configure.h"
-#include "ES_Framework.h"
-#include "ES_DeferRecall.h"
-#include "DCMotor.h"
-
-#include <stdio.h>
-#include "ADS12.h"
-#include <hidef.h>
-#include <mc9s12e128.h>     /* derivative information for the E128 */
-#include <S12E128bits.h>    /* bit definitions for the E128 */ 
-#include <Bin_Const.h>
-#include <termio.h>
-#include "S12eVec.h"
-
-/*----------------------------- Module Defines ----------------------------*/
-//Define Port/Pins for DC motor control with micro-controller
-#define MOTOR_PORT PTU
-#define MOTOR_PORT_ADDRESS DDRU
-#define MOTOR_1_PWM BIT0HI
-#define MOTOR_1_DIR BIT7HI
-#define MOTOR_2_PWM BIT1HI
-#define MOTOR_2_DIR BIT6HI
-
-#define ONE_SEC 976
-#define CHCK_SPEED_TIME ONE_SEC/2
-
-#define _ms_ *750
-#define Period (60 _ms_)
-#define SCALE 8
-
-/*---------------------------- Module Functions ---------------------------*/
-void InitializeTimer(void);    
-void angleMotor(unsigned int Deg, unsigned int RPM5);
-void rotateMotor(signed int RPMdir1);
-void translateMotor(signed int RPMdir);
-void positionMotor(unsigned int distInInches, unsigned int RPM);
-/*---------------------------- Module Variables ---------------------------*/
-static uint8_t MyPriority;
-static ES_Event DeferralQueue[3+1];
-static unsigned char i=0;
-
-static unsigned long period1=0;
-static unsigned long period2=0;
-static unsigned long uPeriod1=0;
-static unsigned long uPeriod2=0;
-static unsigned long LastPeriod1 = 0;
-static unsigned long LastPeriod2 = 0;
-static unsigned long uLastTime1=0;
-static unsigned long uLastTime2=0;
-static unsigned int OverFlows1=0;
-static unsigned int OverFlows2=0;
-static float RPM1=0;
-static unsigned char count1=0;
-static float ReqRPM1 = 0;
-static float RPMError1 = 0;
-static float SumError1 = 0;
-static float ReqDuty1 = 0;
-static float SetDuty1 = 0;
-static float LastDuty1 = 0;
-static float RPM2=0;
-static unsigned char count2=0;
-static float ReqRPM2 = 0;
-static float RPMError2 = 0;
-static float SumError2 = 0;
-static float ReqDuty2 = 0;
-static float SetDuty2 = 0;
-static float LastDuty2 = 0;
-static float LastRPM1 = 0;
-static float LastRPM2 = 0;
-   
-/*------------------------------ Module Code ------------------------------*/
-/****************************************************************************
- Function
-     InitDCMotor
-
- Parameters
-     uint8_t : the priorty of this service
-
- Returns
-     bool, false if error in initialization, true otherwise
-
- Description
-     Saves away the priority, sets all the necessary bits for input capture
-     output compare, PWM setup and enabling interrupts.
-
- Author
-     J. Edward Carryer, 01/16/12, 10:00
-****************************************************************************/
-bool InitDCMotor ( uint8_t Priority )
-{
-   ES_Event ThisEvent;
-   MyPriority = Priority;
-  
-   
-   /* Turn on Port U for PWM outputs */
-   MOTOR_PORT_ADDRESS |= (MOTOR_1_DIR | MOTOR_2_DIR | 
-                           MOTOR_1_PWM | MOTOR_2_PWM);
-  
-   /* Initialize Registers for PWM Capability */
-   PWME |= _S12_PWME0 | _S12_PWME1;    //Enable PWM 0,1
-   PWMPOL |= (_S12_PPOL0 | _S12_PPOL1); //Set Output Polarity LO
-   PWMCLK  |= (_S12_PCLK0 | _S12_PCLK1);  //Enable Clock A Scaling
-   PWMPRCLK &= ~(_S12_PCKA2|_S12_PCKA1|_S12_PCKA0);//Set A Clock prescale /1
-   PWMSCLA = 4;         //Clock Scaler
-   PWMCAE &= ~_S12_CAE0;  //Set to Left Align
-   PWMCAE |= _S12_CAE1;  //Set to Center Align
-   MODRR |= _S12_MODRR0 | _S12_MODRR1;  //Port U Mapping - Pin(s) 0,1 to PWM
- 
-   /* Set Period/Initial Duty Cycle/Initial Dir */ 
-   PWMPER0 = 100; //Set PWM freq to 30 kHz
-   PWMPER1 = 50;
-   PWMDTY0 = 0;
-   PWMDTY1 = 0;
-  
-   MOTOR_PORT &= ~MOTOR_1_DIR & ~MOTOR_2_DIR;
-  
-   ES_InitDeferralQueueWith( DeferralQueue, ARRAY_SIZE(DeferralQueue) );
-   ThisEvent.EventType = ES_INIT;
-   if (ES_PostToService( MyPriority, ThisEvent) == true)
-      return true;
-   else
-      return false;
-}
-
-/****************************************************************************
- Function
-     PostDCMotor
-
- Parameters
-     EF_Event ThisEvent ,the event to post to the queue
-
- Returns
-     bool false if the Enqueue operation failed, true otherwise
-
- Description
-     Posts an event to this state machine's queue
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:25
-****************************************************************************/
-bool PostDCMotor( ES_Event ThisEvent )
-{
-  return ES_PostToService( MyPriority, ThisEvent);
-}
-
-/****************************************************************************
- Function
-    RunDCMotor
-
- Parameters
-   ES_Event : the event to process
-
- Returns
-   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
-
- Description
-   Updates the current RPM and desired RPM. This update is triggered 
-   10 times a second. Changes the direction of the motor turning depending 
-   on if motor should turn clockwise or counter-clockwise
-   
- Author
-   P. Sherman,L. Kim, 01/11/14, 14:04 - Converted for use with DC Motor
-   J. Edward Carryer, 01/15/12, 15:23
-****************************************************************************/
-ES_Event RunDCMotor( ES_Event ThisEvent )
-{
-   ES_Event ReturnEvent;
-   
-   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-   switch(ThisEvent.EventType)
-   {
-      case MotorRightC:
-         MOTOR_PORT &= ~MOTOR_1_DIR;
-         PWMDTY0 = ThisEvent.EventParam;
-         break;
-   			
-      case MotorRightCC:
-         MOTOR_PORT |= MOTOR_1_DIR;	
-         PWMDTY0 = ThisEvent.EventParam; 
-         break; 
-   	
-      case MotorLeftC:
-         MOTOR_PORT &= ~MOTOR_2_DIR;
-         PWMDTY1 = ThisEvent.EventParam/2;
-         break;
-                                                                    
-      case MotorLeftCC: 
-         MOTOR_PORT |= MOTOR_2_DIR;
-         PWMDTY1 = ThisEvent.EventParam/2;
-         break;
-         	
-      case ES_TIMEOUT:
-         if(ThisEvent.EventParam==DC_TIMER)
-            translateMotor(0);
-         break;
-   }
-   return ReturnEvent;
-}
-/*-------------------------- Public Functions ---------------------------*/
-/* Function: translateMotor
-  -------------------------
-  Move Bot straight forward/backwards 
-*/
-void translateMotor(signed int RPMdir)
-{
-   leftMotor(-RPMdir);
-   rightMotor(RPMdir);   
-}
-
-/* Function: rotateMotor
-  ------------------------
-  Rotate Bot clockwise or counter-clockwise
-*/
-void rotateMotor(signed int RPMdir1)
-{
-   leftMotor(RPMdir1);
-   rightMotor(RPMdir1);   
-}
-
-/* Function: timedTranslate
-  --------------------------
-  translate the bot for a specified amount of time
-*/
-void timedTranslate(int RPM, unsigned int move_time)
-{
-   translateMotor(RPM);
-   ES_Timer_InitTimer(DC_TIMER, move_time);   
-}
-
-/* Function(s): leftMotor, RightMotor
-   -----------------------------------
-   Set Direction, PWM of motors based on sign
-   and value of parameter
-*/
-void leftMotor(signed int PWMDCdir){
-   ES_Event motorEvent;
-   
-   if (PWMDCdir < 0)
-   {
-      motorEvent.EventType = MotorLeftC;
-      motorEvent.EventParam = -PWMDCdir;
-   } 
-   else 
-   {
-      motorEvent.EventType = MotorLeftCC;
-      motorEvent.EventParam = PWMDCdir;      
-   }
-   PostDCMotor(motorEvent); 
-
-}
-void rightMotor(signed int PWMDCdir){
-   ES_Event motorEvent;
-   
-   if (PWMDCdir < 0){
-      motorEvent.EventType = MotorRightC;
-      motorEvent.EventParam = -PWMDCdir;
-   } else {
-      motorEvent.EventType = MotorRightCC;
-      motorEvent.EventParam = PWMDCdir;      
-   }
-   PostDCMotor(motorEvent);   
-}
-
-/*------------------------------ End of file ------------------------------*/
-
+/****************************************************************************
+ Module
+   DC_Motor.c
+ 
+ Revision
+   1.0.1
+
+ Description
+   This is a template file for implementing a simple service under the 
+   Gen2 Events and Services Framework. Service handles the generation of
+   PWM Signal for a DC Motor as required by project. 
+
+ Notes
+   Motion scripts: StartMotion runs a const list of MotionStep_t moves
+   back to back. Each step ends on its own condition (distance, angle,
+   time, tape colour) and the next one is started in the same control 
+   tick, with no round trip through a requesting service. The requester 
+   only hears MoveComplete at the end of the list, or MoveFault with the
+   index of the step that stalled or ran past its timeout.
+   Straight moves hold the heading on the encoders. On the host field
+   with the wheels up to 3% apart that leaves at most about 1mm of drift
+   off the line per meter driven, against about 50mm/m open loop at any duty
+   (host/DriveTest.c).
+
+ History
+ When           Who        What/Why
+ -------------- ---        --------
+ 04/28/14 09:00 PS         Drive PWM clock select taken from channels 1 and 5
+ 04/27/14 11:00 PS         Drive duties scaled for the pack voltage
+ 04/26/14 10:20 PS         Running state gathered into Vars for snapshots,
+                           unused speed control variables removed
+ 04/24/14 10:15 PS         Motion scripts of queued moves with timeouts
+ 04/11/14 15:30 PS         Duty changes go through the soft-start ramp
+ 04/07/14 09:15 PS         Immediate stop/brake fast path
+ 04/06/14 11:30 PS         16-bit concatenated PWM, duty set in permille
+ 04/04/14 16:45 PS         Cross-coupled heading hold for straight moves
+ 04/02/14 10:20 PS         Added encoder based positionMotor/angleMotor moves
+ 03/15/14 12:10 PS, LK     Updated file for use with project
+ 01/25/14 16:09 pds05      Changed file for use with DC Motor for lab 7
+ 01/10/14 17:26 pds05      Converted template for use in Lab 5
+ 01/16/12 09:58 jec        began conversion from TemplateFSM.c
+
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_DeferRecall.h"
+#include "ES_Port.h"
+#include "DCMotor.h"
+#include "Fault.h"
+#include "Ramp.h"
+#include "Battery.h"
+#include "Orientation.h"
+
+#include <stdio.h>
+#include "ADS12.h"
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */ 
+#include <Bin_Const.h>
+#include <termio.h>
+#include "S12eVec.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+//Define Port/Pins for DC motor control with micro-controller
+//Motor 1 PWM is the 16-bit PWM01 channel on PU1, Motor 2 PWM is the 16-bit
+//PWM45 channel on PP5
+#define MOTOR_PORT PTU
+#define MOTOR_PORT_ADDRESS DDRU
+#define MOTOR_1_PWM BIT1HI
+#define MOTOR_1_DIR BIT7HI
+#define MOTOR_2_DIR BIT6HI
+
+//Both wheels share one 16-bit period. Clock A unscaled (24 MHz) over
+//1000 counts gives 24 kHz and lets the duty registers take permille directly
+#define DRIVE_PERIOD 1000
+#define PERMILLE_PER_PERCENT 10
+
+//Soft-start. Duty rises at most 20 permille per ramp update (0-75% in 
+//~0.2s) and both wheels start together as one large load
+#define DRIVE_RAMP_RATE 320
+#define DRIVE_START_COST 2
+
+//Motor event params carry the duty in the low bits and the stop generation
+//they were issued in above it, so commands queued before an immediate stop
+//are dropped instead of restarting the wheels
+#define DUTY_MASK 0x03FF
+#define GEN_SHIFT 10
+#define GEN_MASK 0x3F
+
+//Wheel encoders on input capture TIM0 channels 4,5 (PT4, PT5)
+#define ENCODER_R_IOS _S12_IOS4
+#define ENCODER_L_IOS _S12_IOS5
+#define ENCODER_R_FLAG _S12_C4F
+#define ENCODER_L_FLAG _S12_C5F
+#define ENCODER_R_INT _S12_C4I
+#define ENCODER_L_INT _S12_C5I
+
+//Encoder geometry. Edges counted per inch of wheel travel and per 100 deg
+//of in-place rotation (9in wheel base: 12*pi*9/360 ticks per deg)
+#define TICKS_PER_INCH 12
+#define TICKS_PER_100DEG 94
+
+//Control tick for encoder moves and stall detection (timer ticks)
+#define CONTROL_TIME 10
+#define STALL_LIMIT 50      //control ticks without encoder progress (~0.5s)
+#define MOVE_LIMIT 1000     //control ticks before any move is abandoned
+
+//Cross-coupled heading hold. Correction (permille) added to the lagging
+//wheel and taken from the leading wheel = err*KP + sum(err)*KI, where err
+//is the difference in encoder ticks between the two wheels
+#define HEADING_KP 20
+#define HEADING_KI 1
+#define MAX_CORRECTION 150
+#define MAX_ERROR_SUM 400
+
+//Move modes
+#define MOVE_NONE 0
+#define MOVE_TRANSLATE 1
+#define MOVE_ROTATE 2
+#define MOVE_STRAIGHT 3
+#define MOVE_TIMED 4      //straight for MoveTarget timer ticks
+#define MOVE_TAPE 5       //straight until the tape sensor sees MoveTarget
+#define MOVE_DWELL 6      //stopped for MoveTarget timer ticks
+
+#define ONE_SEC 976
+#define CHCK_SPEED_TIME ONE_SEC/2
+
+#define _ms_ *750
+#define Period (60 _ms_)
+#define SCALE 8
+
+/*---------------------------- Module Functions ---------------------------*/
+void InitializeTimer(void);    
+void angleMotor(signed int Deg, unsigned int RPM5, pPostFunc Requester);
+void rotateMotor(signed int RPMdir1);
+void translateMotor(signed int RPMdir);
+void positionMotor(signed int distInInches, unsigned int RPM, 
+                   pPostFunc Requester);
+static void StartMove(unsigned char Mode, signed int RightDuty, 
+                      signed char LeftSign, unsigned int Ticks, 
+                      pPostFunc Requester);
+static void UpdateMove(void);
+static void HoldHeading(void);
+static void EndMove(ES_EventTyp_t Result);
+static void CancelMove(void);
+static void NextMotionStep(void);
+static void DropMotion(void);
+static void SetRightDuty(signed int Duty);
+static void SetLeftDuty(signed int Duty);
+static void WriteRightDuty(signed int Duty);
+static void WriteLeftDuty(signed int Duty);
+static bool IsStaleCommand(ES_Event ThisEvent);
+static void HaltDrive(void);
+void interrupt _Vec_tim0ch4 RightEncoder(void);
+void interrupt _Vec_tim0ch5 LeftEncoder(void);
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+//Running state, all in one place for Snapshot.c. Tick counts are written
+//by the capture ISRs
+typedef struct
+{
+   ES_Event DeferralQueue[3+1];
+   
+   //Encoder move bookkeeping
+   volatile unsigned int RightTicks;
+   volatile unsigned int LeftTicks;
+   unsigned char MoveMode;
+   unsigned int MoveTarget;
+   unsigned int LastProgress;
+   unsigned int StallCount;
+   unsigned int MoveCount;
+   pPostFunc MoveRequester;
+   volatile unsigned char StopGeneration;
+   
+   //Heading hold setpoints
+   unsigned int MoveDuty;
+   signed char RightDir;
+   signed char LeftDir;
+   signed int ErrorSum;
+   
+   //Motion script in progress: steps still to run and the step timeout
+   const MotionStep_t *MotionSteps;
+   unsigned char MotionLeft;
+   unsigned char MotionIndex;
+   pPostFunc MotionRequester;
+   unsigned int StepTimeout;
+} DCMotorVars_t;
+
+static DCMotorVars_t Vars = 
+{
+   {{0}}, 0, 0, MOVE_NONE, 0, 0, 0, 0, 0, 0, 
+   0, 1, -1, 0, 
+   0, 0, 0, 0, 0
+};
+   
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitDCMotor
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, sets all the necessary bits for input capture
+     output compare, PWM setup and enabling interrupts.
+
+ Author
+     J. Edward Carryer, 01/16/12, 10:00
+****************************************************************************/
+bool InitDCMotor ( uint8_t Priority )
+{
+   ES_Event ThisEvent;
+   MyPriority = Priority;
+  
+   
+   /* Turn on Port U for PWM outputs */
+   MOTOR_PORT_ADDRESS |= (MOTOR_1_DIR | MOTOR_2_DIR | MOTOR_1_PWM);
+  
+   /* Initialize Registers for 16-bit PWM Capability. In concatenated mode
+      clock select, polarity, alignment and enable all come from the high
+      order channel of each pair */
+   PWMCTL |= _S12_CON01 | _S12_CON45;  //Concatenate 0,1 and 4,5
+   PWME |= _S12_PWME1 | _S12_PWME5;    //Enable PWM 01,45
+   PWMPOL |= (_S12_PPOL1 | _S12_PPOL5); //Set Output Polarity HI
+   PWMCLK &= ~(_S12_PCLK1 | _S12_PCLK5);  //Use Clock A unscaled
+   PWMPRCLK &= ~(_S12_PCKA2|_S12_PCKA1|_S12_PCKA0);//Set A Clock prescale /1
+   PWMCAE &= ~(_S12_CAE1 | _S12_CAE5);  //Set to Left Align
+   MODRR |= _S12_MODRR1;   //Port U Mapping - Pin 1 to PWM
+   MODRR &= ~_S12_MODRR0;
+ 
+   /* Set Period/Initial Duty Cycle/Initial Dir */ 
+   PWMPER01 = DRIVE_PERIOD;
+   PWMPER45 = DRIVE_PERIOD;
+   PWMDTY01 = 0;
+   PWMDTY45 = 0;
+  
+   MOTOR_PORT &= ~MOTOR_1_DIR & ~MOTOR_2_DIR;
+   InitRamp(RAMP_DRIVE_RIGHT, WriteRightDuty, DRIVE_RAMP_RATE, 
+            DRIVE_START_COST, RAMP_DRIVE_LEFT);
+   InitRamp(RAMP_DRIVE_LEFT, WriteLeftDuty, DRIVE_RAMP_RATE, 
+            DRIVE_START_COST, RAMP_DRIVE_RIGHT);
+  
+   InitializeTimer();
+   ES_InitDeferralQueueWith( Vars.DeferralQueue, 
+                             ARRAY_SIZE(Vars.DeferralQueue) );
+   ThisEvent.EventType = ES_INIT;
+   if (ES_PostToService( MyPriority, ThisEvent) == true)
+      return true;
+   else
+      return false;
+}
+
+/****************************************************************************
+ Function
+     PostDCMotor
+
+ Parameters
+     EF_Event ThisEvent ,the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to this state machine's queue
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:25
+****************************************************************************/
+bool PostDCMotor( ES_Event ThisEvent )
+{
+  FAULT_POST(ThisEvent);
+  return ES_PostToService( MyPriority, ThisEvent);
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetDCMotorVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetDCMotorVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/****************************************************************************
+ Function
+    RunDCMotor
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   Sets direction and duty (permille) of each motor from the motor events
+   posted by leftMotor/rightMotor, and runs the control tick of encoder
+   moves.
+   
+ Author
+   P. Sherman,L. Kim, 01/11/14, 14:04 - Converted for use with DC Motor
+   J. Edward Carryer, 01/15/12, 15:23
+****************************************************************************/
+ES_Event RunDCMotor( ES_Event ThisEvent )
+{
+   ES_Event ReturnEvent;
+   
+   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+   if(IsStaleCommand(ThisEvent))
+      return ReturnEvent;
+   
+   switch(ThisEvent.EventType)
+   {
+      case MotorRightC:
+         SetRightDuty(-(signed int)(ThisEvent.EventParam & DUTY_MASK));
+         break;
+   			
+      case MotorRightCC:
+         SetRightDuty(ThisEvent.EventParam & DUTY_MASK); 
+         break; 
+   	
+      case MotorLeftC:
+         SetLeftDuty(-(signed int)(ThisEvent.EventParam & DUTY_MASK));
+         break;
+                                                                    
+      case MotorLeftCC: 
+         SetLeftDuty(ThisEvent.EventParam & DUTY_MASK);
+         break;
+         	
+      case ES_TIMEOUT:
+         if(ThisEvent.EventParam==DC_TIMER)
+            translateMotor(0);
+         else if(ThisEvent.EventParam==RPM_TIMER && Vars.MoveMode != MOVE_NONE)
+         {
+            UpdateMove();
+            if(Vars.MoveMode != MOVE_NONE)
+               ES_Timer_InitTimer(RPM_TIMER, CONTROL_TIME);
+         }
+         break;
+   }
+   return ReturnEvent;
+}
+/*-------------------------- Public Functions ---------------------------*/
+/* Function: translateMotor
+  -------------------------
+  Move Bot straight forward/backwards 
+*/
+void translateMotor(signed int RPMdir)
+{
+   leftMotor(-RPMdir);
+   rightMotor(RPMdir);   
+}
+
+/* Function: rotateMotor
+  ------------------------
+  Rotate Bot clockwise or counter-clockwise
+*/
+void rotateMotor(signed int RPMdir1)
+{
+   leftMotor(RPMdir1);
+   rightMotor(RPMdir1);   
+}
+
+/* Function: timedTranslate
+  --------------------------
+  translate the bot for a specified amount of time
+*/
+void timedTranslate(int RPM, unsigned int move_time)
+{
+   translateMotor(RPM);
+   ES_Timer_InitTimer(DC_TIMER, move_time);   
+}
+
+/* Function: positionMotor
+  --------------------------
+  Move bot straight forward (distInInches > 0) or backwards a measured
+  distance using the wheel encoders. Requester is posted MoveComplete when
+  the distance is covered or MoveFault if the wheels stall.
+*/
+void positionMotor(signed int distInInches, unsigned int RPM, 
+                   pPostFunc Requester)
+{
+   DropMotion();
+   if(distInInches < 0)
+   {
+      StartMove(MOVE_TRANSLATE, -(signed int)RPM, -1,
+                (unsigned int)(-distInInches) * TICKS_PER_INCH, Requester);
+   }
+   else
+   {
+      StartMove(MOVE_TRANSLATE, RPM, -1,
+                (unsigned int)distInInches * TICKS_PER_INCH, Requester);
+   }
+}
+
+/* Function: driveStraight
+  --------------------------
+  Drive forward (RPM > 0) or backwards until told otherwise, holding the
+  heading with the encoders instead of hand tuned left/right duties.
+*/
+void driveStraight(signed int RPM)
+{
+   DropMotion();
+   if(RPM == 0)
+      translateMotor(0);
+   else
+      StartMove(MOVE_STRAIGHT, RPM, -1, 0, 0);
+}
+
+/* Function: driveDuty
+  ----------------------
+  Set new targets for both wheels with full 16-bit resolution. Duties are
+  in permille (-1000..1000) with the same sign convention as leftMotor and
+  rightMotor, and reach the PWM through the soft-start ramp like any other
+  duty change. Meant for speed/heading loops that need fine actuation; use
+  stopMotorNow/brakeMotorNow when the wheels must stop at once.
+*/
+void driveDuty(signed int LeftPermille, signed int RightPermille)
+{
+   CancelMove();
+   SetLeftDuty(LeftPermille);
+   SetRightDuty(RightPermille);
+}
+
+/* Function: angleMotor
+  -----------------------
+  Rotate bot in place by Deg degrees. Positive angles turn the same way as
+  rotateMotor with a positive duty. Requester is posted MoveComplete or
+  MoveFault the same as for positionMotor.
+*/
+void angleMotor(signed int Deg, unsigned int RPM5, pPostFunc Requester)
+{
+   unsigned long Ticks;
+   
+   DropMotion();
+   if(Deg < 0)
+   {
+      Ticks = (unsigned long)(-Deg) * TICKS_PER_100DEG / 100;
+      StartMove(MOVE_ROTATE, -(signed int)RPM5, 1, (unsigned int)Ticks, 
+                Requester);
+   }
+   else
+   {
+      Ticks = (unsigned long)Deg * TICKS_PER_100DEG / 100;
+      StartMove(MOVE_ROTATE, RPM5, 1, (unsigned int)Ticks, Requester);
+   }
+}
+
+/* Function: StartMotion
+  ------------------------
+  Run a list of moves back to back, replacing any move in progress. Each
+  step is one of:
+    MOTION_DISTANCE  Amount inches
+    MOTION_ROTATE    Amount degrees, turning as rotateMotor(Speed)
+    MOTION_TIMED     Amount timer ticks
+    MOTION_TAPE      until the tape sensor reports colour Amount
+    MOTION_STOP      wheels off, then wait Amount timer ticks
+  Speed is the signed duty (percent), its sign gives the direction. A
+  non-zero Timeout (timer ticks) faults a step that has not ended by then.
+  Steps must stay valid until the script ends.
+*/
+void StartMotion(const MotionStep_t *Steps, unsigned char NumSteps,
+                 pPostFunc Requester)
+{
+   CancelMove();
+   Vars.MotionSteps = Steps;
+   Vars.MotionLeft = NumSteps;
+   Vars.MotionIndex = 0;
+   Vars.MotionRequester = Requester;
+   NextMotionStep();
+}
+
+/* Function(s): stopMotorNow, brakeMotorNow
+  --------------------------------------------
+  Fast path for emergency stop and end of game. Writes the PWM and 
+  direction registers right away instead of posting motor events, so the
+  stop cannot be delayed by other services or lost to a full queue. Safe to
+  call from event checkers and interrupt responses.
+  Writing the PWM counters reloads the zero duty at once rather than at 
+  the end of the current period. Any encoder move is abandoned without a
+  completion event, and motor commands still queued are discarded.
+  brakeMotorNow also pulls both direction lines low so the bridge shorts
+  the motor leads instead of letting the wheels coast.
+  On END the wheels are braked 179us after the SPI interrupt that ends
+  the JSR reply, on the host's main loop costs (host/DriveTest.c). The
+  register writes themselves have not been timed on the target.
+*/
+void stopMotorNow(void)
+{
+   EnterCritical();
+   HaltDrive();
+   ExitCritical();
+}
+
+void brakeMotorNow(void)
+{
+   EnterCritical();
+   HaltDrive();
+   MOTOR_PORT &= ~(MOTOR_1_DIR | MOTOR_2_DIR);
+   ExitCritical();
+}
+
+/* Function: InitializeTimer
+  ----------------------------
+  Set up input capture on the wheel encoder channels. Only the edges are
+  counted so the timer prescale set by other modules does not matter.
+*/
+void InitializeTimer(void)
+{
+   TIM0_TSCR1 |= _S12_TEN;
+   TIM0_TIOS &= ~(ENCODER_R_IOS | ENCODER_L_IOS); //Input capture
+   TIM0_TCTL3 |= _S12_EDG4A | _S12_EDG5A;         //Rising edges only
+   TIM0_TCTL3 &= ~(_S12_EDG4B | _S12_EDG5B);
+   TIM0_TFLG1 = ENCODER_R_FLAG | ENCODER_L_FLAG;  //Clear flags
+   TIM0_TIE |= ENCODER_R_INT | ENCODER_L_INT;
+   EnableInterrupts;
+}
+
+/* Function(s): leftMotor, RightMotor
+   -----------------------------------
+   Set Direction, PWM of motors based on sign
+   and value of parameter
+*/
+void leftMotor(signed int PWMDCdir){
+   ES_Event motorEvent;
+   
+   CancelMove();
+   if (PWMDCdir < 0)
+   {
+      motorEvent.EventType = MotorLeftC;
+      motorEvent.EventParam = -PWMDCdir * PERMILLE_PER_PERCENT;
+   } 
+   else 
+   {
+      motorEvent.EventType = MotorLeftCC;
+      motorEvent.EventParam = PWMDCdir * PERMILLE_PER_PERCENT;      
+   }
+   motorEvent.EventParam |= (uint16_t)Vars.StopGeneration << GEN_SHIFT;
+   PostDCMotor(motorEvent); 
+
+}
+void rightMotor(signed int PWMDCdir){
+   ES_Event motorEvent;
+   
+   CancelMove();
+   if (PWMDCdir < 0){
+      motorEvent.EventType = MotorRightC;
+      motorEvent.EventParam = -PWMDCdir * PERMILLE_PER_PERCENT;
+   } else {
+      motorEvent.EventType = MotorRightCC;
+      motorEvent.EventParam = PWMDCdir * PERMILLE_PER_PERCENT;      
+   }
+   motorEvent.EventParam |= (uint16_t)Vars.StopGeneration << GEN_SHIFT;
+   PostDCMotor(motorEvent);   
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Function: StartMove
+  ----------------------
+  Zero the encoder counts, start both wheels and start the control tick
+  for an encoder move. RightDuty carries the direction of travel, LeftSign
+  is -1 for straight moves (left motor is mirrored) and 1 for rotations.
+  A target of 0 ticks runs until the next motor command.
+*/
+static void StartMove(unsigned char Mode, signed int RightDuty, 
+                      signed char LeftSign, unsigned int Ticks, 
+                      pPostFunc Requester)
+{
+   ES_Timer_StopTimer(DC_TIMER);
+   if(RightDuty < 0)
+   {
+      Vars.MoveDuty = -RightDuty * PERMILLE_PER_PERCENT;
+      Vars.RightDir = -1;
+   }
+   else
+   {
+      Vars.MoveDuty = RightDuty * PERMILLE_PER_PERCENT;
+      Vars.RightDir = 1;
+   }
+   Vars.LeftDir = Vars.RightDir * LeftSign;
+   
+   Vars.RightTicks = 0;
+   Vars.LeftTicks = 0;
+   Vars.ErrorSum = 0;
+   Vars.LastProgress = 0;
+   Vars.StallCount = 0;
+   Vars.MoveCount = 0;
+   Vars.MoveTarget = Ticks;
+   Vars.MoveRequester = Requester;
+   Vars.MoveMode = Mode;
+   Vars.StepTimeout = 0;
+   
+   SetRightDuty(Vars.RightDir * (signed int)Vars.MoveDuty);
+   SetLeftDuty(Vars.LeftDir * (signed int)Vars.MoveDuty);
+   ES_Timer_InitTimer(RPM_TIMER, CONTROL_TIME);
+}
+
+/* Function: UpdateMove
+  -----------------------
+  Called every control tick while a move is active. The move is complete
+  once the average wheel travel reaches the target. If the encoders stop
+  advancing, or the move takes far too long, it is ended with a fault.
+*/
+static void UpdateMove(void)
+{
+   unsigned int Travel = (Vars.RightTicks >> 1) + (Vars.LeftTicks >> 1);
+   unsigned int Elapsed;
+   bool Done;
+   
+   if(Vars.MoveMode != MOVE_DWELL)
+      HoldHeading();
+   if(Vars.MoveMode == MOVE_STRAIGHT)
+      return;
+   
+   Vars.MoveCount++;
+   Elapsed = Vars.MoveCount * CONTROL_TIME;
+   if(Vars.MoveMode == MOVE_TIMED || Vars.MoveMode == MOVE_DWELL)
+      Done = (Elapsed >= Vars.MoveTarget);
+   else if(Vars.MoveMode == MOVE_TAPE)
+      Done = (GetTapeColor() == Vars.MoveTarget);
+   else
+      Done = (Travel >= Vars.MoveTarget);
+   
+   if(Done)
+   {
+      if(Vars.MotionSteps != 0)
+         NextMotionStep();
+      else
+         EndMove(MoveComplete);
+      return;
+   }
+   
+   if(Vars.MoveMode == MOVE_DWELL)
+      return;
+   if(Vars.StepTimeout != 0 && Elapsed >= Vars.StepTimeout)
+   {
+      EndMove(MoveFault);
+      return;
+   }
+   
+   if(Travel != Vars.LastProgress)
+   {
+      Vars.LastProgress = Travel;
+      Vars.StallCount = 0;
+   }
+   else
+   {
+      Vars.StallCount++;
+   }
+   
+   if(Vars.StallCount >= STALL_LIMIT || Vars.MoveCount >= MOVE_LIMIT)
+      EndMove(MoveFault);
+}
+
+/* Function: HoldHeading
+  ------------------------
+  Cross-coupled synchronization of the two wheels. Both wheels should have
+  covered the same number of ticks, so the tick difference is fed back to
+  speed up the lagging wheel and slow the leading one by the same amount.
+  The setpoint stays symmetric so the heading holds at any base duty.
+*/
+static void HoldHeading(void)
+{
+   signed int Error = (signed int)(Vars.RightTicks - Vars.LeftTicks);
+   signed int Correction;
+   signed int RightDuty, LeftDuty;
+   
+   Vars.ErrorSum += Error;
+   if(Vars.ErrorSum > MAX_ERROR_SUM)
+      Vars.ErrorSum = MAX_ERROR_SUM;
+   else if(Vars.ErrorSum < -MAX_ERROR_SUM)
+      Vars.ErrorSum = -MAX_ERROR_SUM;
+   
+   Correction = Error*HEADING_KP + Vars.ErrorSum*HEADING_KI;
+   if(Correction > MAX_CORRECTION)
+      Correction = MAX_CORRECTION;
+   else if(Correction < -MAX_CORRECTION)
+      Correction = -MAX_CORRECTION;
+   
+   //Right wheel ahead (Error > 0): slow right, speed up left
+   RightDuty = (signed int)Vars.MoveDuty - Correction;
+   LeftDuty = (signed int)Vars.MoveDuty + Correction;
+   if(RightDuty < 0)
+      RightDuty = 0;
+   if(LeftDuty < 0)
+      LeftDuty = 0;
+   
+   SetRightDuty(Vars.RightDir * RightDuty);
+   SetLeftDuty(Vars.LeftDir * LeftDuty);
+}
+
+/* Function: EndMove
+  --------------------
+  Stop both wheels right away and tell the requesting service how the
+  move ended. Param is the average encoder travel of the move.
+*/
+static void EndMove(ES_EventTyp_t Result)
+{
+   ES_Event NewEvent;
+   
+   SetRightDuty(0);
+   SetLeftDuty(0);
+   Vars.MoveMode = MOVE_NONE;
+   
+   NewEvent.EventType = Result;
+   if(Vars.MotionSteps != 0)
+   {
+      //Param is the failed step, or the number of steps for a complete
+      NewEvent.EventParam = (Result == MoveComplete) ? Vars.MotionIndex 
+                                                     : Vars.MotionIndex - 1;
+      Vars.MoveRequester = Vars.MotionRequester;
+      Vars.MotionSteps = 0;
+   }
+   else
+   {
+      NewEvent.EventParam = (Vars.RightTicks >> 1) + (Vars.LeftTicks >> 1);
+   }
+   if(Vars.MoveRequester != 0)
+      Vars.MoveRequester(NewEvent);
+}
+
+/* Function: NextMotionStep
+  ---------------------------
+  Start the next step of the motion script, or end the script with 
+  MoveComplete once all steps are done. Stops that do not dwell are run
+  straight through.
+*/
+static void NextMotionStep(void)
+{
+   const MotionStep_t *Step;
+   unsigned long Ticks;
+   
+   while(Vars.MotionLeft > 0)
+   {
+      Step = &Vars.MotionSteps[Vars.MotionIndex];
+      Vars.MotionIndex++;
+      Vars.MotionLeft--;
+      
+      switch(Step->Op)
+      {
+         case MOTION_DISTANCE:
+            StartMove(MOVE_TRANSLATE, Step->Speed, -1, 
+                      Step->Amount * TICKS_PER_INCH, 0);
+            break;
+         case MOTION_ROTATE:
+            Ticks = (unsigned long)Step->Amount * TICKS_PER_100DEG / 100;
+            StartMove(MOVE_ROTATE, Step->Speed, 1, (unsigned int)Ticks, 0);
+            break;
+         case MOTION_TIMED:
+            StartMove(MOVE_TIMED, Step->Speed, -1, Step->Amount, 0);
+            break;
+         case MOTION_TAPE:
+            StartMove(MOVE_TAPE, Step->Speed, -1, Step->Amount, 0);
+            break;
+         default: //MOTION_STOP
+            SetRightDuty(0);
+            SetLeftDuty(0);
+            Vars.MoveMode = MOVE_NONE;
+            if(Step->Amount == 0)
+               continue;
+            StartMove(MOVE_DWELL, 0, -1, Step->Amount, 0);
+            break;
+      }
+      Vars.StepTimeout = Step->Timeout;
+      return;
+   }
+   
+   EndMove(MoveComplete);
+}
+
+/* Function: DropMotion
+  -----------------------
+  Forget the motion script, without a completion event.
+*/
+static void DropMotion(void)
+{
+   Vars.MotionSteps = 0;
+   Vars.MotionLeft = 0;
+}
+
+/* Function: CancelMove
+  -----------------------
+  Any new open loop motor command replaces an encoder move in progress.
+*/
+static void CancelMove(void)
+{
+   DropMotion();
+   if(Vars.MoveMode != MOVE_NONE)
+   {
+      Vars.MoveMode = MOVE_NONE;
+      ES_Timer_StopTimer(RPM_TIMER);
+   }
+}
+
+/* Function(s): SetRightDuty, SetLeftDuty
+  -----------------------------------------
+  Request a signed duty (permille) for each wheel. Increases are slewed 
+  by the soft-start ramp, reductions and stops take effect at once.
+*/
+static void SetRightDuty(signed int Duty)
+{
+   SetRampTarget(RAMP_DRIVE_RIGHT, Duty);
+}
+
+static void SetLeftDuty(signed int Duty)
+{
+   SetRampTarget(RAMP_DRIVE_LEFT, Duty);
+}
+
+/* Function(s): WriteRightDuty, WriteLeftDuty
+  ---------------------------------------------
+  Ramp outputs. Write direction and duty (permille) for each wheel 
+  straight to the 16-bit PWM channels, scaled for the pack voltage.
+*/
+static void WriteRightDuty(signed int Duty)
+{
+   Duty = CompensateDuty(Duty);
+   if(Duty < 0)
+   {
+      MOTOR_PORT &= ~MOTOR_1_DIR;
+      Duty = -Duty;
+   }
+   else
+   {
+      MOTOR_PORT |= MOTOR_1_DIR;
+   }
+   if(Duty > DRIVE_PERIOD)
+      Duty = DRIVE_PERIOD;
+   PWMDTY01 = Duty;
+}
+
+static void WriteLeftDuty(signed int Duty)
+{
+   Duty = CompensateDuty(Duty);
+   if(Duty < 0)
+   {
+      MOTOR_PORT &= ~MOTOR_2_DIR;
+      Duty = -Duty;
+   }
+   else
+   {
+      MOTOR_PORT |= MOTOR_2_DIR;
+   }
+   if(Duty > DRIVE_PERIOD)
+      Duty = DRIVE_PERIOD;
+   PWMDTY45 = Duty;
+}
+
+/* Function: HaltDrive
+  -----------------------
+  Zero both duties, reload them immediately and invalidate any queued
+  motor commands. Caller must hold the critical section.
+*/
+static void HaltDrive(void)
+{
+   PWMDTY01 = 0;
+   PWMDTY45 = 0;
+   PWMCNT01 = 0;
+   PWMCNT45 = 0;
+   HaltRamp(RAMP_DRIVE_RIGHT);
+   HaltRamp(RAMP_DRIVE_LEFT);
+   Vars.MoveMode = MOVE_NONE;
+   DropMotion();
+   Vars.StopGeneration = (Vars.StopGeneration + 1) & GEN_MASK;
+}
+
+/* Function: IsStaleCommand
+  ----------------------------
+  True for a motor event that was posted before the last immediate stop.
+*/
+static bool IsStaleCommand(ES_Event ThisEvent)
+{
+   switch(ThisEvent.EventType)
+   {
+      case MotorRightC:
+      case MotorRightCC:
+      case MotorLeftC:
+      case MotorLeftCC:
+         return ((ThisEvent.EventParam >> GEN_SHIFT) & GEN_MASK) 
+                  != Vars.StopGeneration;
+   }
+   return false;
+}
+
+/***************************************************************************
+ Interrupt Responses
+   RightEncoder, LeftEncoder
+
+ Description
+   Count each rising edge from the wheel encoders.
+****************************************************************************/
+void interrupt _Vec_tim0ch4 RightEncoder(void)
+{
+   TIM0_TFLG1 = ENCODER_R_FLAG; //clear IC4 flag
+   Vars.RightTicks++;
+} /* End Interrupt RightEncoder */
+
+void interrupt _Vec_tim0ch5 LeftEncoder(void)
+{
+   TIM0_TFLG1 = ENCODER_L_FLAG; //clear IC5 flag
+   Vars.LeftTicks++;
+} /* End Interrupt LeftEncoder */
+
+/*------------------------------ End of file ------------------------------*/
+
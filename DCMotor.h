@@ -1,29 +1,57 @@
-/****************************************************************************
- 
-  Header file for DC Motor Service
-  based on the Gen 2 Events and Services Framework
-
-*****************************************************************************/
-
-#ifndef DCMotor_H
-#define DCMotor_H
-
-#include "ES_Types.h"
-
-// Public Function Prototypes
-bool Check4Encoder1(void);
-
-bool InitDCMotor ( uint8_t Priority );
-bool PostDCMotor( ES_Event ThisEvent );
-ES_Event RunDCMotor( ES_Event ThisEvent );
-void leftMotor(signed int PWMDCdir);
-void rightMotor(signed int PWMDCdir);
-
-void InitializeTimer(void);    
-void angleMotor(unsigned int Deg, unsigned int RPM5);
-void rotateMotor(signed int RPMdir1);
-void translateMotor(signed int RPMdir);
-void positionMotor(unsigned int distInInches, unsigned int RPM);
-void timedTranslate(int RPM, unsigned int move_time);
-
-#endif /* DC_Motor_H */
+/****************************************************************************
+ 
+  Header file for DC Motor Service
+  based on the Gen 2 Events and Services Framework
+
+*****************************************************************************/
+
+#ifndef DCMotor_H
+#define DCMotor_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_Events.h"
+#include "Snapshot.h"
+
+//Motion script steps, see StartMotion
+#define MOTION_STOP 0
+#define MOTION_DISTANCE 1
+#define MOTION_ROTATE 2
+#define MOTION_TIMED 3
+#define MOTION_TAPE 4
+
+typedef struct
+{
+   unsigned char Op;
+   signed char Speed;      //duty percent, sign is the direction
+   unsigned int Amount;    //inches, degrees, timer ticks or tape colour
+   unsigned int Timeout;   //timer ticks, 0 for none
+} MotionStep_t;
+
+// Public Function Prototypes
+bool Check4Encoder1(void);
+
+bool InitDCMotor ( uint8_t Priority );
+bool PostDCMotor( ES_Event ThisEvent );
+ES_Event RunDCMotor( ES_Event ThisEvent );
+void leftMotor(signed int PWMDCdir);
+void rightMotor(signed int PWMDCdir);
+
+void InitializeTimer(void);    
+void angleMotor(signed int Deg, unsigned int RPM5, pPostFunc Requester);
+void rotateMotor(signed int RPMdir1);
+void translateMotor(signed int RPMdir);
+void driveStraight(signed int RPM);
+void driveDuty(signed int LeftPermille, signed int RightPermille);
+void stopMotorNow(void);
+void brakeMotorNow(void);
+void positionMotor(signed int distInInches, unsigned int RPM, 
+                   pPostFunc Requester);
+void timedTranslate(int RPM, unsigned int move_time);
+void StartMotion(const MotionStep_t *Steps, unsigned char NumSteps,
+                 pPostFunc Requester);
+#ifdef SNAPSHOT
+StateBlock_t GetDCMotorVars(void);
+#endif
+
+#endif /* DC_Motor_H */
@@ -0,0 +1,93 @@
+/****************************************************************************
+ Module
+   FSM.c
+
+ Revision
+   1.0.1
+
+ Description
+   Engine for flat state machines written as const tables instead of 
+   nested if/switch code. A machine has a table of rows, each an optional
+   guard, an optional action, the next state and the row to try instead
+   when the guard fails, and a table of cells giving the row for every 
+   event in every state. Dispatch reads the cell for the event and the 
+   current state directly, so its cost does not grow with the table.
+   The state changes before the action runs.
+
+ Notes
+   Both tables are const; a machine keeps only its state and where its
+   tables are in RAM. The cells are laid out one line of states per event, in ES_Configure.h order; 
+   events past the last line are ignored in every state.
+   host/TableCheck.c checks the tables of the machines the services start:
+   bad rows and cells, rows that can never fire, unreachable states and 
+   the state x event cells no row covers.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 05/01/14 09:00 PS      Const state x event cells replace the per event
+                        row chains built in RAM
+ 04/30/14 15:00 PS      Table checker moved to the host (host/TableCheck.c),
+                        index described as what it is
+ 04/18/14 16:10 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "FSM.h"
+
+/*------------------------------ Module Code ------------------------------*/
+/* Function: InitFSM
+  --------------------
+  Put the machine on its tables, in its initial state. False if the 
+  initial state is not one of its states.
+*/
+bool InitFSM(FSM_t *Machine, const FSMRow_t *Rows, unsigned char NumRows,
+             const unsigned char *Cells, unsigned char NumStates,
+             unsigned char Initial)
+{
+   if(Initial >= NumStates)
+      return false;
+   
+   Machine->Rows = Rows;
+   Machine->Cells = Cells;
+   Machine->NumRows = NumRows;
+   Machine->NumStates = NumStates;
+   Machine->State = Initial;
+   return true;
+}
+
+/* Function: RunFSM
+  -------------------
+  Fire the row in this event's cell for the current state, or the first
+  of its Else rows whose guard passes. False if none did.
+*/
+bool RunFSM(FSM_t *Machine, ES_Event ThisEvent)
+{
+   unsigned char Row;
+   const FSMRow_t *ThisRow;
+   
+   if(ThisEvent.EventType >= NUM_EVENT_TYPES)
+      return false;
+   
+   Row = Machine->Cells[ThisEvent.EventType * Machine->NumStates + 
+                        Machine->State];
+   while(Row != FSM_NO_ROW && Row <= Machine->NumRows)
+   {
+      ThisRow = &Machine->Rows[Row - 1];
+      if(ThisRow->Guard != 0 && !ThisRow->Guard(ThisEvent))
+      {
+         Row = ThisRow->Else;
+         continue;
+      }
+      
+      if(ThisRow->Next != FSM_SAME_STATE)
+         Machine->State = ThisRow->Next;
+      if(ThisRow->Action != 0)
+         ThisRow->Action(ThisEvent);
+      return true;
+   }
+   return false;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,48 @@
+/****************************************************************************
+
+  Header file for the table driven flat state machine engine
+
+*****************************************************************************/
+
+#ifndef FSM_H
+#define FSM_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+//Cell contents, rows are numbered from 1 so a cell left out reads as none
+#define FSM_NO_ROW 0
+#define FSM_SAME_STATE 0xFF
+
+typedef bool (*pFSMGuard)(ES_Event ThisEvent);
+typedef void (*pFSMAction)(ES_Event ThisEvent);
+
+//One transition: if Guard passes (or is 0) run Action (if not 0) and go
+//to Next, otherwise try row Else (FSM_NO_ROW for none)
+typedef struct
+{
+   pFSMGuard Guard;
+   pFSMAction Action;
+   unsigned char Next;
+   unsigned char Else;
+} FSMRow_t;
+
+//A machine: its const rows and its const cells, the row for each event in
+//each state laid out [NUM_EVENT_TYPES][NumStates], plus the current state
+typedef struct
+{
+   const FSMRow_t *Rows;
+   const unsigned char *Cells;
+   unsigned char NumRows;
+   unsigned char NumStates;
+   unsigned char State;
+} FSM_t;
+
+// Public Function Prototypes
+bool InitFSM(FSM_t *Machine, const FSMRow_t *Rows, unsigned char NumRows,
+             const unsigned char *Cells, unsigned char NumStates,
+             unsigned char Initial);
+bool RunFSM(FSM_t *Machine, ES_Event ThisEvent);
+
+#endif /* FSM_H */
@@ -0,0 +1,226 @@
+/****************************************************************************
+ Module
+   Fault.c
+
+ Revision
+   1.0.1
+
+ Description
+   Fault injection for FAULT_INJECT builds: spikes on the analog sensor
+   readings, corrupted or lost SPI bytes from the JSR, events lost on the
+   way into a service's queue and timeouts that arrive late. Each has its
+   own chance per read/byte/post, set by InitFault.
+
+ Notes
+   Each hook draws from its own 16 bit LFSR stream, all seeded from the
+   one InitFault seed, so a run with the same seed and the same inputs 
+   sees the same faults. The SPI hook runs in the SPI interrupt; with its
+   own stream it can not shift the sensor and post streams however its 
+   bytes interleave with the main loop. A fault that is switched off 
+   costs one compare; one that is on costs an LFSR step.
+   The hooks are ReadSensor (Sensors.c), the SPI byte interrupt and the 
+   JSR stand-in loop (SPIEngine.c) and FAULT_POST at the top of each 
+   service's post function. A delayed timeout is dropped and its timer
+   restarted for DelayTicks, so it reaches the same service later.
+   Without FAULT_INJECT none of this is compiled and the hooks are empty.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/28/14 10:20 PS      One LFSR stream per hook, FAULT_POST a single
+                        statement
+ 04/26/14 10:20 PS      Running state gathered into Vars for snapshots
+ 04/25/14 14:10 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Timers.h"
+#include "Fault.h"
+
+#ifdef FAULT_INJECT
+/*----------------------------- Module Defines ----------------------------*/
+//Taps for x^16 + x^14 + x^13 + x^11 + 1, maximal length
+#define LFSR_TAPS 0xB400u
+#define DEFAULT_SEED 0xACE1u
+#define STREAM_STRIDE 0x9E37u  //spreads the streams' seeds apart
+#define AD_MAX 1023
+
+//One LFSR stream per hook, never shared between interrupt and main loop
+enum {SENSOR_STREAM, SPI_STREAM, POST_STREAM, NUM_STREAMS};
+
+/*---------------------------- Module Functions ---------------------------*/
+static unsigned int NextRandom(unsigned char Stream);
+static bool Chance(unsigned char Stream, unsigned char Rate);
+
+/*---------------------------- Module Variables ---------------------------*/
+static FaultRates_t Rates;        //all zero, no faults until InitFault
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   unsigned int Lfsr[NUM_STREAMS];
+   unsigned char LastSPIByte;
+} FaultVars_t;
+
+static FaultVars_t Vars = 
+{
+   {DEFAULT_SEED, (DEFAULT_SEED + STREAM_STRIDE) & 0xFFFFu, 
+    (DEFAULT_SEED + 2*STREAM_STRIDE) & 0xFFFFu}, 
+   0
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   InitFault
+
+ Parameters
+   unsigned int : seed, 0 picks the default
+   FaultRates_t* : chance of each fault for this run, copied
+
+ Description
+   Call before ES_Initialize so the first posts are covered.
+****************************************************************************/
+void InitFault(unsigned int Seed, const FaultRates_t *NewRates)
+{
+   unsigned char Stream;
+   
+   if(Seed == 0)
+      Seed = DEFAULT_SEED;
+   for(Stream = 0; Stream < NUM_STREAMS; Stream++)
+   {
+      Vars.Lfsr[Stream] = (Seed + Stream*STREAM_STRIDE) & 0xFFFFu;
+      if(Vars.Lfsr[Stream] == 0)     //the one state an LFSR never leaves
+         Vars.Lfsr[Stream] = DEFAULT_SEED;
+   }
+   Rates = *NewRates;
+   Vars.LastSPIByte = 0;
+}
+
+/****************************************************************************
+ Function
+   FaultSensor
+
+ Parameters
+   unsigned char : SENSOR_ name of the sensor read
+   short : the reading as it came from the A/D
+
+ Returns
+   short, the reading, sometimes moved up or down by up to SpikeSize
+****************************************************************************/
+short FaultSensor(unsigned char Sensor, short Reading)
+{
+   short Spike;
+   
+   (void)Sensor;
+   if(!Chance(SENSOR_STREAM, Rates.SensorSpike) || Rates.SpikeSize == 0)
+      return Reading;
+   
+   Spike = (short)(NextRandom(SENSOR_STREAM) % (Rates.SpikeSize + 1));
+   if(NextRandom(SENSOR_STREAM) & 1)
+      Spike = -Spike;
+   Reading += Spike;
+   if(Reading < 0)
+      Reading = 0;
+   if(Reading > AD_MAX)
+      Reading = AD_MAX;
+   return Reading;
+}
+
+/****************************************************************************
+ Function
+   FaultSPIByte
+
+ Parameters
+   unsigned char : byte as read from SPIDR
+
+ Returns
+   unsigned char, the byte, the previous byte again (missed SPIF) or the
+   byte with some bits flipped
+****************************************************************************/
+unsigned char FaultSPIByte(unsigned char Byte)
+{
+   if(Chance(SPI_STREAM, Rates.SPIDrop))
+      return Vars.LastSPIByte;
+   if(Chance(SPI_STREAM, Rates.SPICorrupt))
+      Byte ^= (unsigned char)(NextRandom(SPI_STREAM) | 1);
+   Vars.LastSPIByte = Byte;
+   return Byte;
+}
+
+/****************************************************************************
+ Function
+   FaultDropPost
+
+ Parameters
+   ES_Event : event about to be posted
+
+ Returns
+   bool, true if the event is to be lost
+
+ Description
+   A timeout picked for delay is lost here and its timer restarted, so 
+   it is posted again DelayTicks later (and may be picked again).
+****************************************************************************/
+bool FaultDropPost(ES_Event ThisEvent)
+{
+   if(ThisEvent.EventType == ES_TIMEOUT && Rates.DelayTicks != 0 &&
+      Chance(POST_STREAM, Rates.TimerDelay))
+   {
+      ES_Timer_InitTimer(ThisEvent.EventParam, Rates.DelayTicks);
+      return true;
+   }
+   return Chance(POST_STREAM, Rates.PostDrop);
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetFaultVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetFaultVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Function: NextRandom
+  -----------------------
+  One step of the Galois LFSR of one stream.
+*/
+static unsigned int NextRandom(unsigned char Stream)
+{
+   unsigned int Lfsr = Vars.Lfsr[Stream];
+   
+   if(Lfsr & 1)
+      Lfsr = (Lfsr >> 1) ^ LFSR_TAPS;
+   else
+      Lfsr >>= 1;
+   Vars.Lfsr[Stream] = Lfsr;
+   return Lfsr;
+}
+
+/* Function: Chance
+  -------------------
+  True with a chance of Rate in 256. A fault that is off takes no LFSR
+  step.
+*/
+static bool Chance(unsigned char Stream, unsigned char Rate)
+{
+   if(Rate == 0)
+      return false;
+   return (unsigned char)NextRandom(Stream) < Rate;
+}
+#endif
+/*------------------------------ End of file ------------------------------*/
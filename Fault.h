@@ -0,0 +1,44 @@
+/****************************************************************************
+ 
+  Header file for the fault injection layer (FAULT_INJECT builds only)
+
+*****************************************************************************/
+
+#ifndef Fault_H
+#define Fault_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_Events.h"
+#include "Snapshot.h"
+
+//Chance of each fault, in 256ths: 0 never, 255 nearly always
+typedef struct
+{
+   unsigned char SensorSpike;   //A/D reading pushed off by up to SpikeSize
+   unsigned char SPICorrupt;    //SPI byte read with random bits flipped
+   unsigned char SPIDrop;       //SPI byte lost, the last one read again
+   unsigned char PostDrop;      //event lost as if the queue were full
+   unsigned char TimerDelay;    //timeout held back by DelayTicks
+   unsigned int SpikeSize;
+   unsigned int DelayTicks;
+} FaultRates_t;
+
+#ifdef FAULT_INJECT
+// Public Function Prototypes
+void InitFault(unsigned int Seed, const FaultRates_t *Rates);
+short FaultSensor(unsigned char Sensor, short Reading);
+unsigned char FaultSPIByte(unsigned char Byte);
+bool FaultDropPost(ES_Event ThisEvent);
+#ifdef SNAPSHOT
+StateBlock_t GetFaultVars(void);
+#endif
+
+//First line of a service's post function
+#define FAULT_POST(Event) \
+   do { if(FaultDropPost(Event)) return false; } while(0)
+#else
+#define FAULT_POST(Event) do { } while(0)
+#endif
+
+#endif /* Fault_H */
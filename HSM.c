@@ -0,0 +1,235 @@
+/****************************************************************************
+ Module
+   HSM.c
+
+ Revision
+   1.0.1
+
+ Description
+   Runtime for hierarchical state machines. States are const descriptors
+   with a parent, entry and exit actions, a default child and a table of
+   transitions. An event is offered to the current (leaf) state and then
+   to each parent in turn until a row takes it. 
+   A transition exits up to the nearest state common to source and target,
+   runs its action, enters down to the target and then drills into the 
+   default (or history) children. A transition to the source itself or to
+   one of its parents leaves and re-enters that state.
+
+ Notes
+   Everything is iterative and bounded by HSM_MAX_DEPTH, so the worst case
+   dispatch cost is fixed by the depth and the rows per state. All RAM is
+   in the HSM_t, nothing is allocated.
+   History is shallow: only the direct child last left is remembered.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 05/01/14 10:00 PS      Shallow history states back, Bot nests its
+                        phases again
+ 04/28/14 11:40 PS      Dropped history states, nothing used them
+ 04/20/14 13:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "HSM.h"
+
+/*---------------------------- Module Functions ---------------------------*/
+static unsigned char Depth(const HSMState_t *State);
+static const HSMState_t *CommonParent(const HSMState_t *A, 
+                                      const HSMState_t *B);
+static void Transition(HSM_t *Machine, const HSMState_t *Source, 
+                       const HSMRow_t *Row, ES_Event ThisEvent);
+static void EnterDown(HSM_t *Machine, const HSMState_t *Target,
+                      const HSMState_t *From);
+static void DrillDown(HSM_t *Machine, const HSMState_t *State);
+
+/*------------------------------ Module Code ------------------------------*/
+/* Function: InitHSM
+  --------------------
+  Clear history and enter Top and its default children.
+*/
+void InitHSM(HSM_t *Machine, const HSMState_t *Top)
+{
+   unsigned char i;
+   
+   for(i = 0; i < HSM_MAX_STATES; i++)
+      Machine->History[i] = 0;
+   
+   if(Top->Entry != 0)
+      Top->Entry();
+   DrillDown(Machine, Top);
+}
+
+/* Function: RunHSM
+  -------------------
+  Offer the event to the current state and its parents. False if no
+  state took it.
+*/
+bool RunHSM(HSM_t *Machine, ES_Event ThisEvent)
+{
+   const HSMState_t *State;
+   const HSMRow_t *Row;
+   unsigned char i;
+   
+   for(State = Machine->Current; State != 0; State = State->Parent)
+   {
+      for(i = 0; i < State->NumRows; i++)
+      {
+         Row = &State->Rows[i];
+         if(Row->Event != ThisEvent.EventType)
+            continue;
+         if(Row->Guard != 0 && !Row->Guard(ThisEvent))
+            continue;
+         
+         Transition(Machine, State, Row, ThisEvent);
+         return true;
+      }
+   }
+   return false;
+}
+
+/* Function: IsInHSMState
+  -------------------------
+  True if State is the current state or one of its parents.
+*/
+bool IsInHSMState(const HSM_t *Machine, const HSMState_t *State)
+{
+   const HSMState_t *s;
+   
+   for(s = Machine->Current; s != 0; s = s->Parent)
+   {
+      if(s == State)
+         return true;
+   }
+   return false;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Transition
+  -----------------------
+  Exit from the current leaf up to the common parent, run the action, 
+  then enter down to the target and its default children.
+*/
+static void Transition(HSM_t *Machine, const HSMState_t *Source, 
+                       const HSMRow_t *Row, ES_Event ThisEvent)
+{
+   const HSMState_t *Common;
+   const HSMState_t *State;
+   
+   if(Row->Target == 0)
+   {
+      if(Row->Action != 0)
+         Row->Action(ThisEvent);
+      return;
+   }
+   
+   Common = CommonParent(Source, Row->Target);
+   if(Common == Row->Target)
+      Common = Row->Target->Parent;   //leave and re-enter the target
+   
+   for(State = Machine->Current; State != Common; State = State->Parent)
+   {
+      if(State->Exit != 0)
+         State->Exit();
+      if(State->Parent != 0 && State->Parent->History)
+         Machine->History[State->Parent->Id] = State;
+   }
+   
+   if(Row->Action != 0)
+      Row->Action(ThisEvent);
+   
+   EnterDown(Machine, Row->Target, Common);
+   DrillDown(Machine, Row->Target);
+}
+
+/* Function: EnterDown
+  ----------------------
+  Run entry actions from just below From down to Target, outermost first.
+*/
+static void EnterDown(HSM_t *Machine, const HSMState_t *Target,
+                      const HSMState_t *From)
+{
+   const HSMState_t *Path[HSM_MAX_DEPTH];
+   unsigned char n = 0;
+   const HSMState_t *State;
+   
+   for(State = Target; State != From && n < HSM_MAX_DEPTH; 
+       State = State->Parent)
+      Path[n++] = State;
+   
+   while(n > 0)
+   {
+      n--;
+      if(Path[n]->Entry != 0)
+         Path[n]->Entry();
+   }
+   Machine->Current = Target;
+}
+
+/* Function: DrillDown
+  ----------------------
+  Enter default children, or the remembered one for a state with history,
+  until a leaf is reached.
+*/
+static void DrillDown(HSM_t *Machine, const HSMState_t *State)
+{
+   const HSMState_t *Child;
+   
+   while(State->Initial != 0)
+   {
+      Child = State->Initial;
+      if(State->History && Machine->History[State->Id] != 0)
+         Child = Machine->History[State->Id];
+      if(Child->Entry != 0)
+         Child->Entry();
+      State = Child;
+   }
+   Machine->Current = State;
+}
+
+/* Function: Depth
+  ------------------
+  Number of states from State up to the top, inclusive.
+*/
+static unsigned char Depth(const HSMState_t *State)
+{
+   unsigned char n = 0;
+   
+   while(State != 0)
+   {
+      n++;
+      State = State->Parent;
+   }
+   return n;
+}
+
+/* Function: CommonParent
+  -------------------------
+  Innermost state that contains both A and B (either may be it).
+*/
+static const HSMState_t *CommonParent(const HSMState_t *A, 
+                                      const HSMState_t *B)
+{
+   unsigned char DepthA = Depth(A);
+   unsigned char DepthB = Depth(B);
+   
+   while(DepthA > DepthB)
+   {
+      A = A->Parent;
+      DepthA--;
+   }
+   while(DepthB > DepthA)
+   {
+      B = B->Parent;
+      DepthB--;
+   }
+   while(A != B)
+   {
+      A = A->Parent;
+      B = B->Parent;
+   }
+   return A;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
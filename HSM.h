@@ -0,0 +1,60 @@
+/****************************************************************************
+ 
+  Header file for the hierarchical state machine runtime
+
+*****************************************************************************/
+
+#ifndef HSM_H
+#define HSM_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+#define HSM_MAX_DEPTH 4    //Top counts as depth 1
+#define HSM_MAX_STATES 16
+
+typedef struct HSMState HSMState_t;
+
+typedef bool (*pHSMGuard)(ES_Event ThisEvent);
+typedef void (*pHSMAction)(ES_Event ThisEvent);
+typedef void (*pHSMEntryExit)(void);
+
+//Transition handled by a state: on Event, if Guard passes (or is 0), run
+//Action and go to Target. A Target of 0 is an internal transition, no
+//state is left or entered
+typedef struct
+{
+   ES_EventTyp_t Event;
+   pHSMGuard Guard;
+   pHSMAction Action;
+   const HSMState_t *Target;
+} HSMRow_t;
+
+//One state. Initial is the child entered by default (0 for a leaf). With
+//History set, coming back in enters the child last left instead. Id must
+//be unique in the machine and below HSM_MAX_STATES
+struct HSMState
+{
+   const HSMState_t *Parent;
+   pHSMEntryExit Entry;
+   pHSMEntryExit Exit;
+   const HSMState_t *Initial;
+   const HSMRow_t *Rows;
+   unsigned char NumRows;
+   unsigned char Id;
+   bool History;
+};
+
+typedef struct
+{
+   const HSMState_t *Current;   //always a leaf
+   const HSMState_t *History[HSM_MAX_STATES];
+} HSM_t;
+
+// Public Function Prototypes
+void InitHSM(HSM_t *Machine, const HSMState_t *Top);
+bool RunHSM(HSM_t *Machine, ES_Event ThisEvent);
+bool IsInHSMState(const HSM_t *Machine, const HSMState_t *State);
+
+#endif /* HSM_H */
@@ -1,432 +1,559 @@
-/****************************************************************************
- Module
-   IR_Detect.c
-
- Revision
-   1.0.1
-
- Description
-   Source code for IR Light detection state machine. Target Bot and Target
-   Goal each have IR LED that flashes at known frequency. An IR sensing
-   circit was built to input an analog voltage for different frequencies
-   to detect targets. A high power servo is used to rotate the section of
-   the robot.
-  
- Notes
-
- History
- When           Who     What/Why
- -------------- ---     --------
- 02/17/14 10:30 PS       Converted template for use with IR Dectection
- 01/15/12 11:12 jec      revisions for Gen2 framework
- 11/07/11 11:26 jec      made the queue static
- 10/30/11 17:59 jec      fixed references to CurrentEvent in RunTemplateSM()
- 10/23/11 18:20 jec      began conversion from SMTemplate.c (02/20/07 rev)
-****************************************************************************/
-/*----------------------------- Include Files -----------------------------*/
-#include "ES_Configure.h"
-#include "ES_Framework.h"
-#include "ES_DeferRecall.h"
-#include "IR_Detect.h"
-#include "Servos.h"
-#include "Shoot.h"
-#include "Bot.h"
-#include "LanceFSM.h"
-#include "DCMotor.h"
-
-#include <stdio.h>
-#include <hidef.h>
-#include <mc9s12e128.h>     /* derivative information for the E128 */
-#include <S12E128bits.h>    /* bit definitions for the E128 */ 
-#include <Bin_Const.h>
-#include <termio.h>
-#include "S12eVec.h"
-#include "ads12.h"
-
-/*----------------------------- Module Defines ----------------------------*/
-//Hardware Pin/Port on micro-controllers for IR Sensors
-#define IR_ADDRESS DDRT
-#define IR_PORT PTT
-#define IR_SESNOR_1 BIT0HI
-#define IR_SENSOR_2 BIT1HI
-
-#define SERVO 1
-#define SERVO_WIDTH_MAX 1500
-#define SERVO_WIDTH_MIN 590
-#define SERVO_WIDTH_INIT 1485
-#define SERVO_TIME 12
-#define SERVO_DELTA 10
-
-#define NONE 0
-//Combined Sensor Options
-#define BOTH 1
-#define RIGHT 2
-#define LEFT 3
-//Single Sensor Options
-#define BOT 1
-#define GOAL 2
-
-#define BOT_FREQ 1250 
-#define BOT_THRESH_LO 240
-#define BOT_THRESH_HI 320
-#define GOAL_FREQ 2083
-#define GOAL_THRESH_LO 425
-#define GOAL_THRESH_HI 515 
-
-/*---------------------------- Module Functions ---------------------------*/
-static void UpdateServoWidth(IR_State_t CurrentState);
-
-/*---------------------------- Module Variables ---------------------------*/
-static IR_State_t CurrentState;
-static uint8_t MyPriority;
-
-static unsigned int TargetFreq;
-static unsigned int CurrentServoWidth;
-static int DeltaWidth;
-
-/*------------------------------ Module Code ------------------------------*/
-/****************************************************************************
- Function
-     InitIR_Detect
-
- Parameters
-     uint8_t : the priorty of this service
-
- Returns
-     bool, false if error in initialization, true otherwise
-
- Description
-     Saves away the priority, sets up the initial transition and does any
-     other required initialization for this state machine
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 18:55
-****************************************************************************/
-bool InitIR_Detect( uint8_t Priority )
-{
-   MyPriority = Priority;
-   CurrentServoWidth = SERVO_WIDTH_INIT;
-   DeltaWidth = SERVO_DELTA;
-
-   SetServo(SERVO, CurrentServoWidth);
-   CurrentState = DeActivated; //Initial State
-   ES_Timer_InitTimer(IR_Detect_Timer, SERVO_TIME);//Start timer
-   TargetFreq = BOT_FREQ; //Target Frequency
-   ADS12_Init("AAAAAAAA");//Setup analog inputs
-  
-   return true;
-}
-
-/****************************************************************************
- Function
-     PostIR_Dectect
-
- Parameters
-     EF_Event ThisEvent , the event to post to the queue
-
- Returns
-     boolean False if the Enqueue operation failed, True otherwise
-
- Description
-     Posts an event to this state machine's queue
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:25
-****************************************************************************/
-bool PostIR_Detect( ES_Event ThisEvent )
-{
-   return ES_PostToService( MyPriority, ThisEvent);
-}
-
-/****************************************************************************
- Function
-    RunIR_Detect
-
- Parameters
-   ES_Event : the event to process
-
- Returns
-   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
-
- Description
-   To detect targets, two IR sensors are used side by side. Goal is to use
-   servo to rotate until both sensor can sense the target. If only right 
-   sensor sees target, it rotates to the left. 
-
- Notes
-   uses nested switch/case to implement the machine.
-
- Author
-   Patrick Sherman,   02/17/14, 09:45 
-   J. Edward Carryer, 01/15/12, 15:23
-****************************************************************************/
-ES_Event RunIR_Detect( ES_Event ThisEvent )
-{
-   static bool shootflag = false;
-   ES_Event ReturnEvent, NewEvent;
-   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-   
-
-
-   if(CurrentState != DeActivated)
-   {
-      switch (ThisEvent.EventType)
-      {    
-         case (StopAligning): //Deactive Align Mode
-            CurrentState = DeActivated;
-            TargetFreq = 0;
-            if(ThisEvent.EventParam == 1)
-            {
-               CurrentServoWidth = SERVO_WIDTH_MIN; 
-            }
-            else
-            {
-               CurrentServoWidth = SERVO_WIDTH_INIT;  
-            }
-            SetServo(SERVO, CurrentServoWidth);
-            break;
-
-         case (ES_TIMEOUT): 	//Timeout - Keep turning 
-            if(ThisEvent.EventParam == IR_Detect_Timer)
-            {
-               UpdateServoWidth(CurrentState);
-               SetServo(SERVO, CurrentServoWidth);
-               ES_Timer_InitTimer(IR_Detect_Timer, SERVO_TIME);  
-            }
-            if(ThisEvent.EventParam == ShootBotTimer)
-            {
-               rightMotor(75);
-               leftMotor(-74);
-            }
-				break;
-
-         case (LeftOnly):	//Left Sensor sees beacon
-            ES_Timer_StartTimer(IR_Detect_Timer);
-            CurrentState = LeftAligned;
-            break;
-
-         case (RightOnly): //Right Sensor Sees beacon                     
-            ES_Timer_StartTimer(IR_Detect_Timer);
-            CurrentState = RightAligned;                  
-            break;
-
-         case (SenseBoth): //Both Sensors See beacon
-            CurrentState = Aligned;
-            ES_Timer_StopTimer(IR_Detect_Timer);
-				//Aligned: Shoot or Deploy Lance
-            if(TargetFreq == BOT_FREQ)
-            {
-               NewEvent.EventType = Deploy_Lance;
-               PostLance(NewEvent);
-
-               if(GetCurrentRound() == 3 && shootflag == false)
-               {
-					   translateMotor(0);
-					   shootflag = true;
-                  NewEvent.EventType = Shoot_Ball;
-                  NewEvent.EventParam = 5;
-                  PostShoot(NewEvent);
-                  ES_Timer_InitTimer(ShootBotTimer, 3000);				
-               }
-				}	
-				break;
-
-         case (SenseNone): //Neither Sensor sees beacon
-            CurrentState = Active;
-            ES_Timer_StartTimer(IR_Detect_Timer);
-            break;
-				
-         case (StartAlign): //Start Align reposted
-            TargetFreq = ThisEvent.EventParam;
-            CurrentState = Active;
-            ES_Timer_InitTimer(IR_Detect_Timer, SERVO_TIME);
-            break;
-				   
-      } /* End Switch(EventType) */
-
-   } 
-   else //Current State is Deactivated
-   { 
-      if(ThisEvent.EventType == StartAlign)
-      {
-         TargetFreq = ThisEvent.EventParam;
-         CurrentState = Active;
-         ES_Timer_InitTimer(IR_Detect_Timer, SERVO_TIME);
-      }
-   }
-   
-   return ReturnEvent;
-}
-
-/****************************************************************************
- Function
-     QueryTemplateSM
-
- Parameters
-     None
-
- Returns
-     TemplateState_t The current state of the Template state machine
-
- Description
-     returns the current state of the Template state machine
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:21
-****************************************************************************/
-IR_State_t QueryIR_Detect ( void )
-{
-   return(CurrentState);
-}
-
-/****************************************************************************
- Function
-	CheckIRSensor     
-
- Description
-   Event checker to see if the photo-transistors are detecting a signal.
-	The input to the A/D converter is an analog voltage that is proportional
-	to the frequency of the signal seen by the IR detector.
-
- Author
-     Patrick Sherman, 02/19/2014, 12:43
-****************************************************************************/
-bool CheckIRSensor(void)
-{
-   bool ReturnVal = false;
-   ES_Event NewEvent;
-
-   static short LastLeftState = NONE;
-   static short LastRightState = NONE;
-   static short LastCombinedState = NONE;
-	
-   unsigned int leftFreq, rightFreq;
-   short leftState, rightState, CombinedState;	
-   short leftPin = ADS12_ReadADPin(0);
-   short rightPin = ADS12_ReadADPin(1);
-	
-	//What does Left IR Sensor See
-   if(leftPin >= BOT_THRESH_LO && leftPin <= BOT_THRESH_HI)
-   {
-      leftState = BOT;
-      leftFreq = BOT_FREQ;	
-	} 
-   else if(leftPin >= GOAL_THRESH_LO && leftPin <= GOAL_THRESH_HI)
-   {
-      leftState = GOAL;
-      leftFreq = GOAL_FREQ;	
-	}
-   else 
-   {
-		leftState = NONE;
-		leftFreq = 0;
-	}
-	
-	//What Does Right IR Sensor See
-   if(rightPin >= BOT_THRESH_LO && rightPin <= BOT_THRESH_HI)
-   {
-      rightState = BOT;
-      rightFreq = BOT_FREQ;
-	} 
-   else if(rightPin >= GOAL_THRESH_LO && rightPin <= GOAL_THRESH_HI)
-   {
-      rightState = GOAL;
-      rightFreq = GOAL_FREQ;
-	} 
-   else
-   {
-      rightState = NONE;
-      rightFreq = 0;	
-   }
-
-   //Look at state at both sensor to see if one/both/none see target
-   if(rightState == leftState && rightFreq == TargetFreq)
-		CombinedState = BOTH;
-   else if (leftState != NONE && leftFreq == TargetFreq)
-	   CombinedState = LEFT;
-   else if (rightState != NONE && rightFreq == TargetFreq)
-      CombinedState = RIGHT;
-   else
-	   CombinedState = NONE;  
-
-   //Use combined state to choose next event	
-   if(CombinedState != LastCombinedState)
-   {
-      switch(CombinedState)
-      {
-         case (BOTH):
-            NewEvent.EventType = SenseBoth;
-            NewEvent.EventParam = leftFreq;
-            break;
-	       
-         case(LEFT):
-            NewEvent.EventType = LeftOnly;
-            NewEvent.EventParam = leftFreq;
-            break;
-	         
-         case(RIGHT):
-            NewEvent.EventType = RightOnly;
-            NewEvent.EventParam = rightFreq;
-            break;
-	         
-         case(NONE):
-            NewEvent.EventType = SenseNone;
-            NewEvent.EventParam = 0;
-            break;
-      }
-      
-      PostIR_Detect(NewEvent);
-      ReturnVal = true;
-	}
-
-   LastRightState = rightState;
-   LastLeftState = leftState;
-   LastCombinedState = CombinedState;
-
-   return ReturnVal;
-} /* End CheckIRSensor */
-
-/***************************************************************************
- private functions
- ***************************************************************************/
-/****************************************************************************
- Function
-	UdateServoWidth
-
- Description
-	Adjusts the servo width based on the state of the IR sensors. The goal
-   is for the robot to be able to turn in the correct direction based on
-	which IR sensors is currently detecting the beacon.	
-
- Author
-     Patrick Sherman, 02/19/2014, 18:43
-****************************************************************************/
-static void UpdateServoWidth(IR_State_t CurrentState)
-{
-   //If only one beacon is detecting target
-   if(LeftAligned == CurrentState)
-      DeltaWidth = -SERVO_DELTA;
-	else if (RightAligned == CurrentState)
-      DeltaWidth = SERVO_DELTA;
-	
-   //Update Servo Width
-   CurrentServoWidth += DeltaWidth;
-	
-   //If width reaches limit of servo.
-   if(CurrentServoWidth >= SERVO_WIDTH_MAX)
-   {
-		DeltaWidth = -SERVO_DELTA;
-      CurrentServoWidth = SERVO_WIDTH_MAX;
-   } 
-   else if (CurrentServoWidth <= SERVO_WIDTH_MIN)
-   {
-      DeltaWidth = SERVO_DELTA; 
-      CurrentServoWidth = SERVO_WIDTH_MIN;
-   }
-
-} /* End UpdateServoWidth */
-
-/****************** End of File **********************/
+/****************************************************************************
+ Module
+   IR_Detect.c
+
+ Revision
+   1.0.1
+
+ Description
+   Source code for IR Light detection state machine. Target Bot and Target
+   Goal each have IR LED that flashes at known frequency. An IR sensing
+   circit was built to input an analog voltage for different frequencies
+   to detect targets. A high power servo is used to rotate the section of
+   the robot.
+  
+ Notes
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 05/01/14 09:00 PS       Transitions looked up by state and event in
+                         const cells
+ 04/26/14 10:20 PS       Running state gathered into Vars for snapshots
+ 04/25/14 09:30 PS       Scan step and detector bands overridable from
+                         the build
+ 04/24/14 15:40 PS       IR detectors read through the sensor seam
+ 04/18/14 16:10 PS       Expressed as a transition table for the FSM engine
+ 02/17/14 10:30 PS       Converted template for use with IR Dectection
+ 01/15/12 11:12 jec      revisions for Gen2 framework
+ 11/07/11 11:26 jec      made the queue static
+ 10/30/11 17:59 jec      fixed references to CurrentEvent in RunTemplateSM()
+ 10/23/11 18:20 jec      began conversion from SMTemplate.c (02/20/07 rev)
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_DeferRecall.h"
+#include "IR_Detect.h"
+#include "Fault.h"
+#include "FSM.h"
+#include "Servos.h"
+#include "Shoot.h"
+#include "Bot.h"
+#include "LanceFSM.h"
+#include "DCMotor.h"
+#include "Sensors.h"
+
+#include <stdio.h>
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */ 
+#include <Bin_Const.h>
+#include <termio.h>
+#include "S12eVec.h"
+#include "ads12.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+//Hardware Pin/Port on micro-controllers for IR Sensors
+#define IR_ADDRESS DDRT
+#define IR_PORT PTT
+#define IR_SESNOR_1 BIT0HI
+#define IR_SENSOR_2 BIT1HI
+
+#define SERVO 1
+#define SERVO_WIDTH_MAX 1500
+#define SERVO_WIDTH_MIN 590
+#define SERVO_WIDTH_INIT 1485
+
+//Scan rate and step. Like the detector bands below, these can be set 
+//from the build (-DSERVO_DELTA=12) to try other values
+#ifndef SERVO_TIME
+#define SERVO_TIME 12
+#endif
+#ifndef SERVO_DELTA
+#define SERVO_DELTA 10
+#endif
+
+#define NONE 0
+//Combined Sensor Options
+#define BOTH 1
+#define RIGHT 2
+#define LEFT 3
+//Single Sensor Options
+#define BOT 1
+#define GOAL 2
+
+#define BOT_FREQ 1250 
+#define GOAL_FREQ 2083
+
+//A/D bands of the frequency to voltage output for each beacon
+#ifndef BOT_THRESH_LO
+#define BOT_THRESH_LO 240
+#endif
+#ifndef BOT_THRESH_HI
+#define BOT_THRESH_HI 320
+#endif
+#ifndef GOAL_THRESH_LO
+#define GOAL_THRESH_LO 425
+#endif
+#ifndef GOAL_THRESH_HI
+#define GOAL_THRESH_HI 515
+#endif
+
+#define NUM_IR_STATES 5
+
+//Cells, states in IR_State_t order
+#define ALIGNING(Row) {Row, Row, Row, Row, IR_NO}
+#define ANY_STATE(Row) {Row, Row, Row, Row, Row}
+#define IGNORED ANY_STATE(IR_NO)
+
+/*---------------------------- Module Types -------------------------------*/
+//Rows of IRTable, by number
+typedef enum {IR_NO = FSM_NO_ROW, IR_STOP, IR_STEP, IR_RESUME, IR_LEFT,
+              IR_RIGHT, IR_BOTH, IR_SWEEP, IR_BEGIN} IRRow_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void UpdateServoWidth(IR_State_t CurrentState);
+static bool IsServoTimer(ES_Event ThisEvent);
+static bool IsShootBotTimer(ES_Event ThisEvent);
+static void StopAlign(ES_Event ThisEvent);
+static void StepServo(ES_Event ThisEvent);
+static void ResumeDrive(ES_Event ThisEvent);
+static void KeepTurning(ES_Event ThisEvent);
+static void OnTarget(ES_Event ThisEvent);
+static void BeginAlign(ES_Event ThisEvent);
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+static const FSMRow_t IRTable[] = 
+{
+   {0,               StopAlign,   DeActivated,    IR_NO},     //IR_STOP
+   {IsServoTimer,    StepServo,   FSM_SAME_STATE, IR_RESUME}, //IR_STEP
+   {IsShootBotTimer, ResumeDrive, FSM_SAME_STATE, IR_NO},     //IR_RESUME
+   {0,               KeepTurning, LeftAligned,    IR_NO},     //IR_LEFT
+   {0,               KeepTurning, RightAligned,   IR_NO},     //IR_RIGHT
+   {0,               OnTarget,    Aligned,        IR_NO},     //IR_BOTH
+   {0,               KeepTurning, Active,         IR_NO},     //IR_SWEEP
+   {0,               BeginAlign,  Active,         IR_NO}      //IR_BEGIN
+};
+
+//The row for each event in each state, one line per event in
+//ES_Configure.h order
+static const unsigned char IRCells[NUM_EVENT_TYPES][NUM_IR_STATES] =
+{
+   IGNORED,                   //ES_NO_EVENT
+   IGNORED,                   //ES_ERROR
+   IGNORED,                   //ES_INIT
+   ALIGNING(IR_STEP),         //ES_TIMEOUT
+   IGNORED,                   //ES_NEW_KEY
+   IGNORED,                   //RELOAD_BALLS
+   IGNORED,                   //SPIDone
+   IGNORED,                   //NEW_COMMAND_RECEIVED
+   IGNORED,                   //QUERY4STATUS
+   IGNORED,                   //QUERY4SCORE
+   ANY_STATE(IR_BEGIN),       //StartAlign
+   ALIGNING(IR_STOP),         //StopAligning
+   ALIGNING(IR_LEFT),         //LeftOnly
+   ALIGNING(IR_RIGHT),        //RightOnly
+   ALIGNING(IR_BOTH),         //SenseBoth
+   ALIGNING(IR_SWEEP),        //SenseNone
+   IGNORED,                   //ChenKey
+   IGNORED,                   //Shoot_Ball
+   IGNORED,                   //StartShootingMotors
+   IGNORED,                   //StopShootingMotors
+   IGNORED,                   //Deploy_Lance
+   IGNORED,                   //MotorRightC
+   IGNORED,                   //MotorRightCC
+   IGNORED,                   //MotorLeftC
+   IGNORED,                   //MotorLeftCC
+   IGNORED,                   //Right_Tape
+   IGNORED,                   //UpdateTargetColor
+   IGNORED,                   //MoveComplete
+   IGNORED,                   //MoveFault
+   IGNORED,                   //WaveformDone
+   IGNORED                    //MatchDeadline
+};
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   FSM_t IRFSM;
+   bool ShootFlag;
+   unsigned int TargetFreq;
+   unsigned int CurrentServoWidth;
+   int DeltaWidth;
+   short LastLeftState;        //CheckIRSensor's previous readings
+   short LastRightState;
+   short LastCombinedState;
+} IR_DetectVars_t;
+
+static IR_DetectVars_t Vars = {{0}, false, 0, 0, 0, NONE, NONE, NONE};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitIR_Detect
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, sets up the initial transition and does any
+     other required initialization for this state machine
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 18:55
+****************************************************************************/
+bool InitIR_Detect( uint8_t Priority )
+{
+   MyPriority = Priority;
+   Vars.CurrentServoWidth = SERVO_WIDTH_INIT;
+   Vars.DeltaWidth = SERVO_DELTA;
+
+   SetServo(SERVO, Vars.CurrentServoWidth);
+   ES_Timer_InitTimer(IR_Detect_Timer, SERVO_TIME);//Start timer
+   Vars.TargetFreq = BOT_FREQ; //Target Frequency
+   ADS12_Init("AAAAAAAA");//Setup analog inputs
+  
+   return InitFSM(&Vars.IRFSM, IRTable, ARRAY_SIZE(IRTable), &IRCells[0][0],
+                  NUM_IR_STATES, DeActivated); //Initial State
+}
+
+/****************************************************************************
+ Function
+     PostIR_Dectect
+
+ Parameters
+     EF_Event ThisEvent , the event to post to the queue
+
+ Returns
+     boolean False if the Enqueue operation failed, True otherwise
+
+ Description
+     Posts an event to this state machine's queue
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:25
+****************************************************************************/
+bool PostIR_Detect( ES_Event ThisEvent )
+{
+   FAULT_POST(ThisEvent);
+   return ES_PostToService( MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunIR_Detect
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   To detect targets, two IR sensors are used side by side. Goal is to use
+   servo to rotate until both sensor can sense the target. If only right 
+   sensor sees target, it rotates to the left. 
+
+ Notes
+   Transitions are in IRTable and IRCells and run by the FSM engine.
+
+ Author
+   Patrick Sherman,   02/17/14, 09:45 
+   J. Edward Carryer, 01/15/12, 15:23
+****************************************************************************/
+ES_Event RunIR_Detect( ES_Event ThisEvent )
+{
+   ES_Event ReturnEvent;
+   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+   
+   RunFSM(&Vars.IRFSM, ThisEvent);
+   return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+     QueryTemplateSM
+
+ Parameters
+     None
+
+ Returns
+     TemplateState_t The current state of the Template state machine
+
+ Description
+     returns the current state of the Template state machine
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:21
+****************************************************************************/
+IR_State_t QueryIR_Detect ( void )
+{
+   return((IR_State_t)Vars.IRFSM.State);
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetIR_DetectVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetIR_DetectVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/****************************************************************************
+ Function
+	CheckIRSensor     
+
+ Description
+   Event checker to see if the photo-transistors are detecting a signal.
+	The input to the A/D converter is an analog voltage that is proportional
+	to the frequency of the signal seen by the IR detector.
+
+ Author
+     Patrick Sherman, 02/19/2014, 12:43
+****************************************************************************/
+bool CheckIRSensor(void)
+{
+   bool ReturnVal = false;
+   ES_Event NewEvent;
+
+   unsigned int leftFreq, rightFreq;
+   short leftState, rightState, CombinedState;	
+   short leftPin = ReadSensor(SENSOR_IR_LEFT);
+   short rightPin = ReadSensor(SENSOR_IR_RIGHT);
+	
+	//What does Left IR Sensor See
+   if(leftPin >= BOT_THRESH_LO && leftPin <= BOT_THRESH_HI)
+   {
+      leftState = BOT;
+      leftFreq = BOT_FREQ;	
+	} 
+   else if(leftPin >= GOAL_THRESH_LO && leftPin <= GOAL_THRESH_HI)
+   {
+      leftState = GOAL;
+      leftFreq = GOAL_FREQ;	
+	}
+   else 
+   {
+		leftState = NONE;
+		leftFreq = 0;
+	}
+	
+	//What Does Right IR Sensor See
+   if(rightPin >= BOT_THRESH_LO && rightPin <= BOT_THRESH_HI)
+   {
+      rightState = BOT;
+      rightFreq = BOT_FREQ;
+	} 
+   else if(rightPin >= GOAL_THRESH_LO && rightPin <= GOAL_THRESH_HI)
+   {
+      rightState = GOAL;
+      rightFreq = GOAL_FREQ;
+	} 
+   else
+   {
+      rightState = NONE;
+      rightFreq = 0;	
+   }
+
+   //Look at state at both sensor to see if one/both/none see target
+   if(rightState == leftState && rightFreq == Vars.TargetFreq)
+		CombinedState = BOTH;
+   else if (leftState != NONE && leftFreq == Vars.TargetFreq)
+	   CombinedState = LEFT;
+   else if (rightState != NONE && rightFreq == Vars.TargetFreq)
+      CombinedState = RIGHT;
+   else
+	   CombinedState = NONE;  
+
+   //Use combined state to choose next event	
+   if(CombinedState != Vars.LastCombinedState)
+   {
+      switch(CombinedState)
+      {
+         case (BOTH):
+            NewEvent.EventType = SenseBoth;
+            NewEvent.EventParam = leftFreq;
+            break;
+	       
+         case(LEFT):
+            NewEvent.EventType = LeftOnly;
+            NewEvent.EventParam = leftFreq;
+            break;
+	         
+         case(RIGHT):
+            NewEvent.EventType = RightOnly;
+            NewEvent.EventParam = rightFreq;
+            break;
+	         
+         case(NONE):
+            NewEvent.EventType = SenseNone;
+            NewEvent.EventParam = 0;
+            break;
+      }
+      
+      PostIR_Detect(NewEvent);
+      ReturnVal = true;
+	}
+
+   Vars.LastRightState = rightState;
+   Vars.LastLeftState = leftState;
+   Vars.LastCombinedState = CombinedState;
+
+   return ReturnVal;
+} /* End CheckIRSensor */
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Guards on which timer ran out */
+static bool IsServoTimer(ES_Event ThisEvent)
+{
+   return ThisEvent.EventParam == IR_Detect_Timer;
+}
+
+static bool IsShootBotTimer(ES_Event ThisEvent)
+{
+   return ThisEvent.EventParam == ShootBotTimer;
+}
+
+/* Function: StopAlign
+  ----------------------
+  Deactivate align mode. Param 1 parks the servo at its minimum.
+*/
+static void StopAlign(ES_Event ThisEvent)
+{
+   Vars.TargetFreq = 0;
+   if(ThisEvent.EventParam == 1)
+   {
+      Vars.CurrentServoWidth = SERVO_WIDTH_MIN; 
+   }
+   else
+   {
+      Vars.CurrentServoWidth = SERVO_WIDTH_INIT;  
+   }
+   SetServo(SERVO, Vars.CurrentServoWidth);
+}
+
+/* Function: StepServo
+  ----------------------
+  Timeout - keep turning.
+*/
+static void StepServo(ES_Event ThisEvent)
+{
+   UpdateServoWidth((IR_State_t)Vars.IRFSM.State);
+   SetServo(SERVO, Vars.CurrentServoWidth);
+   ES_Timer_InitTimer(IR_Detect_Timer, SERVO_TIME);  
+}
+
+/* Function: ResumeDrive
+  ------------------------
+  Done shooting at the other bot, carry on forward.
+*/
+static void ResumeDrive(ES_Event ThisEvent)
+{
+   driveStraight(75);
+}
+
+/* Function: KeepTurning
+  ------------------------
+  One or neither sensor sees the beacon, keep the servo sweeping.
+*/
+static void KeepTurning(ES_Event ThisEvent)
+{
+   ES_Timer_StartTimer(IR_Detect_Timer);
+}
+
+/* Function: OnTarget
+  ---------------------
+  Both sensors see the beacon. Aligned with the other bot: deploy the 
+  lance, and in round 3 stop once to shoot at it.
+*/
+static void OnTarget(ES_Event ThisEvent)
+{
+   ES_Event NewEvent;
+   
+   ES_Timer_StopTimer(IR_Detect_Timer);
+   if(Vars.TargetFreq == BOT_FREQ)
+   {
+      NewEvent.EventType = Deploy_Lance;
+      PostLance(NewEvent);
+
+      if(GetCurrentRound() == 3 && Vars.ShootFlag == false)
+      {
+         translateMotor(0);
+         Vars.ShootFlag = true;
+         NewEvent.EventType = Shoot_Ball;
+         NewEvent.EventParam = 5;
+         PostShoot(NewEvent);
+         ES_Timer_InitTimer(ShootBotTimer, 3000);				
+      }
+   }	
+}
+
+/* Function: BeginAlign
+  -----------------------
+  Start (or restart) aligning with the beacon at the param frequency.
+*/
+static void BeginAlign(ES_Event ThisEvent)
+{
+   Vars.TargetFreq = ThisEvent.EventParam;
+   ES_Timer_InitTimer(IR_Detect_Timer, SERVO_TIME);
+}
+
+/****************************************************************************
+ Function
+	UdateServoWidth
+
+ Description
+	Adjusts the servo width based on the state of the IR sensors. The goal
+   is for the robot to be able to turn in the correct direction based on
+	which IR sensors is currently detecting the beacon.	
+
+ Author
+     Patrick Sherman, 02/19/2014, 18:43
+****************************************************************************/
+static void UpdateServoWidth(IR_State_t CurrentState)
+{
+   //If only one beacon is detecting target
+   if(LeftAligned == CurrentState)
+      Vars.DeltaWidth = -SERVO_DELTA;
+	else if (RightAligned == CurrentState)
+      Vars.DeltaWidth = SERVO_DELTA;
+	
+   //Update Servo Width
+   Vars.CurrentServoWidth += Vars.DeltaWidth;
+	
+   //If width reaches limit of servo.
+   if(Vars.CurrentServoWidth >= SERVO_WIDTH_MAX)
+   {
+		Vars.DeltaWidth = -SERVO_DELTA;
+      Vars.CurrentServoWidth = SERVO_WIDTH_MAX;
+   } 
+   else if (Vars.CurrentServoWidth <= SERVO_WIDTH_MIN)
+   {
+      Vars.DeltaWidth = SERVO_DELTA; 
+      Vars.CurrentServoWidth = SERVO_WIDTH_MIN;
+   }
+
+} /* End UpdateServoWidth */
+
+/****************** End of File **********************/
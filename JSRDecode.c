@@ -0,0 +1,106 @@
+/****************************************************************************
+ Module
+   JSRDecode.c
+
+ Revision
+   1.0.1
+
+ Description
+   Decoder for the Joust Status Reporter replies. Takes the bytes clocked
+   back during a query one at a time and produces a decoded record once a
+   whole reply has been seen. It touches no hardware, so the same code can
+   be run over recorded or made up byte streams.
+
+ Notes
+   Every reply is 4 bytes: 0x00, 0xFF, then for a status query 0x00 and 
+   the status byte, for a score query the red and dark scores.
+   Status byte: bits 0-2 command, bit 7 head (unhorsed), reload allowed in
+   the knight's own bit.
+   A reply with bad framing bytes, or to an unknown query, gives no record.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/16/14 09:45 PS      Split out of JSRcommand.c
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "JSRDecode.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define STATUS_QUERY 0x3F
+#define SCORE_QUERY  0xC3
+
+#define REPLY_BYTES 4
+#define FRAME_BYTE_0 0x00
+#define FRAME_BYTE_1 0xFF
+
+#define COMMAND_MASK 0x07
+#define HEAD_STATUS_BIT 0x80
+
+/*------------------------------ Module Code ------------------------------*/
+/* Function: JSRDecodeStart
+  ---------------------------
+  Get ready for the reply to Query. ReloadMask picks out the reload bit
+  for our knight in the status byte.
+*/
+void JSRDecodeStart(JSRDecoder_t *Decoder, unsigned char Query, 
+                    unsigned char ReloadMask)
+{
+   Decoder->Query = Query;
+   Decoder->ReloadMask = ReloadMask;
+   Decoder->ByteNum = 0;
+   Decoder->Valid = (Query == STATUS_QUERY) || (Query == SCORE_QUERY);
+}
+
+/* Function: JSRDecodeByte
+  --------------------------
+  Take the next reply byte. Returns true and fills in Record when the 
+  last byte of a good reply arrives. Bytes past the end of a reply are 
+  ignored until the next JSRDecodeStart.
+*/
+bool JSRDecodeByte(JSRDecoder_t *Decoder, unsigned char Byte, 
+                   JSRRecord_t *Record)
+{
+   unsigned char ByteNum = Decoder->ByteNum;
+   
+   if(ByteNum >= REPLY_BYTES)
+      return false;
+   Decoder->ByteNum++;
+   
+   switch(ByteNum)
+   {
+      case 0:
+         if(Byte != FRAME_BYTE_0)
+            Decoder->Valid = false;
+         return false;
+         
+      case 1:
+         if(Byte != FRAME_BYTE_1)
+            Decoder->Valid = false;
+         return false;
+         
+      case 2:
+         if(Decoder->Query == SCORE_QUERY)
+            Record->RedScore = Byte;
+         return false;
+         
+      default:
+         if(!Decoder->Valid)
+            return false;
+         if(Decoder->Query == STATUS_QUERY)
+         {
+            Record->Kind = JSR_STATUS_RECORD;
+            Record->Command = Byte & COMMAND_MASK;
+            Record->HeadStatus = Byte & HEAD_STATUS_BIT;
+            Record->ReloadStatus = Byte & Decoder->ReloadMask;
+         }
+         else
+         {
+            Record->Kind = JSR_SCORE_RECORD;
+            Record->DarkScore = Byte;
+         }
+         return true;
+   }
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
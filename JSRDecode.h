@@ -0,0 +1,43 @@
+/****************************************************************************
+ 
+  Header file for the JSR protocol decoder. No hardware access, bytes in
+  and decoded game state records out.
+
+*****************************************************************************/
+
+#ifndef JSRDecode_H
+#define JSRDecode_H
+
+#include "ES_Types.h"
+
+//Reply kinds
+#define JSR_STATUS_RECORD 0
+#define JSR_SCORE_RECORD 1
+
+//One decoded reply
+typedef struct
+{
+   unsigned char Kind;
+   unsigned char Command;
+   unsigned char HeadStatus;
+   unsigned char ReloadStatus;
+   unsigned char RedScore;
+   unsigned char DarkScore;
+} JSRRecord_t;
+
+//Decoder state for one reply
+typedef struct
+{
+   unsigned char Query;       //query byte that was sent
+   unsigned char ReloadMask;  //reload bit for our knight
+   unsigned char ByteNum;
+   bool Valid;
+} JSRDecoder_t;
+
+// Public Function Prototypes
+void JSRDecodeStart(JSRDecoder_t *Decoder, unsigned char Query, 
+                    unsigned char ReloadMask);
+bool JSRDecodeByte(JSRDecoder_t *Decoder, unsigned char Byte, 
+                   JSRRecord_t *Record);
+
+#endif /* JSRDecode_H */
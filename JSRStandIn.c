@@ -0,0 +1,180 @@
+/****************************************************************************
+ Module
+   JSRStandIn.c
+
+ Revision
+   1.0.1
+
+ Description
+   Stands in for the Joust Status Reporter so the round logic can be run
+   on the bench without the JSR box. Plays a scripted match timeline and
+   answers STATUS_QUERY and SCORE_QUERY a byte at a time the way the JSR 
+   slave does: the first byte of a reply is shifted out while the query
+   byte is still coming in, so it is always 0x00, then 0xFF, then the 
+   answer to the query.
+   
+   Build with JSR_STANDIN defined to have the SPI engine talk to this 
+   module instead of the SPI port.
+
+ Notes
+   SS must have been high for the JSR's 2ms between queries. A query that
+   comes too soon is answered with 0xFF bytes, as a JSR that has not 
+   reloaded its shift register would, so pacing bugs show up as bad 
+   replies.
+   The script runs in real time from the first query.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/26/14 10:20 PS      Running state gathered into Vars for snapshots
+ 04/17/14 14:20 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "JSRStandIn.h"
+#include "JSRcommand.h"
+
+#include <S12E128bits.h>    /* bit definitions for the E128 */
+
+/*----------------------------- Module Defines ----------------------------*/
+#define ONE_SEC 976
+#define SS_GAP 2        //ticks SS must be high between queries
+
+#define HEAD_BIT 0x80
+#define RELOAD_BITS (RED_RELOAD_STATUS | DARK_RELOAD_STATUS)
+
+//One step of the match script, in force from Second onwards
+typedef struct
+{
+   unsigned int Second;
+   unsigned char Status;
+   unsigned char RedScore;
+   unsigned char DarkScore;
+} StandInStep_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static const StandInStep_t *CurrentStep(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Full match: three rounds with recesses, sudden death and end. Both
+//knights may reload in the recesses, red is unhorsed in sudden death
+static const StandInStep_t Script[] = 
+{
+   {  0, WAIT,                      0, 0},
+   {  3, START_ROUND,               0, 0},
+   { 33, RECESS | RELOAD_BITS,      2, 1},
+   { 43, START_ROUND,               2, 1},
+   { 73, RECESS | RELOAD_BITS,      3, 3},
+   { 83, START_ROUND,               3, 3},
+   {113, SUDDEN_DEATH,              4, 4},
+   {125, SUDDEN_DEATH | HEAD_BIT,   4, 5},
+   {127, END | HEAD_BIT,            4, 5}
+};
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   bool Started;
+   unsigned int LastTime;
+   unsigned long Elapsed;
+   unsigned int ReleaseTime;
+   unsigned char Query;
+   unsigned char ByteNum;
+   bool TooSoon;
+} JSRStandInVars_t;
+
+static JSRStandInVars_t Vars = {false, 0, 0, 0, 0, 0, false};
+
+/*------------------------------ Module Code ------------------------------*/
+/* Function: JSRStandInSelect
+  -----------------------------
+  SS asserted. Check the gap since the last release.
+*/
+void JSRStandInSelect(void)
+{
+   unsigned int Now = ES_Timer_GetTime();
+   
+   if(!Vars.Started)
+   {
+      Vars.Started = true;
+      Vars.LastTime = Now;
+      Vars.ReleaseTime = Now - SS_GAP;
+   }
+   Vars.Elapsed += (unsigned int)(Now - Vars.LastTime);
+   Vars.LastTime = Now;
+   
+   Vars.TooSoon = (unsigned int)(Now - Vars.ReleaseTime) < SS_GAP;
+   Vars.ByteNum = 0;
+}
+
+/* Function: JSRStandInByte
+  ---------------------------
+  Exchange one byte: take the master's byte and return the one the JSR
+  would have shifted out at the same time.
+*/
+unsigned char JSRStandInByte(unsigned char Out)
+{
+   unsigned char Reply;
+   const StandInStep_t *Step = CurrentStep();
+   
+   if(Vars.ByteNum == 0)
+      Vars.Query = Out;
+   
+   if(Vars.TooSoon)
+      Reply = 0xFF;
+   else if(Vars.ByteNum == 0)
+      Reply = 0x00;
+   else if(Vars.ByteNum == 1)
+      Reply = 0xFF;
+   else if(Vars.Query == STATUS_QUERY)
+      Reply = (Vars.ByteNum == 2) ? 0x00 : Step->Status;
+   else if(Vars.Query == SCORE_QUERY)
+      Reply = (Vars.ByteNum == 2) ? Step->RedScore : Step->DarkScore;
+   else
+      Reply = 0x00;
+   
+   Vars.ByteNum++;
+   return Reply;
+}
+
+/* Function: JSRStandInRelease
+  ------------------------------
+  SS released.
+*/
+void JSRStandInRelease(void)
+{
+   Vars.ReleaseTime = ES_Timer_GetTime();
+}
+
+#ifdef SNAPSHOT
+/* Function: GetJSRStandInVars
+  -----------------------------
+  Where this module's running state lives, for Snapshot.c.
+*/
+StateBlock_t GetJSRStandInVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: CurrentStep
+  ------------------------
+  Last script step whose start time has passed.
+*/
+static const StandInStep_t *CurrentStep(void)
+{
+   unsigned int Seconds = (unsigned int)(Vars.Elapsed / ONE_SEC);
+   unsigned int n = 0;
+   
+   while(n + 1u < ARRAY_SIZE(Script) && Script[n + 1].Second <= Seconds)
+      n++;
+   return &Script[n];
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
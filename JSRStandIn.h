@@ -0,0 +1,22 @@
+/****************************************************************************
+ 
+  Header file for the scripted JSR stand-in. Only built into the SPI 
+  engine when JSR_STANDIN is defined.
+
+*****************************************************************************/
+
+#ifndef JSRStandIn_H
+#define JSRStandIn_H
+
+#include "ES_Types.h"
+#include "Snapshot.h"
+
+// Public Function Prototypes
+void JSRStandInSelect(void);
+unsigned char JSRStandInByte(unsigned char Out);
+void JSRStandInRelease(void);
+#ifdef SNAPSHOT
+StateBlock_t GetJSRStandInVars(void);
+#endif
+
+#endif /* JSRStandIn_H */
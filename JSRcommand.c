@@ -1,275 +1,395 @@
-/****************************************************************************
- Module
-   JSRcommand.c
-
- Revision
-   1.0.1
-
- Description
-   Handles the service for recieving commands (with SPI bus) from the
-   Joust Status Reported (JSR) as defined by project description and
-   provided by instructors 
-
- Notes
-
- History
- When           Who     What/Why
- -------------- ---     --------
- 02/19/14 17:05 AH       Edited file for use with project
- 10/21/13 19:38 jec      created to test 16 possible serves, we need a bunch
-                         of service test harnesses
- 08/05/13 20:33 jec      converted to test harness service
- 01/16/12 09:58 jec      began conversion from TemplateFSM.c
-****************************************************************************/
-/*----------------------------- Include Files -----------------------------*/
-/* include header files for the framework and this service
-*/
-#include "ES_Configure.h"
-#include "ES_Framework.h"
-#include "JSRcommand.h"
-#include "Bot.h"
-#include <hidef.h>
-#include <mc9s12e128.h>     /* derivative information for the E128 */
-#include <S12E128bits.h>    /* bit definitions for the E128 */
-#include <Bin_Const.h>
-#include <termio.h>
-#include "S12eVec.h"
-
-/*----------------------------- Module Defines ----------------------------*/
-// these times assume a 1.024mS/tick timing
-#define ONE_SEC 976
-#define HALF_SEC (ONE_SEC/2)
-#define TWO_SEC (ONE_SEC*2)
-#define FIVE_SEC (ONE_SEC*5)
-
-
-/*---------------------------- Module Functions ---------------------------*/
-static void InitSPI(void);
-static void InitVariables(void);
-/*---------------------------- Module Variables ---------------------------*/
-static uint8_t MyPriority;
-static unsigned char ByteInfo;
-static unsigned int ReloadStatus=0;
-static unsigned int RELOAD_STATUS = DARK_RELOAD_STATUS;
-static unsigned int HEAD_STATUS; 
-static bool DontChangeKnightFlag = false;
-
-static unsigned char HeadStatus;
-static unsigned char command1;
-static unsigned char command2;
-static unsigned char LastCommand1 = 0xFF;
-static unsigned char LastCommand2 = 0xFF;
-static unsigned char QueryCommand;
-static unsigned int i = 0;
-static unsigned int j = 0;
-static unsigned char readFrom = 4; // The default is for Query for status
-
-/*------------------------------ Module Code ------------------------------*/
-/****************************************************************************
- Function
-     InitJSRcommand
-
- Parameters
-     uint8_t : the priorty of this service
-
- Returns
-     bool, false if error in initialization, true otherwise
-
- Description
-     Saves away the priority, and does any 
-     other required initialization for this service
- Notes
-
- Author
-     J. Edward Carryer, 01/16/12, 10:00
-****************************************************************************/
-bool InitJSRcommand ( uint8_t Priority )
-{
-   ES_Event ThisEvent;
-
-   MyPriority = Priority;
-  
-   // post the initial transition event
-   DDRS |= BIT7HI; // To control SS line manually
-   RED_DARK_ADDRESS &= ~RED_DARK_PIN; // Set pin as input
-   RED_DARK_PORT &= ~RED_DARK_PIN; //Set button low
-   InitSPI();
-   readFrom = 4;// Looking for the 4th command from JSR
-   InitVariables();
-   QueryCommand =  STATUS_QUERY;
-   ES_Timer_InitTimer(JSRtimer, 3); // Start JSRtimer for 2ms.
- 
-   ThisEvent.EventType = ES_INIT;
-   if (ES_PostToService( MyPriority, ThisEvent) == true)
-      return true;
-   else
-      return false;
-}
-/****************************************************************************
- Function
-     PostJSRcommand
-
- Parameters
-     EF_Event ThisEvent ,the event to post to the queue
-
- Returns
-     bool false if the Enqueue operation failed, true otherwise
-
- Description
-     Posts an event to this state machine's queue
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:25
-****************************************************************************/
-bool PostJSRcommand( ES_Event ThisEvent )
-{
-  return ES_PostToService( MyPriority, ThisEvent);
-}
-
-/****************************************************************************
- Function
-    RunJSRcommand
-
- Parameters
-   ES_Event : the event to process
-
- Returns
-   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
-
- Description
-   Code for receiving and parsing message received through SPI bus from JSR
-
- Notes
-   
- Author
-   A. Han,            02/20/14, 17:30
-   J. Edward Carryer, 01/15/12, 15:23
-****************************************************************************/
-ES_Event RunJSRcommand( ES_Event ThisEvent )
-{
-   static unsigned char dummy;
-   ES_Event ReturnEvent;
-   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-  
-  
-   if (RED_DARK_PORT&RED_DARK_PIN == RED_DARK_PIN) //Hi
-   {
-      RELOAD_STATUS = RED_RELOAD_STATUS;  //RED KNIGHT
-      DontChangeKnightFlag = true;
-   }
-   else if (DontChangeKnightFlag == false)
-   {
-      RELOAD_STATUS = DARK_RELOAD_STATUS; //DARK KNIGHT
-   }	
-  
-   switch (ThisEvent.EventType)
-   {
-      case QUERY4STATUS:
-         readFrom = 4;// Looking for the 4th command from JSR
-         InitVariables();
-         QueryCommand =  STATUS_QUERY;
-         break;
-    
-      case QUERY4SCORE :
-         readFrom = 3;// Looking for the 3rd and 4th command from JSR
-         InitVariables();
-         QueryCommand =  SCORE_QUERY;
-         break;
-        
-      case ES_TIMEOUT :  // re-start timer & announce
-         if ((SPISR & _S12_SPTEF) == _S12_SPTEF)  //if query can be sent
-    		{
-    			i++;
-    			if (i==1)
-    			{ 
-    			   PTS &= BIT7LO;  // Set SS line low to recieve 4 bytes
-    			   SPIDR = QueryCommand; //Send Status Query
-    			} else
-    			{
-    			  	SPIDR = 0x00;
-    			}
-    		} 
-         break;
-    
-      case FLAGSET:
-         if ((SPISR & _S12_SPIF) == _S12_SPIF) //If Data can be received
-        	{
-            ByteInfo = SPIDR;
-        		dummy = (BIT0HI|BIT1HI|BIT2HI)&(ByteInfo) ;  //Reading Bit 0,1,2
-        		 
-            if (i<readFrom)
-            {
-               dummy = SPIDR;
-        		}
-        		else if (i == readFrom)
-        		{
-               HeadStatus = ByteInfo & HEAD_STATUS;
-               ReloadStatus = ByteInfo & RELOAD_STATUS;
-               command1 = dummy;//SPIDR;
-               if (command1 != LastCommand1)
-               {
-                  ES_Event ThisEvent;
-                  LastCommand1 = command1;
-                  
-                  ThisEvent.EventType = NEW_COMMAND_RECEIVED;
-                  ThisEvent.EventParam = command1;
-                  PostBot(ThisEvent);
-               }
-            }
-            else if (i > readFrom)
-            {
-               command2 = dummy;//SPIDR;
-               if (command2 != LastCommand2)
-               {
-                  ES_Event ThisEvent;
-                  LastCommand2 = command2;
-                  
-                  ThisEvent.EventType = NEW_COMMAND_RECEIVED;
-                  ThisEvent.EventParam = command2;
-                  PostBot(ThisEvent);
-               }
-            }
-        		 
-            if(ES_Timer_InitTimer(JSRtimer, 3)==ES_Timer_OK)// Start JSRtimer 3ms
-        		if (i==4)
-            {  
-               // Set SS line high after receiving 4 bytes
-               i=0;
-               PTS |= BIT7HI;
-            }
-         }
-         break;
-   }
-   return ReturnEvent;
-}
-
-/***************************************************************************
- private functions
- ***************************************************************************/
-static void InitSPI(void) {
-   //Enable SPI, as Master, even rising edges, manual control for SS line 
-   SPICR1 = (_S12_SPE | _S12_MSTR | _S12_CPHA | _S12_CPOL); // | _S12_SSOE);   
-   SPICR2 &= (~_S12_MODFEN);  //Setting for manual control for SS line
-    //Set baud rate smaller than 1.43 MHz.
-   SPIBR = (_S12_SPPR2 |_S12_SPPR1 | _S12_SPPR0 | _S12_SPR1 |_S12_SPR0); 
-}
-
-static void InitVariables(void)
-{
-    i = 0;
-    j = 0;
-    LastCommand1 = 0xFF;
-    LastCommand2 = 0xFF;
-}
-    
-    
-unsigned int GetReloadStatus(void)
-{
-   printf("ReloadStatus = %u\n\r", ReloadStatus);
-   return ReloadStatus;
-}
-
-/*------------------------------- Footnotes -------------------------------*/
-/*------------------------------ End of file ------------------------------*/
-
+/****************************************************************************
+ Module
+   JSRcommand.c
+
+ Revision
+   1.0.1
+
+ Description
+   Handles the service for recieving commands (with SPI bus) from the
+   Joust Status Reported (JSR) as defined by project description and
+   provided by instructors 
+   Each query is one SPI transaction run by the SPI engine. JSRtimer only
+   spaces the transactions out.
+   Status and score queries are interleaved and the replies kept in a game
+   state snapshot that other services read with GetJSRSnapshot, polling
+   its Version for changes. Only a new command is posted, to Bot.
+
+ Notes
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 05/01/14 11:00 PS       A command announced again is posted but does
+                         not resync the clock or brake again
+ 04/28/14 09:40 PS       Only new commands posted, head/reload/score changes
+                         just bump the snapshot version
+ 04/26/14 10:20 PS       Running state gathered into Vars for snapshots
+ 04/22/14 14:20 PS       Command edges restart the match clock
+ 04/16/14 09:45 PS       Reply parsing moved to JSRDecode, fixed precedence
+                         of the red/dark switch test
+ 04/15/14 10:30 PS       Interleaved status/score polling into a snapshot
+ 04/14/14 13:40 PS       Whole queries through the interrupt driven SPI engine
+ 02/19/14 17:05 AH       Edited file for use with project
+ 10/21/13 19:38 jec      created to test 16 possible serves, we need a bunch
+                         of service test harnesses
+ 08/05/13 20:33 jec      converted to test harness service
+ 01/16/12 09:58 jec      began conversion from TemplateFSM.c
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+/* include header files for the framework and this service
+*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "JSRcommand.h"
+#include "Fault.h"
+#include "Bot.h"
+#include "DCMotor.h"
+#include "SPIEngine.h"
+#include "JSRDecode.h"
+#include "MatchClock.h"
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */
+#include <Bin_Const.h>
+#include <termio.h>
+#include "S12eVec.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// these times assume a 1.024mS/tick timing
+#define ONE_SEC 976
+#define HALF_SEC (ONE_SEC/2)
+#define TWO_SEC (ONE_SEC*2)
+#define FIVE_SEC (ONE_SEC*5)
+
+//JSR wants SS high for at least 2ms between queries
+#define QUERY_GAP 3
+
+//Every query clocks back 4 bytes, see JSRDecode.c
+#define QUERY_BYTES 4
+
+//Every SCORE_EVERY-th query is a score query, the rest are status
+#define SCORE_EVERY 4
+
+/*---------------------------- Module Functions ---------------------------*/
+static void InitVariables(void);
+static void StartQuery(void);
+static void DecodeReply(void);
+static void UpdateStatus(const JSRRecord_t *Record);
+static void UpdateScore(const JSRRecord_t *Record);
+static void CommandChanged(unsigned char Command);
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   unsigned int RELOAD_STATUS;
+   bool DontChangeKnightFlag;
+   unsigned char QueryCommand;
+   unsigned char QueryCount;
+   unsigned char ClockCommand;          //last command the clock was synced to
+   JSRSnapshot_t Snapshot;
+   JSRDecoder_t Decoder;
+   unsigned char QueryTx[QUERY_BYTES];  //SPI buffers of the query in progress
+   unsigned char QueryRx[QUERY_BYTES];
+} JSRcommandVars_t;
+
+static JSRcommandVars_t Vars = 
+{
+   DARK_RELOAD_STATUS, false, 0, 0, NOTHING, {0, 0, NOTHING, 0, 0, 0, 0}, {0}, 
+   {STATUS_QUERY, 0x00, 0x00, 0x00}, {0}
+};
+
+//SPI transaction for the query in progress
+static const SPITransaction_t Query = 
+   {Vars.QueryTx, Vars.QueryRx, QUERY_BYTES, PostJSRcommand};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitJSRcommand
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, and does any 
+     other required initialization for this service
+ Notes
+
+ Author
+     J. Edward Carryer, 01/16/12, 10:00
+****************************************************************************/
+bool InitJSRcommand ( uint8_t Priority )
+{
+   ES_Event ThisEvent;
+
+   MyPriority = Priority;
+  
+   // post the initial transition event
+   RED_DARK_ADDRESS &= ~RED_DARK_PIN; // Set pin as input
+   RED_DARK_PORT &= ~RED_DARK_PIN; //Set button low
+   InitSPIEngine();
+   InitVariables();
+   Vars.ClockCommand = NOTHING;
+   Vars.QueryCommand =  STATUS_QUERY;
+   ES_Timer_InitTimer(JSRtimer, QUERY_GAP); // Start JSRtimer for 2ms.
+ 
+   ThisEvent.EventType = ES_INIT;
+   if (ES_PostToService( MyPriority, ThisEvent) == true)
+      return true;
+   else
+      return false;
+}
+/****************************************************************************
+ Function
+     PostJSRcommand
+
+ Parameters
+     EF_Event ThisEvent ,the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to this state machine's queue
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:25
+****************************************************************************/
+bool PostJSRcommand( ES_Event ThisEvent )
+{
+  FAULT_POST(ThisEvent);
+  return ES_PostToService( MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunJSRcommand
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   Code for receiving and parsing message received through SPI bus from JSR
+
+ Notes
+   
+ Author
+   A. Han,            02/20/14, 17:30
+   J. Edward Carryer, 01/15/12, 15:23
+****************************************************************************/
+ES_Event RunJSRcommand( ES_Event ThisEvent )
+{
+   ES_Event ReturnEvent;
+   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+  
+  
+   if ((RED_DARK_PORT & RED_DARK_PIN) == RED_DARK_PIN) //Hi
+   {
+      Vars.RELOAD_STATUS = RED_RELOAD_STATUS;  //RED KNIGHT
+      Vars.DontChangeKnightFlag = true;
+   }
+   else if (Vars.DontChangeKnightFlag == false)
+   {
+      Vars.RELOAD_STATUS = DARK_RELOAD_STATUS; //DARK KNIGHT
+   }	
+  
+   switch (ThisEvent.EventType)
+   {
+      case QUERY4STATUS: // Status next, and announce the command again
+         InitVariables();
+         Vars.QueryCommand =  STATUS_QUERY;
+         break;
+    
+      case QUERY4SCORE : // Score next
+         Vars.QueryCommand =  SCORE_QUERY;
+         break;
+        
+      case ES_TIMEOUT :  // SS has been high long enough, next query
+         StartQuery();
+         break;
+    
+      case SPIDone:
+         //Stamp first, the match clock syncs to it while decoding
+         Vars.Snapshot.Time = ES_Timer_GetTime();
+         DecodeReply();
+         
+         //Interleave score queries with the status queries
+         Vars.QueryCount++;
+         if (Vars.QueryCount >= SCORE_EVERY)
+         {
+            Vars.QueryCount = 0;
+            Vars.QueryCommand = SCORE_QUERY;
+         }
+         else
+         {
+            Vars.QueryCommand = STATUS_QUERY;
+         }
+         ES_Timer_InitTimer(JSRtimer, QUERY_GAP);
+         break;
+   }
+   return ReturnEvent;
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetJSRcommandVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetJSRcommandVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+static void InitVariables(void)
+{
+    Vars.Snapshot.Command = NOTHING;
+    Vars.Snapshot.Version++;
+}
+
+/* Function: StartQuery
+  -----------------------
+  Send the current query to the JSR as one 4 byte transaction. If the SPI
+  engine is still busy try again after another gap.
+*/
+static void StartQuery(void)
+{
+   Vars.QueryTx[0] = Vars.QueryCommand;
+   if (!StartSPITransaction(&Query))
+      ES_Timer_InitTimer(JSRtimer, QUERY_GAP);
+}
+
+/* Function: DecodeReply
+  ------------------------
+  Run the reply bytes through the decoder and apply the record.
+*/
+static void DecodeReply(void)
+{
+   JSRRecord_t Record;
+   unsigned char n;
+   
+   JSRDecodeStart(&Vars.Decoder, Vars.QueryTx[0], Vars.RELOAD_STATUS);
+   for (n = 0; n < QUERY_BYTES; n++)
+   {
+      if (JSRDecodeByte(&Vars.Decoder, Vars.QueryRx[n], &Record))
+      {
+         if (Record.Kind == JSR_STATUS_RECORD)
+            UpdateStatus(&Record);
+         else
+            UpdateScore(&Record);
+      }
+   }
+}
+
+/* Function: UpdateStatus
+  -------------------------
+  Update command, head and reload status from a status record. A new 
+  command goes to Bot, other changes only bump the snapshot version. A 
+  command announced again after QUERY4STATUS goes to Bot again, but only
+  a real change of command syncs the match clock or brakes on END.
+*/
+static void UpdateStatus(const JSRRecord_t *Record)
+{
+   unsigned char Command = Record->Command;
+   unsigned char Head = Record->HeadStatus;
+   unsigned char Reload = Record->ReloadStatus;
+   
+   if (Command != Vars.Snapshot.Command)
+   {
+      Vars.Snapshot.Command = Command;
+      if (Command != Vars.ClockCommand)
+      {
+         Vars.ClockCommand = Command;
+         if (Command == END)
+            brakeMotorNow(); // Don't wait for Bot to stop wheels
+         SyncMatchClock(Command, Vars.Snapshot.Time);
+      }
+      CommandChanged(Command);
+   }
+   if (Head != Vars.Snapshot.HeadStatus)
+   {
+      Vars.Snapshot.HeadStatus = Head;
+      Vars.Snapshot.Version++;
+   }
+   if (Reload != Vars.Snapshot.ReloadStatus)
+   {
+      Vars.Snapshot.ReloadStatus = Reload;
+      Vars.Snapshot.Version++;
+   }
+}
+
+/* Function: UpdateScore
+  ------------------------
+  Update both scores from a score record.
+*/
+static void UpdateScore(const JSRRecord_t *Record)
+{
+   unsigned char Red = Record->RedScore;
+   unsigned char Dark = Record->DarkScore;
+   
+   if (Red != Vars.Snapshot.RedScore || Dark != Vars.Snapshot.DarkScore)
+   {
+      Vars.Snapshot.RedScore = Red;
+      Vars.Snapshot.DarkScore = Dark;
+      Vars.Snapshot.Version++;
+   }
+}
+
+/* Function: CommandChanged
+  ---------------------------
+  Bump the snapshot version and hand the new command to Bot.
+*/
+static void CommandChanged(unsigned char Command)
+{
+   ES_Event ThisEvent;
+   
+   Vars.Snapshot.Version++;
+   ThisEvent.EventType = NEW_COMMAND_RECEIVED;
+   ThisEvent.EventParam = Command;
+   PostBot(ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    GetJSRSnapshot
+
+ Returns
+   Pointer to the latest game state read from the JSR
+
+ Description
+   No SPI traffic, just the state as of the last reply. Version changes
+   whenever any field changes, Time is when the last reply arrived.
+****************************************************************************/
+const JSRSnapshot_t *GetJSRSnapshot(void)
+{
+   return &Vars.Snapshot;
+}
+
+unsigned int GetReloadStatus(void)
+{
+   return Vars.Snapshot.ReloadStatus;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
+
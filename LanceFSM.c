@@ -1,179 +1,212 @@
-/****************************************************************************
- Module
-   LanceFSM.c
-
- Revision
-   1.0.1
-
- Description
-   This is a file for implementing flat state machine for deploying a
-	lance for the Winter 2014 ME218B Project. Lance is allowed to be 
-   extended for a total of 3 seconds before being retracted. Additionally
-   it must wait 1 second before being extended again
-
- Notes
-
- History
- When           Who     What/Why
- -------------- ---     --------
- 03/10/14 20:30 PS       Edited file for use with Lance state machine
- 01/15/12 11:12 jec      revisions for Gen2 framework
- 11/07/11 11:26 jec      made the queue static
- 10/30/11 17:59 jec      fixed references to CurrentEvent in RunTemplateSM()
- 10/23/11 18:20 jec      began conversion from SMTemplate.c (02/20/07 rev)
-****************************************************************************/
-/*----------------------------- Include Files -----------------------------*/
-#include "ES_Configure.h"
-#include "ES_Framework.h"
-#include "ES_DeferRecall.h"
-#include "LanceFSM.h"
-#include "Servos.h"
-
-#include <stdio.h>
-#include <hidef.h>
-#include <mc9s12e128.h>     /* derivative information for the E128 */
-#include <S12E128bits.h>    /* bit definitions for the E128 */ 
-#include <Bin_Const.h>
-#include <termio.h>
-#include "S12eVec.h"
-
-/*----------------------------- Module Defines ----------------------------*/
-#define LANCE_SERVO 2
-#define DEPLOY_WIDTH 900
-#define RETRACT_WIDTH 1600
-
-#define ONE_SEC 976
-/*---------------------------- Module Functions ---------------------------*/
-
-/*---------------------------- Module Variables ---------------------------*/
-static LanceState_t CurrentState;
-static uint8_t MyPriority;
-
-/*------------------------------ Module Code ------------------------------*/
-/****************************************************************************
- Function
-     InitLance
-
- Parameters
-     uint8_t : the priorty of this service
-
- Returns
-     bool, false if error in initialization, true otherwise
-
- Description
-     Saves away the priority, sets up the initial transition and does any
-     other required initialization for this state machine
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 18:55
-****************************************************************************/
-bool InitLance ( uint8_t Priority )
-{
-   ES_Event ThisEvent;
-  
-   MyPriority = Priority;
-   //Put lance state machine into the Initial PseudoState
-   CurrentState = Retracted;
- 
-   return true; 
-}
-
-/****************************************************************************
- Function
-     PostLance
-
- Parameters
-     EF_Event ThisEvent , the event to post to the queue
-
- Returns
-     boolean False if the Enqueue operation failed, True otherwise
-
- Description
-     Posts an event to this state machine's queue
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:25
-****************************************************************************/
-bool PostLance( ES_Event ThisEvent )
-{
-   return ES_PostToService( MyPriority, ThisEvent);
-}
-
-/****************************************************************************
- Function
-    RunLance
-
- Parameters
-   ES_Event : the event to process
-
- Returns
-   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
-
- Description
-   When a deploy lance event is recieved, the robot uses a servo to extend
-   the lance and a timer is used to wait the 3 seconds to retract lance
-   and 1 second wait until the lance is able to be extended again.
-
- Author 
-   P. Sherman,        03/10/14, 20:40  
-   J. Edward Carryer, 01/15/12, 15:23
-****************************************************************************/
-ES_Event RunLance( ES_Event ThisEvent )
-{
-   ES_Event ReturnEvent;
-   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
- 
-   //Deploy Lance if event is posted and lance is in valid state 
-   if(ThisEvent.EventType == Deploy_Lance && CurrentState == Retracted)
-   {
-      SetServo(LANCE_SERVO, DEPLOY_WIDTH);
-	   ES_Timer_InitTimer(Lance_Timer, 3*ONE_SEC);
-	   CurrentState = Deployed;
-    
-   } 
-
-   //Timeout Event recieved
-   else if(ThisEvent.EventType == ES_TIMEOUT)
-   {
-      if(CurrentState == Deployed)
-      {
-         SetServo(LANCE_SERVO, RETRACT_WIDTH);
-         ES_Timer_InitTimer(Lance_Timer, ONE_SEC);
-         CurrentState = Inactive;
-	   } else if (CurrentState == Inactive)
-      {
-         CurrentState = Retracted;
-      }
-   }
-
-   return ReturnEvent;
-}
-
-/****************************************************************************
- Function
-     QueryLance
-
- Parameters
-     None
-
- Returns
-     TemplateState_t The current state of the Template state machine
-
- Description
-     returns the current state of the Template state machine
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:21
-****************************************************************************/
-LanceState_t QueryLance ( void )
-{
-   return(CurrentState);
-}
-
-/***************************************************************************
- private functions
- ***************************************************************************/
-
+/****************************************************************************
+ Module
+   LanceFSM.c
+
+ Revision
+   1.0.1
+
+ Description
+   This is a file for implementing flat state machine for deploying a
+	lance for the Winter 2014 ME218B Project. Lance is allowed to be 
+   extended for a total of 3 seconds before being retracted. Additionally
+   it must wait 1 second before being extended again
+
+ Notes
+   The whole deploy, hold, retract, rest cycle is the LanceThread 
+   protothread.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/28/14 10:10 PS       Back to Retracted as soon as the rest time is up
+ 04/26/14 10:20 PS       Running state gathered into Vars for snapshots
+ 04/23/14 11:30 PS       Deploy/retract written as one protothread
+ 04/18/14 16:10 PS       Expressed as a transition table for the FSM engine
+ 03/10/14 20:30 PS       Edited file for use with Lance state machine
+ 01/15/12 11:12 jec      revisions for Gen2 framework
+ 11/07/11 11:26 jec      made the queue static
+ 10/30/11 17:59 jec      fixed references to CurrentEvent in RunTemplateSM()
+ 10/23/11 18:20 jec      began conversion from SMTemplate.c (02/20/07 rev)
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_DeferRecall.h"
+#include "LanceFSM.h"
+#include "Fault.h"
+#include "Protothread.h"
+#include "Servos.h"
+
+#include <stdio.h>
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */ 
+#include <Bin_Const.h>
+#include <termio.h>
+#include "S12eVec.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define LANCE_SERVO 2
+#define DEPLOY_WIDTH 900
+#define RETRACT_WIDTH 1600
+
+#define ONE_SEC 976
+#define DEPLOY_TIME (3*ONE_SEC)
+#define REST_TIME ONE_SEC
+/*---------------------------- Module Functions ---------------------------*/
+static bool LanceThread(ES_Event ThisEvent);
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   PT_t LancePT;
+   LanceState_t LanceState;
+} LanceVars_t;
+
+static LanceVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitLance
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, sets up the initial transition and does any
+     other required initialization for this state machine
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 18:55
+****************************************************************************/
+bool InitLance ( uint8_t Priority )
+{
+   MyPriority = Priority;
+   Vars.LanceState = Retracted;
+   PT_INIT(&Vars.LancePT);
+   return true;
+}
+
+/****************************************************************************
+ Function
+     PostLance
+
+ Parameters
+     EF_Event ThisEvent , the event to post to the queue
+
+ Returns
+     boolean False if the Enqueue operation failed, True otherwise
+
+ Description
+     Posts an event to this state machine's queue
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:25
+****************************************************************************/
+bool PostLance( ES_Event ThisEvent )
+{
+   FAULT_POST(ThisEvent);
+   return ES_PostToService( MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunLance
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   When a deploy lance event is recieved, the robot uses a servo to extend
+   the lance and a timer is used to wait the 3 seconds to retract lance
+   and 1 second wait until the lance is able to be extended again.
+
+ Author 
+   P. Sherman,        03/10/14, 20:40  
+   J. Edward Carryer, 01/15/12, 15:23
+****************************************************************************/
+ES_Event RunLance( ES_Event ThisEvent )
+{
+   ES_Event ReturnEvent;
+   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+ 
+   LanceThread(ThisEvent);
+   return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+     QueryLance
+
+ Parameters
+     None
+
+ Returns
+     TemplateState_t The current state of the Template state machine
+
+ Description
+     returns the current state of the Template state machine
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:21
+****************************************************************************/
+LanceState_t QueryLance ( void )
+{
+   return(Vars.LanceState);
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetLanceVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetLanceVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Function: LanceThread
+  -------------------------
+  Extend the lance for its 3 seconds, pull it back and wait 1 second
+  before it may go out again.
+*/
+static bool LanceThread(ES_Event ThisEvent)
+{
+   PT_BEGIN(&Vars.LancePT);
+   Vars.LanceState = Retracted;
+   PT_AWAIT_EVENT(&Vars.LancePT, ThisEvent, Deploy_Lance);
+   
+   SetServo(LANCE_SERVO, DEPLOY_WIDTH);
+   Vars.LanceState = Deployed;
+   PT_AWAIT_TIME(&Vars.LancePT, ThisEvent, Lance_Timer, DEPLOY_TIME);
+   
+   SetServo(LANCE_SERVO, RETRACT_WIDTH);
+   Vars.LanceState = Inactive;
+   PT_AWAIT_TIME(&Vars.LancePT, ThisEvent, Lance_Timer, REST_TIME);
+   Vars.LanceState = Retracted;
+   PT_END(&Vars.LancePT);
+}
@@ -0,0 +1,366 @@
+/****************************************************************************
+ Module
+   MatchClock.c
+
+ Revision
+   1.0.1
+
+ Description
+   Keeps the time left in the current round or recess. The clock is
+   restarted on every START_ROUND, SUDDEN_DEATH and RECESS edge from the
+   JSR, and stopped on WAIT and END.
+   Other services can ask for an event to be posted to them a given time
+   before the end of the phase ("home by T-5s"), and can check whether an
+   action of known length still fits before then, so nothing is started
+   that can not be finished.
+
+ Notes
+   Deadlines belong to the phase they were set in and are dropped at the
+   next edge. MatchClock_Timer is always armed for the next deadline due.
+   With the clock stopped there is no end to fit before, so everything 
+   fits and nothing can be scheduled.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/28/14 10:00 PS      Recess is the 10s minimum, time left documented as
+                        an upper bound
+ 04/26/14 10:20 PS      Running state gathered into Vars for snapshots
+ 04/22/14 14:20 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "MatchClock.h"
+#include "Fault.h"
+#include "JSRcommand.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// these times assume a 1.024mS/tick timing
+#define ONE_SEC 976
+
+//Phase lengths. A round lasts at most 30s (it ends early once a knight
+//gets home) and puts the old 25s stop moving time at T-5s. A recess lasts
+//at least 10s, so its end is the earliest the next round can start
+#define ROUND_LENGTH (30*ONE_SEC)
+#define RECESS_LENGTH (10*ONE_SEC)
+
+#define MAX_DEADLINES 4
+
+typedef struct
+{
+   pPostFunc Post;        //0 for a free slot
+   ES_Event Event;
+   unsigned int Before;   //ticks before the end of the phase
+} Deadline_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void PostDueDeadlines(void);
+static void ArmTimer(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   unsigned char Phase;
+   unsigned int PhaseStart;
+   unsigned int PhaseLength;
+   Deadline_t Deadlines[MAX_DEADLINES];
+} MatchClockVars_t;
+
+static MatchClockVars_t Vars = {MATCH_IDLE};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitMatchClock
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, the clock starts stopped
+****************************************************************************/
+bool InitMatchClock ( uint8_t Priority )
+{
+   ES_Event ThisEvent;
+
+   MyPriority = Priority;
+   Vars.Phase = MATCH_IDLE;
+   CancelDeadlines(0);
+   
+   // post the initial transition event
+   ThisEvent.EventType = ES_INIT;
+   if (ES_PostToService( MyPriority, ThisEvent) == true)
+      return true;
+   else
+      return false;
+}
+
+/****************************************************************************
+ Function
+     PostMatchClock
+
+ Parameters
+     EF_Event ThisEvent ,the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to this state machine's queue
+****************************************************************************/
+bool PostMatchClock( ES_Event ThisEvent )
+{
+   FAULT_POST(ThisEvent);
+   return ES_PostToService( MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunMatchClock
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   MatchClock_Timer has run out: post the deadlines now due and arm the 
+   timer for the next one.
+****************************************************************************/
+ES_Event RunMatchClock( ES_Event ThisEvent )
+{
+   ES_Event ReturnEvent;
+   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+   
+   if (ThisEvent.EventType == ES_TIMEOUT && 
+       ThisEvent.EventParam == MatchClock_Timer)
+   {
+      PostDueDeadlines();
+      ArmTimer();
+   }
+   return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+   SyncMatchClock
+
+ Parameters
+   unsigned char : new JSR command
+   unsigned int : ES timer time the command was read
+
+ Description
+   Restart the clock on a round or recess edge, stop it otherwise. Called
+   before the command is passed on, so deadlines set on the new phase are
+   not dropped.
+****************************************************************************/
+void SyncMatchClock(unsigned char Command, unsigned int When)
+{
+   CancelDeadlines(0);
+   Vars.PhaseStart = When;
+   
+   if (Command == START_ROUND || Command == SUDDEN_DEATH)
+   {
+      Vars.Phase = MATCH_ROUND;
+      Vars.PhaseLength = ROUND_LENGTH;
+   }
+   else if (Command == RECESS)
+   {
+      Vars.Phase = MATCH_RECESS;
+      Vars.PhaseLength = RECESS_LENGTH;
+   }
+   else
+   {
+      Vars.Phase = MATCH_IDLE;
+   }
+}
+
+/****************************************************************************
+ Function
+   GetMatchPhase
+
+ Returns
+   MATCH_IDLE, MATCH_ROUND or MATCH_RECESS
+****************************************************************************/
+unsigned char GetMatchPhase(void)
+{
+   return Vars.Phase;
+}
+
+/****************************************************************************
+ Function
+   GetTimeRemaining
+
+ Returns
+   Timer ticks left in the current phase, 0 with the clock stopped.
+
+ Notes
+   In a round this is an upper bound: the JSR ends the round early when a
+   knight reaches home, so callers must still handle the WAIT/END edge 
+   arriving before their deadline. In a recess it counts down to the 
+   earliest the next round can start.
+****************************************************************************/
+unsigned int GetTimeRemaining(void)
+{
+   unsigned int Elapsed = ES_Timer_GetTime() - Vars.PhaseStart;
+   
+   if (Vars.Phase == MATCH_IDLE || Elapsed >= Vars.PhaseLength)
+      return 0;
+   return Vars.PhaseLength - Elapsed;
+}
+
+/****************************************************************************
+ Function
+   FitsBeforeEnd
+
+ Parameters
+   unsigned int : length of the action (ticks)
+   unsigned int : how long before the end of the phase it must be done
+
+ Returns
+   bool, true if the action started now would be done in time
+****************************************************************************/
+bool FitsBeforeEnd(unsigned int Duration, unsigned int Before)
+{
+   unsigned int Remaining = GetTimeRemaining();
+   
+   if (Vars.Phase == MATCH_IDLE)
+      return true;
+   return Remaining > Before && Duration <= Remaining - Before;
+}
+
+/****************************************************************************
+ Function
+   ScheduleBeforeEnd
+
+ Parameters
+   unsigned int : ticks before the end of the phase
+   pPostFunc : where to post
+   ES_Event : what to post
+
+ Returns
+   bool, false with the clock stopped or no free slot
+
+ Description
+   Post Event at T-Before in this phase, at once if that has passed.
+****************************************************************************/
+bool ScheduleBeforeEnd(unsigned int Before, pPostFunc Post, ES_Event Event)
+{
+   unsigned char i;
+   
+   if (Vars.Phase == MATCH_IDLE)
+      return false;
+   
+   for (i = 0; i < MAX_DEADLINES; i++)
+   {
+      if (Vars.Deadlines[i].Post == 0)
+      {
+         Vars.Deadlines[i].Post = Post;
+         Vars.Deadlines[i].Event = Event;
+         Vars.Deadlines[i].Before = Before;
+         PostDueDeadlines();
+         ArmTimer();
+         return true;
+      }
+   }
+   return false;
+}
+
+/****************************************************************************
+ Function
+   CancelDeadlines
+
+ Parameters
+   pPostFunc : requester to cancel for, 0 for all
+****************************************************************************/
+void CancelDeadlines(pPostFunc Post)
+{
+   unsigned char i;
+   
+   for (i = 0; i < MAX_DEADLINES; i++)
+   {
+      if (Post == 0 || Vars.Deadlines[i].Post == Post)
+         Vars.Deadlines[i].Post = 0;
+   }
+   ArmTimer();
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetMatchClockVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetMatchClockVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Function: PostDueDeadlines
+  -----------------------------
+  Post and free every deadline whose time has come.
+*/
+static void PostDueDeadlines(void)
+{
+   unsigned int Remaining = GetTimeRemaining();
+   pPostFunc Post;
+   unsigned char i;
+   
+   for (i = 0; i < MAX_DEADLINES; i++)
+   {
+      Post = Vars.Deadlines[i].Post;
+      if (Post != 0 && Remaining <= Vars.Deadlines[i].Before)
+      {
+         Vars.Deadlines[i].Post = 0;
+         Post(Vars.Deadlines[i].Event);
+      }
+   }
+}
+
+/* Function: ArmTimer
+  ---------------------
+  Run MatchClock_Timer to the next deadline, stop it if there is none.
+*/
+static void ArmTimer(void)
+{
+   unsigned int Remaining = GetTimeRemaining();
+   unsigned int Next = 0;
+   bool Pending = false;
+   unsigned char i;
+   
+   for (i = 0; i < MAX_DEADLINES; i++)
+   {
+      if (Vars.Deadlines[i].Post != 0 && 
+          (!Pending || Vars.Deadlines[i].Before > Next))
+      {
+         Next = Vars.Deadlines[i].Before;
+         Pending = true;
+      }
+   }
+   
+   if (Pending && Vars.Phase != MATCH_IDLE)
+      ES_Timer_InitTimer(MatchClock_Timer, 
+                         Remaining > Next ? Remaining - Next : 1);
+   else
+      ES_Timer_StopTimer(MatchClock_Timer);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,35 @@
+/****************************************************************************
+ 
+  Header file for the match clock service
+  based on the Gen2 Events and Services Framework
+
+*****************************************************************************/
+
+#ifndef MatchClock_H
+#define MatchClock_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "Snapshot.h"
+#include "ES_Events.h"
+
+//Match phases
+#define MATCH_IDLE 0
+#define MATCH_ROUND 1
+#define MATCH_RECESS 2
+
+// Public Function Prototypes
+bool InitMatchClock ( uint8_t Priority );
+bool PostMatchClock( ES_Event ThisEvent );
+ES_Event RunMatchClock( ES_Event ThisEvent );
+void SyncMatchClock(unsigned char Command, unsigned int When);
+unsigned char GetMatchPhase(void);
+unsigned int GetTimeRemaining(void);
+bool FitsBeforeEnd(unsigned int Duration, unsigned int Before);
+bool ScheduleBeforeEnd(unsigned int Before, pPostFunc Post, ES_Event Event);
+void CancelDeadlines(pPostFunc Post);
+#ifdef SNAPSHOT
+StateBlock_t GetMatchClockVars(void);
+#endif
+
+#endif /* MatchClock_H */
@@ -1,317 +1,459 @@
-/****************************************************************************
- Module
-   Orientation.c
-
- Revision
-   1.0.1
-
- Description
-  The game board for the project is mostly white but includes a line of
-  red tape at the mid line and green tape on either side to designate the 
-  home sections. A simple tape sensor is used to examine the color on the ground
-  as the robot moves. 
-
- History
- When           Who     What/Why
- -------------- ---     --------
- 03/10/15 12:10 PS, AH   Changed file for use in project
- 10/21/13 19:38 jec      created to test 16 possible serves, we need a bunch
-                         of service test harnesses
- 08/05/13 20:33 jec      converted to test harness service
- 01/16/12 09:58 jec      began conversion from TemplateFSM.c
-****************************************************************************/
-/*----------------------------- Include Files -----------------------------*/
-#include "ES_Configure.h"
-#include "ES_Framework.h"
-#include "JSRcommand.h"
-#include <hidef.h>
-#include <mc9s12e128.h>     /* derivative information for the E128 */
-#include <S12E128bits.h>    /* bit definitions for the E128 */
-#include <Bin_Const.h>
-#include <termio.h>
-#include "S12eVec.h"
-#include "ADS12.h"
-#include "Orientation.h"
-#include "DCMotor.h"
-#include "Bot.h"
-#include "JSRcommand.h"
-#include "Shoot.h"
-#include "IRemitter.h"
-
-/*----------------------------- Module Defines ----------------------------*/
-// these times assume a 1.024mS/tick timing
-#define ONE_SEC 976
-#define HALF_SEC (ONE_SEC/2)
-#define TWO_SEC (ONE_SEC*2)
-#define FIVE_SEC (ONE_SEC*5)
-
-//Tape Sensors
-#define RIGHT_TAPESENSOR_PIN 6 
-
-//Tape Colors
-#define WHITE 0
-#define RED 1
-#define GREEN 2
-#define BLACK 3
-
-#define AlignTapeTime 10 //20ms
-
-
-/*---------------------------- Module Functions ---------------------------*/
-
-/***************************************************************************
- private functions
- ***************************************************************************/
-//void AlignWithTape(void);
-/*---------------------------- Module Variables ---------------------------*/
-static uint8_t MyPriority;
-
-static unsigned int TargetColor;
-static unsigned int CurrentOState;
-static unsigned int RELOAD_STATUS = DARK_RELOAD_STATUS;
-static bool DontChangeKnightFlag = false;
-static bool NotYetDetected = true;
-
-/*------------------------------ Module Code ------------------------------*/
-/****************************************************************************
- Function
-     InitTestHarnessService13
-
- Parameters
-     uint8_t : the priorty of this service
-
- Returns
-     bool, false if error in initialization, true otherwise
-
- Description
-     Saves away the priority, and does any 
-     other required initialization for this service
- Notes
-
- Author
-     J. Edward Carryer, 01/16/12, 10:00
-****************************************************************************/
-bool InitOrientation ( uint8_t Priority )
-{
-   ES_Event ThisEvent;
-
-   MyPriority = Priority;
-   ADS12_Init("AAAAAAAA"); //Analog Inputs
- 
-   CurrentOState = Align2Horizontal;
-   TargetColor = WHITE;
-  
-   ThisEvent.EventType = ES_INIT;
-   if (ES_PostToService( MyPriority, ThisEvent) == true)
-      return true;
-   else
-      return false;
-}
-
-/****************************************************************************
- Function
-     PostTestHarnessService13
-
- Parameters
-     EF_Event ThisEvent ,the event to post to the queue
-
- Returns
-     bool false if the Enqueue operation failed, true otherwise
-
- Description
-     Posts an event to this state machine's queue
- Notes
-
- Author
-     J. Edward Carryer, 10/23/11, 19:25
-****************************************************************************/
-bool PostOrientation( ES_Event ThisEvent )
-{
-   return ES_PostToService( MyPriority, ThisEvent);
-}
-
-/****************************************************************************
- Function
-    RunTestHarnessService13
-
- Parameters
-   ES_Event : the event to process
-
- Returns
-   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
-
- Description
-   Robot looks for the first line of green tape, then the red mid-line and then 
-   the green again. Once the 2nd green tape is spotted, the robot moves for
-   another 1/2 second before stopping
- 
- Author 
-   P. Sherman, A. Han, 03/02/14, 16:30
-   J. Edward Carryer,  01/15/12, 15:23
-****************************************************************************/
-ES_Event RunOrientation( ES_Event ThisEvent )
-{
-   ES_Event ReturnEvent;
-   ES_Event NewEvent;
-   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-       
-   switch (ThisEvent.EventType)
-   {
-      case(UpdateTargetColor):
-         TargetColor = ThisEvent.EventParam;
-         NotYetDetected = true;
-         break;
-  		
-      case(Right_Tape):
-         //Seeing Red Tape
-         if(ThisEvent.EventParam == TargetColor && TargetColor == RED)
-         {
-            NotYetDetected = false;
-            if(GetCurrentRound() == 1 || GetCurrentRound() == 3)
-            {
-               timedTranslate(65, (ONE_SEC*3)/8);
-            }
-            else 
-            {
-               timedTranslate(-65, (ONE_SEC*3)/4);
-            }
-         }
-  		   //Seeing Green Tape
-         if(ThisEvent.EventParam == TargetColor && TargetColor == GREEN)
-         {
-            ES_Timer_InitTimer(Tape_Timer, 6*ONE_SEC/4);
-         }
-         break;
-  		
-      case(ES_TIMEOUT):
-         if((ThisEvent.EventParam == Pause_Timer) && (NotYetDetected == true))
-         {
-            ES_Timer_StopTimer(StopMoving_Timer);
-            if(GetCurrentRound() == 1 || GetCurrentRound() == 3)
-            {
-               //Forward into Home
-               timedTranslate(65, 1*(ONE_SEC)/4);
-            }
-            else 
-            {
-               //Backing into Home
-               timedTranslate(-65, (ONE_SEC)/2);
-            }
-         }
-         else if (ThisEvent.EventParam == Tape_Timer)
-         {
-            TargetColor = RED;
-         }
-         else if((ThisEvent.EventParam == StopMoving_Timer) &&
-                   (NotYetDetected == true))
-         {
-            NotYetDetected = false;
-            if(GetCurrentRound() == 1 || GetCurrentRound() == 3)
-            {
-               //Forward into Home
-               timedTranslate(65, (ONE_SEC*1)/4);
-            }
-            else 
-            {
-               //Backing into Home
-               timedTranslate(-65, (ONE_SEC)/4);
-            }
-         }
-         break;
-   } //End Swich  
-  
-   return ReturnEvent;
-}
-
-/***************************************************************************
-                        private functions
- **************************************************************************/
-
-/*----------------Tape Sensor Event Checkers-----------------------*/
-
-/* 
-Function: Check4RightTape
------------------------------
-Event Checker for tape center on side of bot. Tape sensor with analog
-input is used. Values were experimentally matched with different colors
-on the game board. Colors included: Black, White, Red, Green
-*/
-bool Check4RightTape(void) {
-	ES_Event NewEvent;
-	static unsigned int RightTapeFlag = WHITE;
-   static unsigned int LastPinState;
-   static unsigned int CurrentPinState;
-   static int numTimesSeen = 0;
-    
-    bool ChangeSeen = false;                                  
-   
-    //Use simple filtering to smooth out any major spikes 
-    CurrentPinState = 9*ADS12_ReadADPin(COLOR_TAPESENSOR_PIN)/10 
-                        + LastPinState/10;
-    
-    LastPinState = CurrentPinState;
-
-    //Match sensor value with color 
-    if(RightTapeFlag != WHITE)
-    {
-      if(CurrentPinState < 220) //See White Tape
-      {
-        RightTapeFlag = WHITE;
-        ChangeSeen = true;
-      }
-    }
-    if (RightTapeFlag != RED)
-    {
-      if(CurrentPinState > 260 && CurrentPinState < 315) //See Red Tape 
-      {
-         RightTapeFlag = RED;
-         ChangeSeen = true;
-      }
-    }
-    if (RightTapeFlag != GREEN)
-    {
-      if(CurrentPinState > 350 && CurrentPinState < 440) //See Green Tape 
-      {
-         RightTapeFlag = GREEN;
-         ChangeSeen = true;
-      }
-    }
-    if (RightTapeFlag != BLACK)
-    {
-      if(CurrentPinState > 460) //See Black Tape 
-      {	 
-         RightTapeFlag = BLACK;
-         ChangeSeen = true;
-      }
-    }   
-        
-    if (ChangeSeen == true)
-    {
-    	numTimesSeen = 0;
-    }
-    else
-    {
-       numTimesSeen++;	
-    }
-   
-    //Make sure color was seen 10 times in a row in case of false signals 
-    if(numTimesSeen == 10)
-    {
-       NewEvent.EventType = Right_Tape;
-       NewEvent.EventParam = RightTapeFlag;
-       PostOrientation(NewEvent);
-       return true;
-    }
-
-    //Make sure int doesn't roll over to zero and restart counter
-    if (numTimesSeen > 10)
-    {
-    	 numTimesSeen = 11;
-    }
-    
-    return false;
-} /* End Check4RightTape */
- 
-/*------------------------------- Footnotes -------------------------------*/
-/*------------------------------ End of file ------------------------------*/
-
+/****************************************************************************
+ Module
+   Orientation.c
+
+ Revision
+   1.0.1
+
+ Description
+  The game board for the project is mostly white but includes a line of
+  red tape at the mid line and green tape on either side to designate the 
+  home sections. A simple tape sensor is used to examine the color on the ground
+  as the robot moves. 
+
+ Notes
+   The green tape, Tape_Timer, red tape, move home sequence is the 
+   TapeThread protothread. The fallback timeouts stay in RunOrientation.
+   The moves into the home section are motion scripts run by DCMotor,
+   forward in rounds 1 and 3 and backing up in rounds 2 and 4.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/29/14 09:40 PS       Dropped CurrentOState, never read and set to a
+                         state that no longer exists
+ 04/26/14 10:20 PS       Running state gathered into Vars for snapshots
+ 04/25/14 09:30 PS       Tape bands and homing moves overridable from 
+                         the build
+ 04/24/14 15:40 PS       Tape sensor read through the sensor seam
+ 04/24/14 10:15 PS       Homing moves run as DCMotor motion scripts
+ 04/23/14 11:30 PS       Tape sequence written as a protothread
+ 03/10/15 12:10 PS, AH   Changed file for use in project
+ 10/21/13 19:38 jec      created to test 16 possible serves, we need a bunch
+                         of service test harnesses
+ 08/05/13 20:33 jec      converted to test harness service
+ 01/16/12 09:58 jec      began conversion from TemplateFSM.c
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "JSRcommand.h"
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */
+#include <Bin_Const.h>
+#include <termio.h>
+#include "S12eVec.h"
+#include "ADS12.h"
+#include "Orientation.h"
+#include "Fault.h"
+#include "DCMotor.h"
+#include "Bot.h"
+#include "JSRcommand.h"
+#include "Shoot.h"
+#include "IRemitter.h"
+#include "Protothread.h"
+#include "Sensors.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// these times assume a 1.024mS/tick timing
+#define ONE_SEC 976
+#define HALF_SEC (ONE_SEC/2)
+#define TWO_SEC (ONE_SEC*2)
+#define FIVE_SEC (ONE_SEC*5)
+
+//Tape Colors
+#define WHITE 0
+#define RED 1
+#define GREEN 2
+#define BLACK 3
+
+#define AlignTapeTime 10 //20ms
+
+//Tuning below can be set from the build (-DHOME_SPEED=70) to try other
+//values without editing this file
+
+//Tape sensor A/D bands, and readings in a row before a colour counts
+#ifndef TAPE_WHITE_MAX
+#define TAPE_WHITE_MAX 220
+#endif
+#ifndef TAPE_RED_MIN
+#define TAPE_RED_MIN 260
+#endif
+#ifndef TAPE_RED_MAX
+#define TAPE_RED_MAX 315
+#endif
+#ifndef TAPE_GREEN_MIN
+#define TAPE_GREEN_MIN 350
+#endif
+#ifndef TAPE_GREEN_MAX
+#define TAPE_GREEN_MAX 440
+#endif
+#ifndef TAPE_BLACK_MIN
+#define TAPE_BLACK_MIN 460
+#endif
+#ifndef TAPE_SAMPLES
+#define TAPE_SAMPLES 10
+#endif
+
+//Time on the green tape before looking for red
+#ifndef GREEN_TIME
+#define GREEN_TIME (6*ONE_SEC/4)
+#endif
+
+//Moves into home: after the red midline, after a pause and when the 
+//stop moving time runs out with no tape seen
+#ifndef HOME_SPEED
+#define HOME_SPEED 65
+#endif
+#ifndef RED_FORWARD_TIME
+#define RED_FORWARD_TIME ((ONE_SEC*3)/8)
+#endif
+#ifndef RED_BACK_TIME
+#define RED_BACK_TIME ((ONE_SEC*3)/4)
+#endif
+#ifndef PAUSE_FORWARD_TIME
+#define PAUSE_FORWARD_TIME (ONE_SEC/4)
+#endif
+#ifndef PAUSE_BACK_TIME
+#define PAUSE_BACK_TIME (ONE_SEC/2)
+#endif
+#ifndef LATE_FORWARD_TIME
+#define LATE_FORWARD_TIME (ONE_SEC/4)
+#endif
+#ifndef LATE_BACK_TIME
+#define LATE_BACK_TIME (ONE_SEC/4)
+#endif
+
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool TapeThread(ES_Event ThisEvent);
+static void MoveHome(const MotionStep_t *Forward, const MotionStep_t *Back);
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+//void AlignWithTape(void);
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   unsigned int TargetColor;
+   bool NotYetDetected;
+   PT_t TapePT;
+   unsigned int TapeColor;
+   unsigned int RightTapeFlag;   //Check4RightTape's filter and debounce
+   unsigned int LastPinState;
+   int numTimesSeen;
+} OrientationVars_t;
+
+static OrientationVars_t Vars = {0, true, 0, WHITE, WHITE, 0, 0};
+
+//Into home after the red midline
+static const MotionStep_t RedForward[] = 
+{
+   {MOTION_TIMED, HOME_SPEED, RED_FORWARD_TIME, 0},
+   {MOTION_STOP, 0, 0, 0}
+};
+static const MotionStep_t RedBack[] = 
+{
+   {MOTION_TIMED, -HOME_SPEED, RED_BACK_TIME, 0},
+   {MOTION_STOP, 0, 0, 0}
+};
+
+//Into home when the tape was never seen
+static const MotionStep_t PauseForward[] = 
+{
+   {MOTION_TIMED, HOME_SPEED, PAUSE_FORWARD_TIME, 0},
+   {MOTION_STOP, 0, 0, 0}
+};
+static const MotionStep_t PauseBack[] = 
+{
+   {MOTION_TIMED, -HOME_SPEED, PAUSE_BACK_TIME, 0},
+   {MOTION_STOP, 0, 0, 0}
+};
+static const MotionStep_t LateForward[] = 
+{
+   {MOTION_TIMED, HOME_SPEED, LATE_FORWARD_TIME, 0},
+   {MOTION_STOP, 0, 0, 0}
+};
+static const MotionStep_t LateBack[] = 
+{
+   {MOTION_TIMED, -HOME_SPEED, LATE_BACK_TIME, 0},
+   {MOTION_STOP, 0, 0, 0}
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitTestHarnessService13
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, and does any 
+     other required initialization for this service
+ Notes
+
+ Author
+     J. Edward Carryer, 01/16/12, 10:00
+****************************************************************************/
+bool InitOrientation ( uint8_t Priority )
+{
+   ES_Event ThisEvent;
+
+   MyPriority = Priority;
+   ADS12_Init("AAAAAAAA"); //Analog Inputs
+ 
+   Vars.TargetColor = WHITE;
+  
+   ThisEvent.EventType = ES_INIT;
+   if (ES_PostToService( MyPriority, ThisEvent) == true)
+      return true;
+   else
+      return false;
+}
+
+/****************************************************************************
+ Function
+     PostTestHarnessService13
+
+ Parameters
+     EF_Event ThisEvent ,the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to this state machine's queue
+ Notes
+
+ Author
+     J. Edward Carryer, 10/23/11, 19:25
+****************************************************************************/
+bool PostOrientation( ES_Event ThisEvent )
+{
+   FAULT_POST(ThisEvent);
+   return ES_PostToService( MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunTestHarnessService13
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   Robot looks for the first line of green tape, then the red mid-line and then 
+   the green again. Once the 2nd green tape is spotted, the robot moves for
+   another 1/2 second before stopping
+ 
+ Author 
+   P. Sherman, A. Han, 03/02/14, 16:30
+   J. Edward Carryer,  01/15/12, 15:23
+****************************************************************************/
+ES_Event RunOrientation( ES_Event ThisEvent )
+{
+   ES_Event ReturnEvent;
+   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+       
+   switch (ThisEvent.EventType)
+   {
+      case(UpdateTargetColor):
+         Vars.TargetColor = ThisEvent.EventParam;
+         Vars.NotYetDetected = true;
+         PT_INIT(&Vars.TapePT);
+         break;
+  		
+      case(ES_TIMEOUT):
+         if((ThisEvent.EventParam == Pause_Timer) && 
+            (Vars.NotYetDetected == true))
+         {
+            ES_Timer_StopTimer(StopMoving_Timer);
+            MoveHome(PauseForward, PauseBack);
+         }
+         else if((ThisEvent.EventParam == StopMoving_Timer) &&
+                   (Vars.NotYetDetected == true))
+         {
+            Vars.NotYetDetected = false;
+            MoveHome(LateForward, LateBack);
+         }
+         break;
+   } //End Swich  
+  
+   TapeThread(ThisEvent);
+   return ReturnEvent;
+}
+
+/***************************************************************************
+                        private functions
+ **************************************************************************/
+
+/* 
+Function: TapeThread
+-----------------------------
+Looking for green: wait for it, stay on it for GREEN_TIME and then look 
+for red. On red, move into the home section, forward in rounds 1 and 3
+and backing up in rounds 2 and 4.
+*/
+static bool TapeThread(ES_Event ThisEvent)
+{
+   PT_BEGIN(&Vars.TapePT);
+   if(Vars.TargetColor == GREEN)
+   {
+      PT_WAIT_UNTIL(&Vars.TapePT, ThisEvent.EventType == Right_Tape &&
+                             ThisEvent.EventParam == GREEN);
+      PT_AWAIT_TIME(&Vars.TapePT, ThisEvent, Tape_Timer, GREEN_TIME);
+      Vars.TargetColor = RED;
+   }
+   if(Vars.TargetColor == RED)
+   {
+      PT_WAIT_UNTIL(&Vars.TapePT, ThisEvent.EventType == Right_Tape &&
+                             ThisEvent.EventParam == RED);
+      Vars.NotYetDetected = false;
+      MoveHome(RedForward, RedBack);
+   }
+   PT_END(&Vars.TapePT);
+}
+
+/* 
+Function: MoveHome
+-----------------------------
+Run the move into the home section, forward in rounds 1 and 3 and backing
+into home in rounds 2 and 4.
+*/
+static void MoveHome(const MotionStep_t *Forward, const MotionStep_t *Back)
+{
+   if(GetCurrentRound() == 1 || GetCurrentRound() == 3)
+      StartMotion(Forward, 2, 0);
+   else
+      StartMotion(Back, 2, 0);
+}
+
+/* 
+Function: GetTapeColor
+-----------------------------
+Last colour the tape sensor settled on.
+*/
+unsigned int GetTapeColor(void)
+{
+   return Vars.TapeColor;
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetOrientationVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetOrientationVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/*----------------Tape Sensor Event Checkers-----------------------*/
+
+/* 
+Function: Check4RightTape
+-----------------------------
+Event Checker for tape center on side of bot. Tape sensor with analog
+input is used. Values were experimentally matched with different colors
+on the game board. Colors included: Black, White, Red, Green
+*/
+bool Check4RightTape(void) {
+	ES_Event NewEvent;
+   unsigned int CurrentPinState;
+    
+    bool ChangeSeen = false;                                  
+   
+    //Use simple filtering to smooth out any major spikes 
+    CurrentPinState = 9*ReadSensor(SENSOR_TAPE)/10 
+                        + Vars.LastPinState/10;
+    
+    Vars.LastPinState = CurrentPinState;
+
+    //Match sensor value with color 
+    if(Vars.RightTapeFlag != WHITE)
+    {
+      if(CurrentPinState < TAPE_WHITE_MAX) //See White Tape
+      {
+        Vars.RightTapeFlag = WHITE;
+        ChangeSeen = true;
+      }
+    }
+    if (Vars.RightTapeFlag != RED)
+    {
+      if(CurrentPinState > TAPE_RED_MIN && 
+         CurrentPinState < TAPE_RED_MAX) //See Red Tape 
+      {
+         Vars.RightTapeFlag = RED;
+         ChangeSeen = true;
+      }
+    }
+    if (Vars.RightTapeFlag != GREEN)
+    {
+      if(CurrentPinState > TAPE_GREEN_MIN && 
+         CurrentPinState < TAPE_GREEN_MAX) //See Green Tape 
+      {
+         Vars.RightTapeFlag = GREEN;
+         ChangeSeen = true;
+      }
+    }
+    if (Vars.RightTapeFlag != BLACK)
+    {
+      if(CurrentPinState > TAPE_BLACK_MIN) //See Black Tape 
+      {	 
+         Vars.RightTapeFlag = BLACK;
+         ChangeSeen = true;
+      }
+    }   
+        
+    if (ChangeSeen == true)
+    {
+    	Vars.numTimesSeen = 0;
+    }
+    else
+    {
+       Vars.numTimesSeen++;	
+    }
+   
+    //Make sure color was seen TAPE_SAMPLES times in a row in case of false
+    //signals 
+    if(Vars.numTimesSeen == TAPE_SAMPLES)
+    {
+       Vars.TapeColor = Vars.RightTapeFlag;
+       NewEvent.EventType = Right_Tape;
+       NewEvent.EventParam = Vars.RightTapeFlag;
+       PostOrientation(NewEvent);
+       return true;
+    }
+
+    //Make sure int doesn't roll over to zero and restart counter
+    if (Vars.numTimesSeen > TAPE_SAMPLES)
+    {
+    	 Vars.numTimesSeen = TAPE_SAMPLES + 1;
+    }
+    
+    return false;
+} /* End Check4RightTape */
+ 
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
+
@@ -0,0 +1,58 @@
+/****************************************************************************
+ 
+  Stackless coroutines (protothreads) for timed multi-step sequences
+
+  A sequence is written as one function of the event being processed,
+  with await points where it gives the event back and carries on from 
+  there with a later event. All that is kept between events is one 
+  PT_t per sequence, the line to resume at.
+
+  static PT_t FeedPT;
+  static bool FeedThread(ES_Event ThisEvent)
+  {
+     PT_BEGIN(&FeedPT);
+     ...
+     PT_AWAIT_TIME(&FeedPT, ThisEvent, ShootTimer, PUSH_TIME);
+     ...
+     PT_END(&FeedPT);
+  }
+
+  Rules, since the await points are case labels of one hidden switch:
+  - local variables do not keep their values across an await
+  - no switch statement of its own in the sequence body
+  - at most one await per source line
+
+*****************************************************************************/
+
+#ifndef Protothread_H
+#define Protothread_H
+
+#include "ES_Types.h"
+
+typedef unsigned int PT_t;
+
+//Start (or restart) a sequence from the top on the next event
+#define PT_INIT(pt) (*(pt) = 0)
+
+#define PT_BEGIN(pt) switch(*(pt)) { case 0:
+
+//Falling off the end restarts the sequence, returns false once done
+#define PT_END(pt) } *(pt) = 0; return false
+
+//Return true (still running) until cond holds for an event
+#define PT_WAIT_UNTIL(pt, cond) \
+   do { *(pt) = __LINE__; case __LINE__: if(!(cond)) return true; } while(0)
+
+#define PT_AWAIT_EVENT(pt, ev, type) \
+   PT_WAIT_UNTIL(pt, (ev).EventType == (type))
+
+//Run an ES timer and wait for its timeout
+#define PT_AWAIT_TIME(pt, ev, timer, ticks) \
+   do { ES_Timer_InitTimer((timer), (ticks)); \
+        PT_WAIT_UNTIL(pt, (ev).EventType == ES_TIMEOUT && \
+                          (ev).EventParam == (timer)); } while(0)
+
+//Give up the rest of the sequence, start from the top next event
+#define PT_RESTART(pt) do { PT_INIT(pt); return true; } while(0)
+
+#endif /* Protothread_H */
@@ -0,0 +1,326 @@
+/****************************************************************************
+ Module
+   Ramp.c
+
+ Revision
+   1.0.1
+
+ Description
+   Shared soft-start for the PWM outputs of the drive wheels and the 
+   flywheels. Services set a target duty for a channel and the ramp slews
+   the actual output toward it at the channel's rate, so no motor is ever
+   stepped from rest to full duty.
+   Starting a stopped motor draws the most current, so starts also need a
+   share of a global current budget. Starts that do not fit wait until the
+   motors already starting reach their target, which staggers motors that
+   are all switched on at the same moment instead of letting the combined
+   inrush sag the supply.
+
+ Notes
+   Reductions in duty and stops are applied at once, only increases are 
+   rate limited. A change of direction goes through zero and counts as a 
+   new start.
+   Channels are updated every RAMP_TIME from the CheckRamp event checker.
+   Waiting starts are admitted in channel order.
+   RewriteRamps writes every running output again for Battery.c when the
+   pack compensation the writers apply changes.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 05/01/14 12:00 PS      RewriteRamps, for a change of pack compensation
+ 04/26/14 10:20 PS      Running state gathered into Vars for snapshots
+ 04/11/14 15:30 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "Ramp.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define RAMP_TIME 5     //update period (timer ticks)
+#define RAMP_SCALE 16   //output kept in 1/16 duty steps so slow rates work
+
+//Total start cost allowed at once. Both drive wheels together, or the two
+//flywheels, but not all four motors
+#define RAMP_BUDGET 4
+
+//Channel states
+#define RAMP_IDLE 0      //output at target
+#define RAMP_WAITING 1   //start requested, waiting for budget
+#define RAMP_STARTING 2  //ramping up from rest, holding budget
+#define RAMP_SLEWING 3   //ramping up from a non-zero output
+
+typedef struct
+{
+   pRampWrite Write;
+   signed int Target;
+   signed int Output;   //scaled by RAMP_SCALE
+   signed int Written;  //last duty handed to Write
+   unsigned int Rate;   //scaled duty per update
+   unsigned char Cost;
+   unsigned char Link;
+   unsigned char State;
+} RampChannel_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void UpdateRamps(void);
+static void AdmitStarts(void);
+static void StepRamp(RampChannel_t *Ramp);
+static void WriteRamp(RampChannel_t *Ramp);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   RampChannel_t Ramps[NUM_RAMPS];
+   unsigned int LastUpdate;
+} RampVars_t;
+
+static RampVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+/* Function: InitRamp
+  ---------------------
+  Register an output. Write is called with the new duty whenever the ramp
+  changes it, Rate is the largest duty increase per update in 1/RAMP_SCALE
+  steps and Cost is the share of the budget a start from rest takes. 
+  A linked channel is always admitted together with this one. The output
+  is assumed to be at 0 already.
+*/
+void InitRamp(unsigned char Channel, pRampWrite Write, unsigned int Rate,
+              unsigned char Cost, unsigned char Link)
+{
+   RampChannel_t *Ramp = &Vars.Ramps[Channel];
+   
+   Ramp->Write = Write;
+   Ramp->Target = 0;
+   Ramp->Output = 0;
+   Ramp->Written = 0;
+   Ramp->Rate = Rate;
+   Ramp->Cost = Cost;
+   Ramp->Link = Link;
+   Ramp->State = RAMP_IDLE;
+}
+
+/* Function: SetRampTarget
+  --------------------------
+  Set the duty a channel should ramp to. Anything that reduces the output
+  is written straight away.
+*/
+void SetRampTarget(unsigned char Channel, signed int Duty)
+{
+   RampChannel_t *Ramp = &Vars.Ramps[Channel];
+   signed int Scaled = Duty * RAMP_SCALE;
+   
+   Ramp->Target = Duty;
+   
+   if((Ramp->Output > 0 && Scaled < 0) || (Ramp->Output < 0 && Scaled > 0))
+   {
+      //Reversing, drop to rest first
+      Ramp->Output = 0;
+      WriteRamp(Ramp);
+   }
+   else if((Scaled >= 0 && Scaled <= Ramp->Output) || 
+           (Scaled <= 0 && Scaled >= Ramp->Output))
+   {
+      Ramp->Output = Scaled;
+      WriteRamp(Ramp);
+      Ramp->State = RAMP_IDLE;
+      return;
+   }
+   
+   if(Ramp->Output == 0)
+   {
+      if(Ramp->State != RAMP_STARTING)
+         Ramp->State = RAMP_WAITING;
+   }
+   else if(Ramp->State != RAMP_STARTING)
+   {
+      Ramp->State = RAMP_SLEWING;
+   }
+}
+
+/* Function: HaltRamp
+  ---------------------
+  Forget a channel's target and output after the caller has zeroed the
+  hardware itself. Nothing is written.
+*/
+void HaltRamp(unsigned char Channel)
+{
+   Vars.Ramps[Channel].Target = 0;
+   Vars.Ramps[Channel].Output = 0;
+   Vars.Ramps[Channel].Written = 0;
+   Vars.Ramps[Channel].State = RAMP_IDLE;
+}
+
+/* Function: GetRampOutput
+  --------------------------
+  Duty currently on the output.
+*/
+signed int GetRampOutput(unsigned char Channel)
+{
+   return Vars.Ramps[Channel].Written;
+}
+
+/* Function: IsRampSettled
+  --------------------------
+  True once the output has reached the target.
+*/
+bool IsRampSettled(unsigned char Channel)
+{
+   return Vars.Ramps[Channel].State == RAMP_IDLE;
+}
+
+/* Function: RewriteRamps
+  --------------------------
+  Hand every output that is not at 0 to its writer again, unchanged, so
+  the writer can apply a new scaling to a held duty.
+*/
+void RewriteRamps(void)
+{
+   unsigned char i;
+   
+   for(i = 0; i < NUM_RAMPS; i++)
+   {
+      if(Vars.Ramps[i].Written != 0 && Vars.Ramps[i].Write != 0)
+         Vars.Ramps[i].Write(Vars.Ramps[i].Written);
+   }
+}
+
+/****************************************************************************
+Function: CheckRamp
+------------------------------
+Event checker used as the ramp update tick. Never posts an event.
+*/
+bool CheckRamp(void)
+{
+   if((unsigned int)(ES_Timer_GetTime() - Vars.LastUpdate) >= RAMP_TIME)
+   {
+      Vars.LastUpdate = ES_Timer_GetTime();
+      UpdateRamps();
+   }
+   return false;
+}
+
+#ifdef SNAPSHOT
+/* Function: GetRampVars
+  -----------------------
+  Where this module's running state lives, for Snapshot.c.
+*/
+StateBlock_t GetRampVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: UpdateRamps
+  ------------------------
+  Admit waiting starts that fit in the budget, then step every ramping
+  channel toward its target.
+*/
+static void UpdateRamps(void)
+{
+   unsigned char i;
+   
+   AdmitStarts();
+   for(i = 0; i < NUM_RAMPS; i++)
+   {
+      if(Vars.Ramps[i].State == RAMP_STARTING || 
+         Vars.Ramps[i].State == RAMP_SLEWING)
+         StepRamp(&Vars.Ramps[i]);
+   }
+}
+
+/* Function: AdmitStarts
+  ------------------------
+  Budget in use is the cost of every channel still starting. Waiting 
+  channels are admitted in order, with their waiting link, until one does
+  not fit. A start is always admitted when nothing else is starting.
+*/
+static void AdmitStarts(void)
+{
+   unsigned char i;
+   unsigned char Used = 0;
+   unsigned char Cost;
+   RampChannel_t *Link;
+   
+   for(i = 0; i < NUM_RAMPS; i++)
+   {
+      if(Vars.Ramps[i].State == RAMP_STARTING)
+         Used += Vars.Ramps[i].Cost;
+   }
+   
+   for(i = 0; i < NUM_RAMPS; i++)
+   {
+      if(Vars.Ramps[i].State != RAMP_WAITING)
+         continue;
+      
+      Link = 0;
+      Cost = Vars.Ramps[i].Cost;
+      if(Vars.Ramps[i].Link != RAMP_NO_LINK && 
+         Vars.Ramps[Vars.Ramps[i].Link].State == RAMP_WAITING)
+      {
+         Link = &Vars.Ramps[Vars.Ramps[i].Link];
+         Cost += Link->Cost;
+      }
+      
+      if(Used != 0 && Used + Cost > RAMP_BUDGET)
+         return;
+      
+      Vars.Ramps[i].State = RAMP_STARTING;
+      if(Link != 0)
+         Link->State = RAMP_STARTING;
+      Used += Cost;
+   }
+}
+
+/* Function: StepRamp
+  ---------------------
+  Move the output one step toward the target.
+*/
+static void StepRamp(RampChannel_t *Ramp)
+{
+   signed int Scaled = Ramp->Target * RAMP_SCALE;
+   
+   if(Scaled > Ramp->Output)
+   {
+      if(Scaled - Ramp->Output > (signed int)Ramp->Rate)
+         Ramp->Output += Ramp->Rate;
+      else
+         Ramp->Output = Scaled;
+   }
+   else
+   {
+      if(Ramp->Output - Scaled > (signed int)Ramp->Rate)
+         Ramp->Output -= Ramp->Rate;
+      else
+         Ramp->Output = Scaled;
+   }
+   
+   WriteRamp(Ramp);
+   if(Ramp->Output == Scaled)
+      Ramp->State = RAMP_IDLE;
+}
+
+/* Function: WriteRamp
+  ----------------------
+  Hand the output to the channel's writer when the whole duty changes.
+*/
+static void WriteRamp(RampChannel_t *Ramp)
+{
+   signed int Duty = Ramp->Output / RAMP_SCALE;
+   
+   if(Duty != Ramp->Written)
+   {
+      Ramp->Written = Duty;
+      Ramp->Write(Duty);
+   }
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,38 @@
+/****************************************************************************
+ 
+  Header file for the shared soft-start ramp for PWM outputs
+
+*****************************************************************************/
+
+#ifndef Ramp_H
+#define Ramp_H
+
+#include "ES_Types.h"
+#include "Snapshot.h"
+
+//Ramped outputs. Left and right drive wheels are linked so they always 
+//start together
+#define RAMP_DRIVE_RIGHT 0
+#define RAMP_DRIVE_LEFT 1
+#define RAMP_FLYWHEEL_1 2
+#define RAMP_FLYWHEEL_2 3
+#define NUM_RAMPS 4
+
+#define RAMP_NO_LINK 0xFF
+
+typedef void (*pRampWrite)(signed int Duty);
+
+// Public Function Prototypes
+void InitRamp(unsigned char Channel, pRampWrite Write, unsigned int Rate,
+              unsigned char Cost, unsigned char Link);
+void SetRampTarget(unsigned char Channel, signed int Duty);
+void HaltRamp(unsigned char Channel);
+signed int GetRampOutput(unsigned char Channel);
+bool IsRampSettled(unsigned char Channel);
+void RewriteRamps(void);
+bool CheckRamp(void);
+#ifdef SNAPSHOT
+StateBlock_t GetRampVars(void);
+#endif
+
+#endif /* Ramp_H */
@@ -0,0 +1,262 @@
+/****************************************************************************
+ Module
+   Recorder.c
+
+ Revision
+   1.0.1
+
+ Description
+   Keeps the raw readings of the IR detectors, the tape sensor and the 
+   drive pack, with the time each was taken, in a RAM ring so a run that
+   misread the board can be looked at afterwards. DumpRecording prints 
+   the ring over the SCI, oldest first, one "time sensor reading" line 
+   per entry.
+
+ Notes
+   Only built with SENSOR_RECORD defined. ReadSensor hands every A/D 
+   reading to RecordSensor; readings from another source are not kept.
+   The checkers poll far faster than the readings move, so a reading is
+   only kept when it is more than REC_DEADBAND away from the last one 
+   kept for that sensor, or REC_REFRESH ticks after it. Steady sensors 
+   then cost one entry a second, and the ring covers tens of seconds of
+   a run instead of a few milliseconds of polling.
+   With SENSOR_SEAM defined too, StartReplay feeds the ring back to the
+   event checkers through SetSensorSource. The replay runs in real time:
+   each read of a sensor gets the latest reading kept for it at the same
+   time into the recording. The A/D comes back once the replay passes
+   the last entry.
+   On the PC, host/Replay.c plays a dump of the ring through the same
+   checkers at full speed and prints the events they post.
+   REC_SIZE entries of 4 bytes each; the oldest are written over. The 
+   16-bit entry times limit a replay to the last 64s of the ring.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 20:00 PS      Points to the host replay of a dump
+ 04/28/14 11:00 PS      Readings kept on change, real time replay, state
+                        gathered into Vars for snapshots
+ 04/26/14 15:30 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Timers.h"
+#include "Recorder.h"
+#include "Sensors.h"
+#include "Snapshot.h"
+
+#include <stdio.h>
+
+#ifdef SENSOR_RECORD
+/*----------------------------- Module Defines ----------------------------*/
+#ifndef REC_SIZE
+#define REC_SIZE 256
+#endif
+#ifndef REC_DEADBAND
+#define REC_DEADBAND 4      //A/D counts a reading must move to be kept
+#endif
+#ifndef REC_REFRESH
+#define REC_REFRESH 976     //ticks a steady reading is kept again after
+#endif
+
+//Sensor in the top bits of an entry, 10 bit reading below
+#define SENSOR_SHIFT 12
+#define READING_MASK 0x03FF
+
+//Entries counted from the oldest
+#define OLDEST ((Vars.Head + REC_SIZE - Vars.Count) % REC_SIZE)
+#define ENTRY(n) (Vars.Ring[(OLDEST + (n)) % REC_SIZE])
+
+typedef struct
+{
+   unsigned int Time;
+   unsigned int Value;
+} RecEntry_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+#ifdef SENSOR_SEAM
+static unsigned int EntryTime(unsigned int n);
+static short ReplaySensor(unsigned char Sensor);
+#endif
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   RecEntry_t Ring[REC_SIZE];
+   unsigned int Head;      //next entry written
+   unsigned int Count;
+   bool Replaying;
+   
+   //Last reading kept for each sensor, and when
+   short LastKept[NUM_SENSORS];
+   unsigned int LastKeptTime[NUM_SENSORS];
+   bool Kept[NUM_SENSORS];
+   
+   //Replay: where each sensor has got to and when the replay started
+   unsigned int Next[NUM_SENSORS];
+   short LastReplayed[NUM_SENSORS];
+   unsigned int ReplayStart;
+} RecorderVars_t;
+
+static RecorderVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   RecordSensor
+
+ Parameters
+   unsigned char : SENSOR_ name of the sensor read
+   short : the A/D reading
+****************************************************************************/
+void RecordSensor(unsigned char Sensor, short Reading)
+{
+   unsigned int Now = ES_Timer_GetTime();
+   short Change = Reading - Vars.LastKept[Sensor];
+   
+   if(Vars.Replaying)
+      return;
+   if(Vars.Kept[Sensor] && Change <= REC_DEADBAND && 
+      Change >= -REC_DEADBAND && 
+      (unsigned int)(Now - Vars.LastKeptTime[Sensor]) < REC_REFRESH)
+      return;
+   
+   Vars.Kept[Sensor] = true;
+   Vars.LastKept[Sensor] = Reading;
+   Vars.LastKeptTime[Sensor] = Now;
+   Vars.Ring[Vars.Head].Time = Now;
+   Vars.Ring[Vars.Head].Value = ((unsigned int)Sensor << SENSOR_SHIFT) | 
+                                ((unsigned int)Reading & READING_MASK);
+   Vars.Head = (Vars.Head + 1) % REC_SIZE;
+   if(Vars.Count < REC_SIZE)
+      Vars.Count++;
+}
+
+/****************************************************************************
+ Function
+   DumpRecording
+
+ Description
+   Prints the ring, oldest first. Slow at the SCI rate, so only after a
+   run.
+****************************************************************************/
+void DumpRecording(void)
+{
+   unsigned int n;
+   
+   printf("REC %u\r\n", Vars.Count);
+   for(n = 0; n < Vars.Count; n++)
+      printf("%u %u %u\r\n", ENTRY(n).Time, 
+             ENTRY(n).Value >> SENSOR_SHIFT, ENTRY(n).Value & READING_MASK);
+}
+
+/****************************************************************************
+ Function
+   ClearRecording
+****************************************************************************/
+void ClearRecording(void)
+{
+   unsigned char s;
+   
+   Vars.Head = 0;
+   Vars.Count = 0;
+   for(s = 0; s < NUM_SENSORS; s++)
+      Vars.Kept[s] = false;
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetRecorderVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetRecorderVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+#ifdef SENSOR_SEAM
+/****************************************************************************
+ Function
+   StartReplay
+
+ Description
+   Hands the recording to the event checkers in place of the A/D, from 
+   now on in step with the timer. Until its first entry comes up a 
+   sensor reads as its first reading in the ring. Nothing is recorded 
+   until the replay runs out.
+****************************************************************************/
+void StartReplay(void)
+{
+   unsigned char s;
+   unsigned int n;
+   
+   if(Vars.Count == 0)
+      return;
+   for(s = 0; s < NUM_SENSORS; s++)
+   {
+      Vars.Next[s] = 0;
+      Vars.LastReplayed[s] = 0;
+      for(n = 0; n < Vars.Count; n++)
+      {
+         if((ENTRY(n).Value >> SENSOR_SHIFT) == s)
+         {
+            Vars.LastReplayed[s] = ENTRY(n).Value & READING_MASK;
+            break;
+         }
+      }
+   }
+   Vars.ReplayStart = ES_Timer_GetTime();
+   Vars.Replaying = true;
+   SetSensorSource(ReplaySensor);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Function: EntryTime
+  ----------------------
+  Time of the n-th entry from the oldest, in ticks after the oldest.
+*/
+static unsigned int EntryTime(unsigned int n)
+{
+   return (unsigned int)(ENTRY(n).Time - ENTRY(0).Time) & 0xFFFFu;
+}
+
+/* Function: ReplaySensor
+  -------------------------
+  Sensor source for the replay: the latest reading kept for this sensor
+  at the same time into the recording as the replay has got to.
+*/
+static short ReplaySensor(unsigned char Sensor)
+{
+   unsigned int Elapsed = (ES_Timer_GetTime() - Vars.ReplayStart) & 0xFFFFu;
+   unsigned int n = Vars.Next[Sensor];
+   
+   if(Elapsed > EntryTime(Vars.Count - 1))
+   {
+      Vars.Replaying = false;
+      SetSensorSource(0);
+      return Vars.LastReplayed[Sensor];
+   }
+   while(n < Vars.Count && EntryTime(n) <= Elapsed)
+   {
+      if((ENTRY(n).Value >> SENSOR_SHIFT) == Sensor)
+         Vars.LastReplayed[Sensor] = ENTRY(n).Value & READING_MASK;
+      n++;
+   }
+   Vars.Next[Sensor] = n;
+   return Vars.LastReplayed[Sensor];
+}
+#endif
+#endif
+/*------------------------------ End of file ------------------------------*/
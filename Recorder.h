@@ -0,0 +1,26 @@
+/****************************************************************************
+ 
+  Header file for the raw sensor recorder (SENSOR_RECORD builds only)
+
+*****************************************************************************/
+
+#ifndef Recorder_H
+#define Recorder_H
+
+#include "ES_Types.h"
+#include "Snapshot.h"
+
+#ifdef SENSOR_RECORD
+// Public Function Prototypes
+void RecordSensor(unsigned char Sensor, short Reading);
+void DumpRecording(void);
+void ClearRecording(void);
+#ifdef SNAPSHOT
+StateBlock_t GetRecorderVars(void);
+#endif
+#ifdef SENSOR_SEAM
+void StartReplay(void);
+#endif
+#endif
+
+#endif /* Recorder_H */
@@ -0,0 +1,322 @@
+/****************************************************************************
+ Module
+   RoundScript.c
+
+ Revision
+   1.0.1
+
+ Description
+   Interpreter for the round scripts that say what the robot does in each
+   round and recess. A script is a const byte string of steps (align, 
+   shoot, drive, head for tape, deploy the lance, wait for a time or an 
+   event...) built with the RS_ macros in RoundScript.h, so changing the 
+   strategy means changing a table in Bot.c rather than the state machine.
+
+ Notes
+   Steps run back to back until a wait or the end of the script. Waits
+   are picked up again from RunRoundScript, which Bot calls with the 
+   events its state machine does not handle. Time waits use Bot_Timer.
+   Times "before the end" are against the match clock. HOME_BY arms 
+   StopMoving_Timer, so Orientation heads home as it did on the old fixed
+   timer, and sets the margin the SKIP_NO_ steps have to finish within.
+   With the match clock stopped, WAIT_UNTIL and HOME_BY do nothing.
+   Only one script runs at a time, starting a new one drops the old one.
+   At most RS_MAX_STEPS are run per call so a script that skips back on
+   itself can not lock up the framework.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/26/14 10:20 PS      Running state gathered into Vars for snapshots
+ 04/22/14 14:20 PS      Steps timed against the match clock
+ 04/21/14 10:40 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "RoundScript.h"
+#include "IR_Detect.h"
+#include "Shoot.h"
+#include "IRemitter.h"
+#include "Orientation.h"
+#include "DCMotor.h"
+#include "LanceFSM.h"
+#include "Servos.h"
+#include "MatchClock.h"
+#include "Bot.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define RS_MAX_STEPS 32
+#define AIM_SERVO 1
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Resume(void);
+static bool RunStep(void);
+static unsigned int Operand16(void);
+static void PostTo(pPostFunc Post, ES_EventTyp_t Type, uint16_t Param);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   const unsigned char *Script;
+   unsigned char PC;
+   ES_EventTyp_t WaitingFor;
+   unsigned int HomeBy;
+} RoundScriptVars_t;
+
+static RoundScriptVars_t Vars = {0, 0, ES_NO_EVENT, 0};
+
+//Bytes per step, opcode included
+static const unsigned char StepLength[NUM_RS_OPS] =
+{
+   1, 3, 2, 1, 1, 2, 2, 2, 3, 2, 1, 3, 3, 2, 2, 2, 3, 3, 3, 3
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   StartRoundScript
+
+ Parameters
+   const unsigned char * : script to run, 0 to run nothing
+
+ Description
+   Drops any running script and runs the new one up to its first wait.
+****************************************************************************/
+void StartRoundScript(const unsigned char *NewScript)
+{
+   StopRoundScript();
+   Vars.Script = NewScript;
+   Vars.PC = 0;
+   Vars.HomeBy = 0;
+   if(Vars.Script != 0)
+      Resume();
+}
+
+/****************************************************************************
+ Function
+   StopRoundScript
+
+ Description
+   Stops the running script where it is. Anything it already started 
+   (motors, alignment) keeps going.
+****************************************************************************/
+void StopRoundScript(void)
+{
+   if(Vars.WaitingFor == ES_TIMEOUT)
+      ES_Timer_StopTimer(Bot_Timer);
+   if(Vars.WaitingFor == MatchDeadline)
+      CancelDeadlines(PostBot);
+   Vars.WaitingFor = ES_NO_EVENT;
+   Vars.Script = 0;
+}
+
+/****************************************************************************
+ Function
+   RunRoundScript
+
+ Parameters
+   ES_Event : event posted to Bot
+
+ Returns
+   bool, true if the running script was waiting for this event
+
+ Description
+   Carries on with the script once the step it is waiting on is done.
+****************************************************************************/
+bool RunRoundScript(ES_Event ThisEvent)
+{
+   if(Vars.Script == 0 || Vars.WaitingFor == ES_NO_EVENT)
+      return false;
+   if(ThisEvent.EventType != Vars.WaitingFor)
+      return false;
+   if(Vars.WaitingFor == ES_TIMEOUT && ThisEvent.EventParam != Bot_Timer)
+      return false;
+   
+   Vars.WaitingFor = ES_NO_EVENT;
+   Resume();
+   return true;
+}
+
+/****************************************************************************
+ Function
+   IsRoundScriptDone
+
+ Description
+   True once the script has reached its end (or none is running).
+****************************************************************************/
+bool IsRoundScriptDone(void)
+{
+   return Vars.Script == 0;
+}
+
+#ifdef SNAPSHOT
+/****************************************************************************
+ Function
+   GetRoundScriptVars
+
+ Returns
+   StateBlock_t, where this module's running state lives (Snapshot.c)
+****************************************************************************/
+StateBlock_t GetRoundScriptVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/* Function: Resume
+  -------------------
+  Run steps until one has to wait or the script ends.
+*/
+static void Resume(void)
+{
+   unsigned char Steps;
+   
+   for(Steps = 0; Steps < RS_MAX_STEPS; Steps++)
+   {
+      if(!RunStep())
+         return;
+   }
+}
+
+/* Function: RunStep
+  --------------------
+  Run the step at PC and move past it. False if the script has to stop 
+  here, either to wait or because it is done.
+*/
+static bool RunStep(void)
+{
+   unsigned char Op = Vars.Script[Vars.PC];
+   unsigned char Arg;
+   unsigned char Skip = 0;
+   ES_Event Deadline;
+   
+   if(Op >= NUM_RS_OPS || Op == RS_OP_END)
+   {
+      Vars.Script = 0;
+      return false;
+   }
+   Arg = Vars.Script[Vars.PC + 1];
+   
+   switch(Op)
+   {
+      case RS_OP_ALIGN:
+         PostTo(PostIR_Detect, StartAlign, Operand16());
+         break;
+      case RS_OP_STOP_ALIGN:
+         PostTo(PostIR_Detect, StopAligning, Arg);
+         break;
+      case RS_OP_MOTORS_ON:
+         PostTo(PostShoot, StartShootingMotors, 0);
+         break;
+      case RS_OP_MOTORS_OFF:
+         PostTo(PostShoot, StopShootingMotors, 0);
+         break;
+      case RS_OP_SHOOT:
+         PostTo(PostShoot, Shoot_Ball, Arg);
+         break;
+      case RS_OP_RELOAD:
+         PostTo(PostShoot, RELOAD_BALLS, Arg);
+         PostTo(PostIRemitter, RELOAD_BALLS, Arg);
+         break;
+      case RS_OP_DRIVE:
+         driveStraight((signed char)Arg);
+         break;
+      case RS_OP_AIM:
+         SetServo(AIM_SERVO, Operand16());
+         break;
+      case RS_OP_TAPE:
+         PostTo(PostOrientation, UpdateTargetColor, Arg);
+         break;
+      case RS_OP_LANCE:
+         PostTo(PostLance, Deploy_Lance, 0);
+         break;
+      case RS_OP_STOP_AFTER:
+         ES_Timer_InitTimer(StopMoving_Timer, Operand16());
+         break;
+      case RS_OP_WAIT_TIME:
+         ES_Timer_InitTimer(Bot_Timer, Operand16());
+         Vars.WaitingFor = ES_TIMEOUT;
+         break;
+      case RS_OP_WAIT_EVENT:
+         Vars.WaitingFor = (ES_EventTyp_t)Arg;
+         break;
+      case RS_OP_SKIP_ALIGNED:
+         if(QueryIR_Detect() == Aligned)
+            Skip = Arg;
+         break;
+      case RS_OP_SKIP:
+         Skip = Arg;
+         break;
+      case RS_OP_HOME_BY:
+         Vars.HomeBy = Operand16();
+         if(GetMatchPhase() != MATCH_IDLE)
+         {
+            if(GetTimeRemaining() > Vars.HomeBy)
+               ES_Timer_InitTimer(StopMoving_Timer, 
+                                  GetTimeRemaining() - Vars.HomeBy);
+            else
+               ES_Timer_InitTimer(StopMoving_Timer, 1);
+         }
+         break;
+      case RS_OP_WAIT_UNTIL:
+         Deadline.EventType = MatchDeadline;
+         Deadline.EventParam = 0;
+         if(ScheduleBeforeEnd(Operand16(), PostBot, Deadline))
+            Vars.WaitingFor = MatchDeadline;
+         break;
+      case RS_OP_SKIP_NO_SHOOT:
+         if(!FitsBeforeEnd(EstimateShootTime(Vars.Script[Vars.PC + 2]), 
+                           Vars.HomeBy))
+            Skip = Arg;
+         break;
+      case RS_OP_SKIP_NO_RELOAD:
+         if(!FitsBeforeEnd(EstimateReloadTime(Vars.Script[Vars.PC + 2]), 
+                           Vars.HomeBy))
+            Skip = Arg;
+         break;
+   }
+   
+   Vars.PC += StepLength[Op];
+   //Skipped steps are stepped over by length, they are not run
+   while(Skip > 0 && Vars.Script[Vars.PC] != RS_OP_END && 
+         Vars.Script[Vars.PC] < NUM_RS_OPS)
+   {
+      Vars.PC += StepLength[Vars.Script[Vars.PC]];
+      Skip--;
+   }
+   return Vars.WaitingFor == ES_NO_EVENT;
+}
+
+/* Function: Operand16
+  ----------------------
+  16 bit operand of the step at PC.
+*/
+static unsigned int Operand16(void)
+{
+   return ((unsigned int)Vars.Script[Vars.PC + 1] << 8) | 
+          Vars.Script[Vars.PC + 2];
+}
+
+/* Function: PostTo
+  -------------------
+  Post a new event to a service.
+*/
+static void PostTo(pPostFunc Post, ES_EventTyp_t Type, uint16_t Param)
+{
+   ES_Event NewEvent;
+   
+   NewEvent.EventType = Type;
+   NewEvent.EventParam = Param;
+   Post(NewEvent);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
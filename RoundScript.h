@@ -0,0 +1,73 @@
+/****************************************************************************
+ 
+  Header file for the round script interpreter
+
+*****************************************************************************/
+
+#ifndef RoundScript_H
+#define RoundScript_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "Snapshot.h"
+#include "ES_Events.h"
+
+//Opcodes. Operands follow the opcode, 16 bit values high byte first
+#define RS_OP_END 0
+#define RS_OP_ALIGN 1         //freq16: start aligning on an IR frequency
+#define RS_OP_STOP_ALIGN 2    //park8: stop aligning, 1 parks the servo
+#define RS_OP_MOTORS_ON 3     //start the flywheels
+#define RS_OP_MOTORS_OFF 4    //stop the flywheels
+#define RS_OP_SHOOT 5         //n8: shoot n balls (0 for all)
+#define RS_OP_RELOAD 6        //n8: ask the depot for n balls
+#define RS_OP_DRIVE 7         //rpm8 (signed): drive straight
+#define RS_OP_AIM 8           //width16: aim servo pulse width (uS)
+#define RS_OP_TAPE 9          //color8: tape colour to drive home to
+#define RS_OP_LANCE 10        //deploy the lance
+#define RS_OP_STOP_AFTER 11   //ticks16: stop driving after this long
+#define RS_OP_WAIT_TIME 12    //ticks16: wait this long
+#define RS_OP_WAIT_EVENT 13   //event8: wait for an event posted to Bot
+#define RS_OP_SKIP_ALIGNED 14 //n8: skip n steps if already aligned
+#define RS_OP_SKIP 15         //n8: skip n steps
+#define RS_OP_HOME_BY 16      //ticks16: head home this long before the end
+#define RS_OP_WAIT_UNTIL 17   //ticks16: wait until this long before the end
+#define RS_OP_SKIP_NO_SHOOT 18  //n8 shots8: skip n steps if the burst 
+                                //would not be done before heading home
+#define RS_OP_SKIP_NO_RELOAD 19 //n8 balls8: same for a reload
+#define NUM_RS_OPS 20
+
+//Step encoders for building script tables
+#define RS_HI(x) (unsigned char)((unsigned int)(x) >> 8)
+#define RS_LO(x) (unsigned char)((unsigned int)(x) & 0xFF)
+
+#define RS_END()            RS_OP_END
+#define RS_ALIGN(f)         RS_OP_ALIGN, RS_HI(f), RS_LO(f)
+#define RS_STOP_ALIGN(h)    RS_OP_STOP_ALIGN, (h)
+#define RS_MOTORS_ON()      RS_OP_MOTORS_ON
+#define RS_MOTORS_OFF()     RS_OP_MOTORS_OFF
+#define RS_SHOOT(n)         RS_OP_SHOOT, (n)
+#define RS_RELOAD(n)        RS_OP_RELOAD, (n)
+#define RS_DRIVE(rpm)       RS_OP_DRIVE, (unsigned char)(rpm)
+#define RS_AIM(w)           RS_OP_AIM, RS_HI(w), RS_LO(w)
+#define RS_TAPE(c)          RS_OP_TAPE, (c)
+#define RS_LANCE()          RS_OP_LANCE
+#define RS_STOP_AFTER(t)    RS_OP_STOP_AFTER, RS_HI(t), RS_LO(t)
+#define RS_WAIT_TIME(t)     RS_OP_WAIT_TIME, RS_HI(t), RS_LO(t)
+#define RS_WAIT_EVENT(e)    RS_OP_WAIT_EVENT, (e)
+#define RS_SKIP_ALIGNED(n)  RS_OP_SKIP_ALIGNED, (n)
+#define RS_SKIP(n)          RS_OP_SKIP, (n)
+#define RS_HOME_BY(t)       RS_OP_HOME_BY, RS_HI(t), RS_LO(t)
+#define RS_WAIT_UNTIL(t)    RS_OP_WAIT_UNTIL, RS_HI(t), RS_LO(t)
+#define RS_SKIP_NO_SHOOT(n, s)  RS_OP_SKIP_NO_SHOOT, (n), (s)
+#define RS_SKIP_NO_RELOAD(n, b) RS_OP_SKIP_NO_RELOAD, (n), (b)
+
+// Public Function Prototypes
+void StartRoundScript(const unsigned char *Script);
+void StopRoundScript(void);
+bool RunRoundScript(ES_Event ThisEvent);
+bool IsRoundScriptDone(void);
+#ifdef SNAPSHOT
+StateBlock_t GetRoundScriptVars(void);
+#endif
+
+#endif /* RoundScript_H */
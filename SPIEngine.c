@@ -0,0 +1,204 @@
+/****************************************************************************
+ Module
+   SPIEngine.c
+
+ Revision
+   1.0.1
+
+ Description
+   Runs a whole SPI transaction (SS assert, N bytes out and in, SS release)
+   from a descriptor, one byte per SPI interrupt. The main loop only sees
+   the start request and a single SPIDone event once the response buffer
+   is complete.
+
+ Notes
+   SS is PS7 under manual control. Spacing between transactions (the JSR 
+   needs SS high for at least 2ms) is up to the requester.
+   At the JSR baud rate a 4 byte transaction takes about 200us.
+   With JSR_STANDIN defined the bytes are exchanged with the scripted JSR
+   stand-in instead of the SPI port, and the transaction completes at 
+   once.
+   In FAULT_INJECT builds each byte read passes through FaultSPIByte.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/26/14 10:20 PS      Running state gathered into Vars for snapshots
+ 04/25/14 14:10 PS      Bytes read pass through FaultSPIByte
+ 04/17/14 14:20 PS      JSR_STANDIN build option
+ 04/14/14 13:40 PS      First pass, replaces the byte per timeout JSR read
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "SPIEngine.h"
+#include "Fault.h"
+#ifdef JSR_STANDIN
+#include "JSRStandIn.h"
+#endif
+
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */
+#include <Bin_Const.h>
+#include "S12eVec.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define SS_ADDRESS DDRS
+#define SS_PORT PTS
+#define SS_PIN BIT7HI
+
+/*---------------------------- Module Functions ---------------------------*/
+void interrupt _Vec_spi SPIByte(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   const SPITransaction_t *Current;
+   volatile unsigned char ByteCount;
+   volatile bool Busy;
+   volatile bool Done;
+} SPIEngineVars_t;
+
+static SPIEngineVars_t Vars = {0, 0, false, false};
+
+/*------------------------------ Module Code ------------------------------*/
+/* Function: InitSPIEngine
+  --------------------------
+  SPI master, mode 3, manual SS, baud under the JSR's 1.43MHz limit. 
+  The SPI interrupt is only enabled while a transaction runs.
+*/
+void InitSPIEngine(void)
+{
+   SS_ADDRESS |= SS_PIN;
+   SS_PORT |= SS_PIN;
+   //Enable SPI, as Master, even rising edges, manual control for SS line 
+   SPICR1 = (_S12_SPE | _S12_MSTR | _S12_CPHA | _S12_CPOL);
+   SPICR2 &= (~_S12_MODFEN);  //Setting for manual control for SS line
+   //Set baud rate smaller than 1.43 MHz.
+   SPIBR = (_S12_SPPR2 |_S12_SPPR1 | _S12_SPPR0 | _S12_SPR1 |_S12_SPR0); 
+}
+
+/* Function: StartSPITransaction
+  --------------------------------
+  Assert SS and send the first byte. The descriptor and its buffers must
+  stay put until SPIDone. False if a transaction is already running.
+*/
+bool StartSPITransaction(const SPITransaction_t *Transaction)
+{
+   if(Vars.Busy || Transaction->NumBytes == 0 || 
+      Transaction->NumBytes > SPI_MAX_BYTES)
+      return false;
+   
+   Vars.Current = Transaction;
+   Vars.ByteCount = 0;
+   Vars.Done = false;
+   Vars.Busy = true;
+   
+#ifdef JSR_STANDIN
+   JSRStandInSelect();
+   for(Vars.ByteCount = 0; Vars.ByteCount < Transaction->NumBytes; 
+       Vars.ByteCount++)
+   {
+      Transaction->RxBuf[Vars.ByteCount] = 
+         JSRStandInByte(Transaction->TxBuf[Vars.ByteCount]);
+#ifdef FAULT_INJECT
+      Transaction->RxBuf[Vars.ByteCount] = 
+         FaultSPIByte(Transaction->RxBuf[Vars.ByteCount]);
+#endif
+   }
+   JSRStandInRelease();
+   Vars.Done = true;
+#else
+   if(SPISR & _S12_SPIF)
+      (void)SPIDR;     //clear a stale flag
+   SS_PORT &= ~SS_PIN;
+   SPIDR = Transaction->TxBuf[0];
+   SPICR1 |= _S12_SPIE;
+   EnableInterrupts;
+#endif
+   return true;
+}
+
+/* Function: IsSPIBusy
+  ----------------------
+  True from the start of a transaction until its SPIDone is posted.
+*/
+bool IsSPIBusy(void)
+{
+   return Vars.Busy;
+}
+
+/****************************************************************************
+Function: CheckSPI
+------------------------------
+Event checker that posts SPIDone to the requester once the interrupt has
+finished a transaction.
+*/
+bool CheckSPI(void)
+{
+   ES_Event NewEvent;
+   
+   if(Vars.Done)
+   {
+      Vars.Done = false;
+      Vars.Busy = false;
+      if(Vars.Current->Requester != 0)
+      {
+         NewEvent.EventType = SPIDone;
+         NewEvent.EventParam = Vars.Current->NumBytes;
+         Vars.Current->Requester(NewEvent);
+      }
+      return true;
+   }
+   return false;
+}
+
+#ifdef SNAPSHOT
+/* Function: GetSPIEngineVars
+  ----------------------------
+  Where this module's running state lives, for Snapshot.c.
+*/
+StateBlock_t GetSPIEngineVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/***************************************************************************
+ Interrupt Response
+   SPIByte
+
+ Description
+   A byte has been shifted in. Save it and send the next one, or release
+   SS after the last.
+****************************************************************************/
+void interrupt _Vec_spi SPIByte(void)
+{
+   unsigned char Status = SPISR;  //first half of clearing SPIF
+   
+   (void)Status;
+   Vars.Current->RxBuf[Vars.ByteCount] = SPIDR;
+#ifdef FAULT_INJECT
+   Vars.Current->RxBuf[Vars.ByteCount] = 
+      FaultSPIByte(Vars.Current->RxBuf[Vars.ByteCount]);
+#endif
+   Vars.ByteCount++;
+   if(Vars.ByteCount < Vars.Current->NumBytes)
+   {
+      SPIDR = Vars.Current->TxBuf[Vars.ByteCount];
+   }
+   else
+   {
+      SS_PORT |= SS_PIN;
+      SPICR1 &= ~_S12_SPIE;
+      Vars.Done = true;
+   }
+} /* End Interrupt SPIByte */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,37 @@
+/****************************************************************************
+ 
+  Header file for the interrupt driven SPI transaction engine
+
+*****************************************************************************/
+
+#ifndef SPIEngine_H
+#define SPIEngine_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "Snapshot.h"
+#include "ES_Events.h"
+
+#define SPI_MAX_BYTES 8
+
+//One transaction: SS asserted, NumBytes shifted out of TxBuf while the
+//same number are shifted into RxBuf, SS released. Requester gets SPIDone
+//with NumBytes as the param once RxBuf is complete
+typedef struct
+{
+   const unsigned char *TxBuf;
+   unsigned char *RxBuf;
+   unsigned char NumBytes;
+   pPostFunc Requester;
+} SPITransaction_t;
+
+// Public Function Prototypes
+void InitSPIEngine(void);
+bool StartSPITransaction(const SPITransaction_t *Transaction);
+bool IsSPIBusy(void);
+bool CheckSPI(void);
+#ifdef SNAPSHOT
+StateBlock_t GetSPIEngineVars(void);
+#endif
+
+#endif /* SPIEngine_H */
@@ -0,0 +1,101 @@
+/****************************************************************************
+ Module
+   Sensors.c
+
+ Revision
+   1.0.1
+
+ Description
+   Single point where the event checkers read the analog sensors: the two
+   IR detectors, the tape sensor and the drive pack. Checkers ask for a 
+   sensor by name instead of an A/D pin, so the pin map lives in one 
+   place.
+
+ Notes
+   Built with SENSOR_SEAM defined, SetSensorSource replaces the A/D reads
+   with any other source of readings (a simulated arena, recorded runs)
+   while the checkers themselves stay unchanged. Without it ReadSensor is
+   a table lookup and one A/D read.
+   In FAULT_INJECT builds every reading, from either source, passes 
+   through FaultSensor.
+   In SENSOR_RECORD builds every A/D reading is also kept by the recorder
+   (Recorder.c).
+   The A/D is set up by InitOrientation.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/27/14 11:00 PS      Drive pack divider on pin 7
+ 04/26/14 15:30 PS      A/D readings handed to the recorder
+ 04/25/14 14:10 PS      Readings pass through FaultSensor
+ 04/24/14 15:40 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "Sensors.h"
+#include "Fault.h"
+#include "Recorder.h"
+#include "ADS12.h"
+
+/*---------------------------- Module Variables ---------------------------*/
+//A/D pin of each sensor
+static const unsigned char SensorPin[NUM_SENSORS] =
+{
+   0,   //SENSOR_IR_LEFT
+   1,   //SENSOR_IR_RIGHT
+   6,   //SENSOR_TAPE
+   7    //SENSOR_BATTERY
+};
+
+#ifdef SENSOR_SEAM
+static pSensorRead Source = 0;
+#endif
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ReadSensor
+
+ Parameters
+   unsigned char : SENSOR_ name of the sensor
+
+ Returns
+   short, the 10 bit reading
+****************************************************************************/
+short ReadSensor(unsigned char Sensor)
+{
+   short Reading;
+   
+#ifdef SENSOR_SEAM
+   if(Source != 0)
+      Reading = Source(Sensor);
+   else
+#endif
+   {
+      Reading = ADS12_ReadADPin(SensorPin[Sensor]);
+#ifdef SENSOR_RECORD
+      RecordSensor(Sensor, Reading);
+#endif
+   }
+#ifdef FAULT_INJECT
+   Reading = FaultSensor(Sensor, Reading);
+#endif
+   return Reading;
+}
+
+#ifdef SENSOR_SEAM
+/****************************************************************************
+ Function
+   SetSensorSource
+
+ Parameters
+   pSensorRead : function giving readings in place of the A/D, 0 to go
+                 back to the A/D
+****************************************************************************/
+void SetSensorSource(pSensorRead NewSource)
+{
+   Source = NewSource;
+}
+#endif
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,27 @@
+/****************************************************************************
+ 
+  Header file for the analog sensor access seam
+
+*****************************************************************************/
+
+#ifndef Sensors_H
+#define Sensors_H
+
+#include "ES_Types.h"
+
+//Analog sensors read by the event checkers
+#define SENSOR_IR_LEFT 0
+#define SENSOR_IR_RIGHT 1
+#define SENSOR_TAPE 2
+#define SENSOR_BATTERY 3
+#define NUM_SENSORS 4
+
+typedef short (*pSensorRead)(unsigned char Sensor);
+
+// Public Function Prototypes
+short ReadSensor(unsigned char Sensor);
+#ifdef SENSOR_SEAM
+void SetSensorSource(pSensorRead Source);
+#endif
+
+#endif /* Sensors_H */
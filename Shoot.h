@@ -1,21 +1,26 @@
-/****************************************************************************
- 
-  Header file for serive for shooting foam balls
-  based on the Gen 2 Events and Services Framework
-
- ****************************************************************************/
-
-#ifndef Shoot_H
-#define Shoot_H
-
-#include "ES_Types.h"
-
-// Public Function Prototypes
-
-bool InitShoot ( uint8_t Priority );
-bool PostShoot( ES_Event ThisEvent );
-ES_Event RunShoot( ES_Event ThisEvent );
-
-
-#endif /* Shoot_H */
-
+/****************************************************************************
+ 
+  Header file for serive for shooting foam balls
+  based on the Gen 2 Events and Services Framework
+
+ ****************************************************************************/
+
+#ifndef Shoot_H
+#define Shoot_H
+
+#include "ES_Types.h"
+#include "Snapshot.h"
+
+// Public Function Prototypes
+
+bool InitShoot ( uint8_t Priority );
+bool PostShoot( ES_Event ThisEvent );
+ES_Event RunShoot( ES_Event ThisEvent );
+unsigned int EstimateShootTime(unsigned char Shots);
+#ifdef SNAPSHOT
+StateBlock_t GetShootVars(void);
+#endif
+
+
+#endif /* Shoot_H */
+
@@ -0,0 +1,166 @@
+/****************************************************************************
+ Module
+   Snapshot.c
+
+ Revision
+   1.0.1
+
+ Description
+   Saves the running state of every module into one buffer and puts it
+   back, so a run can be stopped at any point and carried on later from 
+   that point, as many times as wanted.
+
+ Notes
+   Each module keeps everything that changes while running in a single
+   Vars struct and hands out where it is with its Get...Vars function.
+   Configuration that is only set once (service priorities, fault rates,
+   the sensor source) and const tables are not part of a snapshot.
+   The framework's own queues and timers and the hardware registers are
+   not in a snapshot, see Snapshot.h; host/HostSnapshot.c adds them in
+   the host build.
+   A snapshot holds pointers into code and const data (scripts, post
+   functions), so it can only be restored into the same build. Save and
+   restore run with interrupts off, so the blocks written by interrupt 
+   responses (encoder counts, tach periods, SPI bytes, waveform edges) 
+   are consistent with the rest.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 19:00 PS      Points to the host snapshot of queues, timers and
+                        registers
+ 04/28/14 11:00 PS      Sensor recorder state
+ 04/28/14 10:40 PS      Save/restore with interrupts off, limits spelled out
+ 04/27/14 11:00 PS      Battery monitor state
+ 04/26/14 10:20 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Port.h"
+#include "Snapshot.h"
+
+#ifdef SNAPSHOT
+#include "Bot.h"
+#include "DCMotor.h"
+#include "IR_Detect.h"
+#include "IRemitter.h"
+#include "JSRcommand.h"
+#include "LanceFSM.h"
+#include "MatchClock.h"
+#include "Orientation.h"
+#include "RoundScript.h"
+#include "Shoot.h"
+#include "Ramp.h"
+#include "Waveform.h"
+#include "SPIEngine.h"
+#include "Battery.h"
+#ifdef JSR_STANDIN
+#include "JSRStandIn.h"
+#endif
+#ifdef FAULT_INJECT
+#include "Fault.h"
+#endif
+#ifdef SENSOR_RECORD
+#include "Recorder.h"
+#endif
+
+#include <string.h>
+#include <hidef.h>
+
+/*----------------------------- Module Defines ----------------------------*/
+typedef StateBlock_t (*pGetVars)(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Every module with running state, in the order they are laid out in the
+//buffer
+static const pGetVars Modules[] = 
+{
+   GetBotVars,
+   GetRoundScriptVars,
+   GetMatchClockVars,
+   GetDCMotorVars,
+   GetIR_DetectVars,
+   GetIRemitterVars,
+   GetJSRcommandVars,
+   GetLanceVars,
+   GetOrientationVars,
+   GetShootVars,
+   GetRampVars,
+   GetWaveformVars,
+   GetSPIEngineVars,
+   GetBatteryVars,
+#ifdef JSR_STANDIN
+   GetJSRStandInVars,
+#endif
+#ifdef FAULT_INJECT
+   GetFaultVars,
+#endif
+#ifdef SENSOR_RECORD
+   GetRecorderVars,
+#endif
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   SnapshotSize
+
+ Returns
+   unsigned int, bytes needed by SaveSnapshot
+****************************************************************************/
+unsigned int SnapshotSize(void)
+{
+   unsigned int Size = 0;
+   unsigned char i;
+   
+   for(i = 0; i < ARRAY_SIZE(Modules); i++)
+      Size += Modules[i]().Size;
+   return Size;
+}
+
+/****************************************************************************
+ Function
+   SaveSnapshot
+
+ Parameters
+   unsigned char* : at least SnapshotSize bytes
+****************************************************************************/
+void SaveSnapshot(unsigned char *Buf)
+{
+   StateBlock_t Block;
+   unsigned char i;
+   
+   EnterCritical();
+   for(i = 0; i < ARRAY_SIZE(Modules); i++)
+   {
+      Block = Modules[i]();
+      memcpy(Buf, Block.Data, Block.Size);
+      Buf += Block.Size;
+   }
+   ExitCritical();
+}
+
+/****************************************************************************
+ Function
+   RestoreSnapshot
+
+ Parameters
+   unsigned char* : a buffer filled by SaveSnapshot in this build
+****************************************************************************/
+void RestoreSnapshot(const unsigned char *Buf)
+{
+   StateBlock_t Block;
+   unsigned char i;
+   
+   EnterCritical();
+   for(i = 0; i < ARRAY_SIZE(Modules); i++)
+   {
+      Block = Modules[i]();
+      memcpy(Block.Data, Buf, Block.Size);
+      Buf += Block.Size;
+   }
+   ExitCritical();
+}
+#endif
+/*------------------------------ End of file ------------------------------*/
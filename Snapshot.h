@@ -0,0 +1,36 @@
+/****************************************************************************
+ 
+  Header file for saving and restoring the state of every module 
+  (SNAPSHOT builds only)
+
+*****************************************************************************/
+
+#ifndef Snapshot_H
+#define Snapshot_H
+
+#include "ES_Types.h"
+
+//Where one module keeps its running state, as handed out by the module's
+//Get...Vars function.
+//A snapshot only covers these Vars blocks. Not in it, and so up to the 
+//caller to save alongside or set up again after a restore:
+// - the framework's event queues and ES timers, which live in the 
+//   framework sources (deferral queues are in the services' Vars)
+// - hardware state: PWM duties and enables, timer compare/capture 
+//   registers, port outputs and the free running counters
+//On the target nothing saves those. The host build does, in 
+//host/HostSnapshot.c, from its framework stand-in and register emulation.
+typedef struct
+{
+   void *Data;
+   unsigned int Size;
+} StateBlock_t;
+
+#ifdef SNAPSHOT
+// Public Function Prototypes
+unsigned int SnapshotSize(void);
+void SaveSnapshot(unsigned char *Buf);
+void RestoreSnapshot(const unsigned char *Buf);
+#endif
+
+#endif /* Snapshot_H */
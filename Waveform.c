@@ -0,0 +1,445 @@
+/****************************************************************************
+ Module
+   Waveform.c
+
+ Revision
+   1.0.1
+
+ Description
+   Plays back a waveform described by a const table of (level, duration)
+   segments, repeated a number of times, on a TIM0 output compare pin.
+   Every edge is made by the output compare hardware at its exact count,
+   the interrupt only arms the following edge, so edge times follow the 
+   table to the timer tick regardless of interrupt latency.
+   When a waveform has played out the requester is posted a WaveformDone
+   event with the channel as the param.
+   A pulse train, one high segment and one low segment repeated (the
+   depot request), is played on PT6 by the timer alone. While it plays,
+   OC7 resets the counter at the end of every period (TCRE) and ends the
+   pulse through OC7M, OC6 starts the next one, and OC7 toggles PT7 into
+   the pulse accumulator, which overflows at the end of the last pulse.
+   That overflow is the only interrupt of the whole train.
+
+ Notes
+   TIM0 runs free at /16 (1.5MHz), so one segment can last at most 65535
+   counts (~43ms) and must be longer than the interrupt latency (keep it 
+   above ~50 counts).
+   The channels are rows of WaveHardware, which holds every register and
+   bit a channel touches; TIM0 ch6 and ch7 (PT6, PT7) are the ones in use.
+   The wheel encoders on ch4/5 only count edges and do not care about the
+   prescale, or the counter reset while a pulse train plays.
+   A pulse train has TIM0's counter to itself: PT7 will not start while
+   one plays, and a train asked for while PT7 plays is played edge by
+   edge instead. Its pulses keep to the counter's period, so the first
+   starts up to one period (or one count wrap) after the request, and it
+   is done at the end of its last pulse, the low after that being the
+   idle level anyway. If the counter is within WAVE_LEAD counts of either
+   compare when the train is asked for, it is armed on a later pass of
+   CheckWaveform instead, so no compare can fall part way through arming.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 23:00 PS      Pulse trains played by the timer and counted by
+                        the pulse accumulator, one interrupt at the end
+ 04/28/14 12:00 PS      Channel hardware gathered in one table
+ 04/26/14 10:20 PS      Running state gathered into Vars for snapshots
+ 04/13/14 16:00 PS      First pass, replaces the fixed IR pulse ISRs
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Port.h"
+#include "Waveform.h"
+
+#include <hidef.h>
+#include <mc9s12e128.h>     /* derivative information for the E128 */
+#include <S12E128bits.h>    /* bit definitions for the E128 */
+#include <Bin_Const.h>
+#include "S12eVec.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+//Counts from a start request to the first edge
+#define WAVE_LEAD 100
+
+//Output compare pin actions, besides WAVE_HIGH and WAVE_LOW
+#define OC_OFF 2
+#define OC_TOGGLE 3
+
+//Pulse trains play on PT6, with PT7 clocking the pulse accumulator
+#define TRAIN_CHANNEL WAVE_PT6
+#define COUNT_CHANNEL WAVE_PT7
+
+//Registers and bits of one output compare channel
+typedef struct
+{
+   volatile unsigned int *Compare;    //TCn
+   volatile unsigned char *Control;   //TCTL1 (ch4-7) or TCTL2 (ch0-3)
+   unsigned char Select;              //IOSn
+   unsigned char Mode;                //OMn
+   unsigned char Level;               //OLn
+   unsigned char Flag;                //CnF
+   unsigned char Int;                 //CnI
+   unsigned char Pin;                 //PTT bit
+} WaveHardware_t;
+
+typedef struct
+{
+   const Waveform_t *Wave;
+   pPostFunc Requester;
+   unsigned char Seg;
+   unsigned char RepeatsLeft;
+   bool Ending;
+   bool Train;                        //played by the timer alone
+   bool Pending;                      //train still to be armed
+   bool Active;
+   volatile bool Done;
+} WaveChannel_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void SetAction(unsigned char Channel, unsigned char Action);
+static void NextEdge(unsigned char Channel);
+static bool IsPulseTrain(const Waveform_t *Wave);
+static bool ArmTrain(void);
+static void StopTrain(void);
+void interrupt _Vec_tim0ch6 WavePT6(void);
+void interrupt _Vec_tim0ch7 WavePT7(void);
+void interrupt _Vec_tim0paovf WaveTrainEnd(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place for Snapshot.c
+typedef struct
+{
+   WaveChannel_t Waves[NUM_WAVE_CHANNELS];
+} WaveformVars_t;
+
+static WaveformVars_t Vars;
+
+//Per channel hardware, in WAVE_ channel order
+static const WaveHardware_t WaveHardware[NUM_WAVE_CHANNELS] = 
+{
+   {&TIM0_TC6, &TIM0_TCTL1, _S12_IOS6, _S12_OM6, _S12_OL6, _S12_C6F, 
+    _S12_C6I, BIT6HI},   //WAVE_PT6
+   {&TIM0_TC7, &TIM0_TCTL1, _S12_IOS7, _S12_OM7, _S12_OL7, _S12_C7F, 
+    _S12_C7I, BIT7HI}    //WAVE_PT7
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/* Function: InitWaveform
+  -------------------------
+  TIM0 free running at /16 with every channel as output compare, pins 
+  low and disconnected.
+*/
+void InitWaveform(void)
+{
+   unsigned char i;
+   
+   TIM0_TSCR1 = _S12_TEN;   //Enable
+   TIM0_TSCR2 = _S12_PR2;   //Set Prescale to /16
+   
+   for(i = 0; i < NUM_WAVE_CHANNELS; i++)
+   {
+      TIM0_TIOS |= WaveHardware[i].Select;
+      DDRT |= WaveHardware[i].Pin;
+      PTT &= ~WaveHardware[i].Pin;
+      SetAction(i, OC_OFF);
+      TIM0_TIE &= ~WaveHardware[i].Int;
+      Vars.Waves[i].Train = false;
+      Vars.Waves[i].Pending = false;
+      Vars.Waves[i].Active = false;
+      Vars.Waves[i].Done = false;
+   }
+   TIM0_OC7M = 0;
+   TIM0_PACTL = 0;
+}
+
+/* Function: StartWaveform
+  --------------------------
+  Start playing Wave on a channel. False if the channel is still busy, or
+  is PT7 while a pulse train plays.
+*/
+bool StartWaveform(unsigned char Channel, const Waveform_t *Wave, 
+                   pPostFunc Requester)
+{
+   WaveChannel_t *ThisWave = &Vars.Waves[Channel];
+   
+   if(ThisWave->Active || Wave->NumSegments == 0)
+      return false;
+   if(Channel == COUNT_CHANNEL && Vars.Waves[TRAIN_CHANNEL].Train)
+      return false;
+   
+   ThisWave->Wave = Wave;
+   ThisWave->Requester = Requester;
+   ThisWave->Seg = 0;
+   ThisWave->RepeatsLeft = (Wave->Repeat == 0) ? 1 : Wave->Repeat;
+   ThisWave->Ending = false;
+   ThisWave->Done = false;
+   ThisWave->Active = true;
+   
+   ThisWave->Train = (Channel == TRAIN_CHANNEL && IsPulseTrain(Wave) &&
+                      !Vars.Waves[COUNT_CHANNEL].Active);
+   if(ThisWave->Train)
+   {
+      ThisWave->Pending = !ArmTrain();
+      return true;
+   }
+   
+   EnterCritical();
+   SetAction(Channel, Wave->Segments[0].Level);
+   *WaveHardware[Channel].Compare = TIM0_TCNT + WAVE_LEAD;
+   TIM0_TFLG1 = WaveHardware[Channel].Flag;
+   TIM0_TIE |= WaveHardware[Channel].Int;
+   ExitCritical();
+   return true;
+}
+
+/* Function: StopWaveform
+  -------------------------
+  Abandon a waveform and drive the pin low. No event is posted.
+*/
+void StopWaveform(unsigned char Channel)
+{
+   EnterCritical();
+   if(Vars.Waves[Channel].Train)
+      StopTrain();
+   TIM0_TIE &= ~WaveHardware[Channel].Int;
+   SetAction(Channel, OC_OFF);
+   Vars.Waves[Channel].Active = false;
+   Vars.Waves[Channel].Done = false;
+   ExitCritical();
+}
+
+/* Function: IsWaveformBusy
+  ---------------------------
+  True while a waveform is playing on the channel.
+*/
+bool IsWaveformBusy(unsigned char Channel)
+{
+   return Vars.Waves[Channel].Active;
+}
+
+/****************************************************************************
+Function: CheckWaveform
+------------------------------
+Event checker that tells each requester its waveform has finished, and
+arms a pulse train that could not be armed when it was asked for.
+*/
+bool CheckWaveform(void)
+{
+   ES_Event NewEvent;
+   unsigned char i;
+   bool ReturnVal = false;
+   
+   if(Vars.Waves[TRAIN_CHANNEL].Pending)
+      Vars.Waves[TRAIN_CHANNEL].Pending = !ArmTrain();
+   
+   for(i = 0; i < NUM_WAVE_CHANNELS; i++)
+   {
+      if(Vars.Waves[i].Done)
+      {
+         Vars.Waves[i].Done = false;
+         if(Vars.Waves[i].Requester != 0)
+         {
+            NewEvent.EventType = WaveformDone;
+            NewEvent.EventParam = i;
+            Vars.Waves[i].Requester(NewEvent);
+         }
+         ReturnVal = true;
+      }
+   }
+   return ReturnVal;
+}
+
+#ifdef SNAPSHOT
+/* Function: GetWaveformVars
+  ---------------------------
+  Where this module's running state lives, for Snapshot.c.
+*/
+StateBlock_t GetWaveformVars(void)
+{
+   StateBlock_t Block;
+   
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+#endif
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: SetAction
+  ----------------------
+  Program what the pin does at the next compare: go high, go low, toggle,
+  or nothing (pin back under port control).
+*/
+static void SetAction(unsigned char Channel, unsigned char Action)
+{
+   const WaveHardware_t *Hw = &WaveHardware[Channel];
+   
+   if(Action == WAVE_HIGH)
+      *Hw->Control |= (Hw->Mode | Hw->Level);
+   else if(Action == WAVE_LOW)
+      *Hw->Control = (*Hw->Control & ~Hw->Level) | Hw->Mode;
+   else if(Action == OC_TOGGLE)
+      *Hw->Control = (*Hw->Control & ~Hw->Mode) | Hw->Level;
+   else
+      *Hw->Control &= ~(Hw->Mode | Hw->Level);
+}
+
+/* Function: NextEdge
+  ---------------------
+  Called on the compare that started segment Seg. Schedule the edge that
+  ends it, with the level of the segment that follows, or the final edge
+  low once the last repeat is done. The compare after that ends the 
+  waveform.
+*/
+static void NextEdge(unsigned char Channel)
+{
+   WaveChannel_t *ThisWave = &Vars.Waves[Channel];
+   
+   TIM0_TFLG1 = WaveHardware[Channel].Flag;
+   if(ThisWave->Ending)
+   {
+      TIM0_TIE &= ~WaveHardware[Channel].Int;
+      SetAction(Channel, OC_OFF);
+      ThisWave->Active = false;
+      ThisWave->Done = true;
+      return;
+   }
+   
+   *WaveHardware[Channel].Compare += 
+      ThisWave->Wave->Segments[ThisWave->Seg].Duration;
+   ThisWave->Seg++;
+   if(ThisWave->Seg >= ThisWave->Wave->NumSegments)
+   {
+      ThisWave->Seg = 0;
+      ThisWave->RepeatsLeft--;
+      if(ThisWave->RepeatsLeft == 0)
+      {
+         ThisWave->Ending = true;
+         SetAction(Channel, WAVE_LOW);
+         return;
+      }
+   }
+   SetAction(Channel, ThisWave->Wave->Segments[ThisWave->Seg].Level);
+}
+
+/* Function: IsPulseTrain
+  -------------------------
+  One high segment then one low one, together no longer than the 16 bit
+  counter, each long enough to arm around.
+*/
+static bool IsPulseTrain(const Waveform_t *Wave)
+{
+   return Wave->NumSegments == 2 &&
+          Wave->Segments[0].Level == WAVE_HIGH &&
+          Wave->Segments[1].Level == WAVE_LOW &&
+          Wave->Segments[0].Duration >= WAVE_LEAD &&
+          Wave->Segments[1].Duration >= WAVE_LEAD &&
+          (unsigned long)Wave->Segments[0].Duration +
+             Wave->Segments[1].Duration <= 0x10000UL;
+}
+
+/* Function: ArmTrain
+  ---------------------
+  Set TIM0 up to play the train on PT6 by itself. The counter is reset
+  at Top, one period on from the last reset, which ends a pulse; OC6
+  starts the next one at Rise. Each period end also toggles PT7, and the
+  pulse accumulator is loaded to overflow at the period end that
+  finishes the last pulse. That is one period end a pulse, plus one if
+  the counter is between Rise and Top now, as the first period end then
+  comes before the first pulse. The accumulator counts one edge in two,
+  rising or falling, whichever PT7 makes at that last period end given
+  the level it starts from.
+  False, with nothing touched, if the counter is too close to Rise or Top
+  to be sure which side of it the arming falls.
+*/
+static bool ArmTrain(void)
+{
+   WaveChannel_t *ThisWave = &Vars.Waves[TRAIN_CHANNEL];
+   unsigned int High = ThisWave->Wave->Segments[0].Duration;
+   unsigned int Top = High + ThisWave->Wave->Segments[1].Duration - 1;
+   unsigned int Rise = Top - High;
+   unsigned int Count, ToRise, ToTop, Ends;
+   bool EndsHigh;
+   
+   EnterCritical();
+   Count = TIM0_TCNT;
+   ToRise = (Rise - Count) & 0xFFFFu;
+   ToTop = (Top - Count) & 0xFFFFu;
+   if(ToRise < WAVE_LEAD || ToTop < WAVE_LEAD)
+   {
+      ExitCritical();
+      return false;
+   }
+   Ends = ThisWave->RepeatsLeft + ((ToRise > ToTop) ? 1 : 0);
+   
+   TIM0_TC7 = Top;
+   TIM0_TC6 = Rise;
+   SetAction(COUNT_CHANNEL, OC_TOGGLE);
+   EndsHigh = ((PTIT & WaveHardware[COUNT_CHANNEL].Pin) == 0) ==
+              (Ends % 2 == 1);
+   TIM0_PACNT = (unsigned int)(0x10000UL - (Ends + 1) / 2);
+   TIM0_PAFLG = _S12_PAOVF;
+   TIM0_PACTL = _S12_PAEN | _S12_PAOVI |  //event count
+                (EndsHigh ? _S12_PEDGE : 0);
+   
+   TIM0_OC7D &= ~_S12_OC7D6;              //period end clears PT6
+   TIM0_OC7M |= _S12_OC7M6;
+   SetAction(TRAIN_CHANNEL, WAVE_HIGH);
+   TIM0_TSCR2 |= _S12_TCRE;
+   ExitCritical();
+   return true;
+}
+
+/* Function: StopTrain
+  ----------------------
+  Hand TIM0 back: counter free running, PT6 and PT7 off the timer and the
+  pulse accumulator off.
+*/
+static void StopTrain(void)
+{
+   TIM0_PACTL = 0;
+   TIM0_TSCR2 &= ~_S12_TCRE;
+   TIM0_OC7M &= ~_S12_OC7M6;
+   SetAction(COUNT_CHANNEL, OC_OFF);
+   SetAction(TRAIN_CHANNEL, OC_OFF);
+   Vars.Waves[TRAIN_CHANNEL].Train = false;
+   Vars.Waves[TRAIN_CHANNEL].Pending = false;
+}
+
+/***************************************************************************
+ Interrupt Responses
+   WavePT6, WavePT7
+
+ Description
+   Output compare on each waveform channel. A channel added to 
+   WaveHardware needs its own response here.
+****************************************************************************/
+void interrupt _Vec_tim0ch6 WavePT6(void)
+{
+   NextEdge(WAVE_PT6);
+}
+
+void interrupt _Vec_tim0ch7 WavePT7(void)
+{
+   NextEdge(WAVE_PT7);
+}
+
+/***************************************************************************
+ Interrupt Response
+   WaveTrainEnd
+
+ Description
+   Pulse accumulator overflow, at the end of the last pulse of a train.
+   The next pulse would start a low segment later, so there is time to
+   stop it here.
+****************************************************************************/
+void interrupt _Vec_tim0paovf WaveTrainEnd(void)
+{
+   TIM0_PAFLG = _S12_PAOVF;
+   StopTrain();
+   Vars.Waves[TRAIN_CHANNEL].Active = false;
+   Vars.Waves[TRAIN_CHANNEL].Done = true;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,56 @@
+/****************************************************************************
+ 
+  Header file for the table driven output compare waveform generator
+
+*****************************************************************************/
+
+#ifndef Waveform_H
+#define Waveform_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "Snapshot.h"
+#include "ES_Events.h"
+
+//Output compare channels the generator can drive, index into the channel
+//table in Waveform.c. Any free TIM0 output compare channel (ch0-3, ch6, 
+//ch7) can be added there with its own interrupt response; all channels
+//share TIM0 at 1.5MHz. Only PT6 and PT7 are wired up, and PT7 counts the
+//pulses while a pulse train plays on PT6 (Waveform.c).
+#define WAVE_PT6 0
+#define WAVE_PT7 1
+#define NUM_WAVE_CHANNELS 2
+
+//Timer counts per ms on TIM0
+#define WAVE_COUNTS_PER_MS 1500
+
+#define WAVE_LOW 0
+#define WAVE_HIGH 1
+
+//One segment holds the pin at Level for Duration timer counts
+typedef struct
+{
+   unsigned char Level;
+   unsigned int Duration;
+} WaveSegment_t;
+
+//A waveform plays its segments in order, Repeat times, then idles low
+typedef struct
+{
+   const WaveSegment_t *Segments;
+   unsigned char NumSegments;
+   unsigned char Repeat;
+} Waveform_t;
+
+// Public Function Prototypes
+void InitWaveform(void);
+bool StartWaveform(unsigned char Channel, const Waveform_t *Wave, 
+                   pPostFunc Requester);
+void StopWaveform(unsigned char Channel);
+bool IsWaveformBusy(unsigned char Channel);
+bool CheckWaveform(void);
+#ifdef SNAPSHOT
+StateBlock_t GetWaveformVars(void);
+#endif
+
+#endif /* Waveform_H */
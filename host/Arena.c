@@ -0,0 +1,1018 @@
+/****************************************************************************
+ Module
+   Arena.c
+
+ Revision
+   1.0.1
+
+ Description
+   The joust field around the firmware on the host. Our knight is only
+   seen through the emulated hardware (HostHW.c): the drive PWM and
+   direction pins move it and send encoder edges back, the servo compares
+   turn the turret, push the feeder and drop the lance, the flywheel PWM
+   spins the wheels that send tach edges back, the IR LED on PT6 talks to
+   the re-supply depot and the A/D reads the IR detectors, the tape
+   sensor and the drive pack. The opponent runs its lane and scores by
+   chance. The referee runs the match as the JSR reports it: rounds,
+   recesses with the outer walls moving in, sudden death and the score.
+
+ Notes
+   x runs along the field from our Home A end (0) to Home B (96), y
+   across it; our half is y 48-96 behind the dividing wall, the
+   opponent's 0-48. Headings are CCW from +x. Distances in inches.
+   The turret points (590 - width)*180/910 degrees from the heading, so
+   590us looks ahead and 1500us about straight back over the right side.
+   The physics runs every 1ms. Encoder and tach edges that fall in the
+   coming 1ms are placed in it by interpolation, so their captured times
+   carry no 1ms jitter.
+   Every random draw comes from one generator seeded by ArenaInit, so a
+   seed replays a match exactly.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 22:00 PS      ArenaSetFeeder and dry pushes, for feed tests
+ 04/30/14 21:00 PS      ArenaPlace, for drive tests away from the walls
+ 04/30/14 19:00 PS      ArenaReseed and ArenaGetVars, to branch a match
+                        from a snapshot
+ 04/30/14 11:00 PS      ArenaCallPhase, for matches scripted by a JSR timeline
+ 04/29/14 13:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <mc9s12e128.h>
+#include "Arena.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define PI 3.14159265358979
+#define DEG (PI/180.0)
+#define STEP_MS 1.0
+#define DT (STEP_MS/1000.0)
+
+//Field
+#define FIELD_LENGTH 96.0
+#define MIDFIELD 48.0
+#define HOME_DEPTH 18.0
+#define DIVIDER 48.0          //y of the dividing wall
+#define OUTER_WALL 96.0       //y of our outer wall at the start
+#define WALL_STEP 15.0        //outer walls move in this much each recess
+#define TAPE_HALF_WIDTH 1.0
+#define GREEN_A HOME_DEPTH
+#define GREEN_B (FIELD_LENGTH - HOME_DEPTH)
+#define DEPOT_X 0.0
+#define DEPOT_Y 58.0
+#define GOAL_X FIELD_LENGTH   //opponent's goal, on their side of the end
+#define GOAL_Y 38.0
+#define GOAL_HALF_WIDTH 4.0
+
+//Match timing, seconds
+#define START_WAIT 2.0
+#define ROUND_TIME 30.0
+#define RECESS_MIN 10.0
+#define RECESS_MAX 12.0
+
+//Points
+#define HOME_POINTS 1
+#define GOAL_POINTS 2
+#define BALL_POINTS 2
+#define LANCE_POINTS 10
+#define UNHORSE_POINTS 25
+
+//Our knight
+#define BOT_RADIUS 6.0
+#define WHEELBASE 9.0
+#define TICKS_PER_INCH 12.0
+#define TOP_SPEED 30.0        //in/s at full duty on a nominal pack
+#define WHEEL_TAU 0.08
+#define DEADBAND 0.12         //duty the wheels need to move at all
+#define GAIN_SPREAD 0.03
+#define PACK_NOMINAL 820.0
+#define PACK_FLAT 780.0
+#define PACK_LIFE 150.0       //seconds to run down to PACK_FLAT
+#define TAPE_OFFSET 4.0       //tape sensor, right of centre
+#define RIGHT_DIR 0x80        //PTU
+#define LEFT_DIR 0x40
+#define RED_SWITCH 0x01       //PORTE
+
+//Servos: feeder, turret, lance
+#define NUM_SERVOS 3
+#define FEEDER 0
+#define TURRET 1
+#define LANCE 2
+#define SERVO_SLEW 2.5        //us of width per ms
+#define TURRET_AHEAD 590.0
+#define TURRET_SPAN 910.0
+#define FEED_WIDTH 950.0      //feeder far enough to put a ball in the wheels
+#define CLEAR_WIDTH 800.0
+#define BALL_DROP 80.0        //ms for the next ball to settle
+#define MAX_BALLS 5
+#define LANCE_DOWN 1000.0     //deployed at or below
+#define LANCE_REACH 22.0
+#define HEAD_RADIUS 5.0
+
+//Flywheels
+#define FLY_RPM_PER_DUTY 23000.0
+#define FLY_TAU 0.25
+#define SHOT_RPM 3000.0
+#define SHOT_RANGE 72.0       //at SHOT_RPM
+#define SHOT_SPREAD 2.0       //degrees
+
+//IR
+#define IR_GAIN 0.225         //reading per Hz
+#define IR_AMBIENT 40.0
+#define IR_NOISE 4.0
+#define IR_SQUINT 5.0         //degrees each detector is off the turret
+#define IR_HALF_ANGLE 9.0
+#define HEAD_FREQ 1250.0
+#define GOAL_FREQ 2083.0
+
+//Tape readings
+#define TAPE_WHITE 150.0
+#define TAPE_RED 290.0
+#define TAPE_GREEN 400.0
+#define TAPE_NOISE 6.0
+
+//Depot: 10 pulses of 10ms on, 30ms off, each within 0.1ms
+#define DEPOT_PULSES 10
+#define DEPOT_ON 10.0
+#define DEPOT_OFF 30.0
+#define DEPOT_TOL 0.1
+#define DEPOT_RANGE 40.0
+#define DEPOT_HALF_ANGLE 20.0
+
+//Opponent, by chance
+#define OPP_LANE 40.0
+#define OPP_LANE_SPREAD 4.0
+#define OPP_LANCE_CHANCE 0.35
+#define OPP_UNHORSE_CHANCE 0.10
+#define OPP_GOAL_CHANCE 0.30
+#define OUR_UNHORSE_CHANCE 0.15
+#define PASS_DISTANCE 6.0
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+   double X, Y;
+   double Speed;              //in/s along x, signed
+   double Delay;              //seconds into the round before it moves
+   double GoalTime;           //seconds into the round it scores, <0 never
+   bool Passed;
+} Opponent_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Physics(HostTime_t Now);
+static void Drive(HostTime_t Now);
+static void Flywheels(HostTime_t Now);
+static void Feeder(HostTime_t Now);
+static void Lance(void);
+static void Opponent(double InPhase);
+static void Referee(HostTime_t Now);
+static void StartPhase(ArenaPhase_t Phase, HostTime_t Now);
+static void EndRound(HostTime_t Now);
+static void Fire(void);
+static void Score(unsigned char Knight, unsigned char Points,
+                  const char *What);
+static void Edges(double From, double To, double PerEdge, unsigned char Timer,
+                  unsigned char Channel, HostTime_t Now);
+static bool InHome(double X, unsigned char Knight);
+static double TurretBearing(void);
+static double Wrap(double Angle);
+static short ReadAD(unsigned char Pin);
+static short ReadIR(double Squint);
+static short ReadTape(void);
+static void PinChange(unsigned char Timer, unsigned char Channel,
+                      unsigned char Level, HostTime_t When);
+static double Uniform(double Lo, double Hi);
+static double Gauss(double Sigma);
+static double Seconds(HostTime_t When);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place
+typedef struct
+{
+   ArenaStatus_t Status;
+   bool Verbose;
+   bool Scripted;             //phases called from outside
+   unsigned long long Random;
+
+   //Our knight
+   double Heading;            //radians
+   double VRight, VLeft;      //wheel speeds, in/s
+   double GainRight, GainLeft;
+   double RightTravel, LeftTravel;
+   double Servo[NUM_SERVOS];  //where the horns are, us
+   double FlyRPM[2];
+   double FlyRevs[2];
+   double Pack;
+   unsigned char Hopper;      //balls waiting behind the loaded one
+   bool Loaded;
+   bool Pushed;               //feeder at full stroke
+   double FeederSlew;         //us of width per ms
+   double FeederClear;        //width below which the next ball drops
+   HostTime_t DropStart;
+   bool LanceArmed;
+
+   Opponent_t Opp;
+   double Wall;               //our outer wall
+   double RecessLength;
+
+   //Depot
+   HostTime_t PulseRise;
+   HostTime_t PulseFall;
+   bool OffGood;
+   unsigned char Pulses;
+   HostTime_t Delivery;       //0 when none is coming
+} ArenaVars_t;
+
+static ArenaVars_t Vars;
+
+static const char * const PhaseNames[] =
+   {"wait", "round", "recess", "sudden death", "end"};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ArenaInit
+
+ Parameters
+   unsigned long : seed for every random draw of the match
+   bool : print referee calls and scoring as they happen
+
+ Description
+   Sets up the field and hooks it to the emulated hardware. Call after
+   ES_HostReset and before the firmware is initialized. Our knight starts
+   in its Home A facing down the field, loaded with five balls, as the
+   red knight.
+****************************************************************************/
+void ArenaInit(unsigned long Seed, bool Verbose)
+{
+   memset(&Vars, 0, sizeof(Vars));
+   Vars.Verbose = Verbose;
+   ArenaReseed(Seed);
+
+   Vars.Status.X = 10.0 + Uniform(-1.0, 1.0);
+   Vars.Status.Y = 56.0 + Uniform(-3.0, 3.0);
+   Vars.Heading = Uniform(-3.0, 3.0) * DEG;
+   Vars.GainRight = 1.0 + Uniform(-GAIN_SPREAD, GAIN_SPREAD);
+   Vars.GainLeft = 1.0 + Uniform(-GAIN_SPREAD, GAIN_SPREAD);
+   Vars.Pack = PACK_NOMINAL;
+   Vars.Loaded = true;
+   Vars.Hopper = MAX_BALLS - 1;
+   Vars.FeederSlew = SERVO_SLEW;
+   Vars.FeederClear = CLEAR_WIDTH;
+   Vars.Wall = OUTER_WALL;
+   memset(Vars.Status.HomeFirst, '-', sizeof(Vars.Status.HomeFirst));
+
+   Vars.Opp.X = FIELD_LENGTH - 10.0 + Uniform(-1.0, 1.0);
+   Vars.Opp.Y = OPP_LANE + Uniform(-OPP_LANE_SPREAD, OPP_LANE_SPREAD);
+
+   HostSetADSource(ReadAD);
+   HostSetPinHook(PinChange);
+   HostSetPortE(RED_SWITCH);
+   HostAddPeriodic(Physics, HOST_MS(STEP_MS));
+   StartPhase(ArenaWait, HostNow());
+}
+
+/****************************************************************************
+ Function
+   ArenaGetStatus
+
+ Returns
+   const ArenaStatus_t *, the referee's view and our pose
+****************************************************************************/
+const ArenaStatus_t *ArenaGetStatus(void)
+{
+   Vars.Status.Heading = Vars.Heading / DEG;
+   return &Vars.Status;
+}
+
+/****************************************************************************
+ Function
+   ArenaCallPhase
+
+ Parameters
+   ArenaPhase_t : phase the match is in from now
+
+ Description
+   For a scripted match: the referee takes its phases from here and stops
+   timing them itself. Scoring and the race home go on as usual, but no
+   longer end a round or the match.
+****************************************************************************/
+void ArenaCallPhase(ArenaPhase_t Phase)
+{
+   Vars.Scripted = true;
+   if(Phase != Vars.Status.Phase)
+      StartPhase(Phase, HostNow());
+}
+
+/****************************************************************************
+ Function
+   ArenaGetVars
+
+ Returns
+   StateBlock_t, where the field's running state lives
+****************************************************************************/
+StateBlock_t ArenaGetVars(void)
+{
+   StateBlock_t Block;
+
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+
+/****************************************************************************
+ Function
+   ArenaReseed
+
+ Parameters
+   unsigned long : seed for the random draws from here on
+
+ Description
+   Takes the match another way from the current point: the noise, the
+   opponent and the referee draw from the new seed. The field as it is
+   now does not change.
+****************************************************************************/
+void ArenaReseed(unsigned long Seed)
+{
+   unsigned char i;
+
+   Vars.Random = 0x9E3779B97F4A7C15ULL ^ ((unsigned long long)Seed << 1);
+   for(i = 0; i < 8; i++)
+      Uniform(0, 1);
+}
+
+/****************************************************************************
+ Function
+   ArenaPlace
+
+ Parameters
+   double : x, inches
+   double : y, inches
+   double : heading, degrees CCW from +x
+
+ Description
+   Puts our knight down at rest somewhere else on our side of the field,
+   with the wheels stopped. The gains, the pack and the match go on as
+   they are.
+****************************************************************************/
+void ArenaPlace(double X, double Y, double Heading)
+{
+   Vars.Status.X = X;
+   Vars.Status.Y = Y;
+   Vars.Heading = Wrap(Heading * DEG);
+   Vars.VRight = Vars.VLeft = 0;
+}
+
+/****************************************************************************
+ Function
+   ArenaSetFeeder
+
+ Parameters
+   double : feeder servo slew, us of width per ms
+   double : width the pusher must be back below for the next ball to drop
+
+ Description
+   A feeder other than the stock one (SERVO_SLEW, CLEAR_WIDTH), to see
+   how far off the firmware's model of it can be.
+****************************************************************************/
+void ArenaSetFeeder(double Slew, double ClearWidth)
+{
+   Vars.FeederSlew = Slew;
+   Vars.FeederClear = ClearWidth;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Physics
+  --------------------
+  Everything that moves, then the referee, every STEP_MS.
+*/
+static void Physics(HostTime_t Now)
+{
+   double Elapsed = Seconds(Now);
+   unsigned char i;
+   double Target, Slew;
+
+   Vars.Pack = PACK_NOMINAL - (PACK_NOMINAL - PACK_FLAT) * Elapsed / PACK_LIFE;
+   if(Vars.Pack < PACK_FLAT)
+      Vars.Pack = PACK_FLAT;
+
+   for(i = 0; i < NUM_SERVOS; i++)
+   {
+      Target = HostServoWidth(i);
+      if(Target == 0)
+         continue;
+      Slew = (i == FEEDER) ? Vars.FeederSlew : SERVO_SLEW;
+      if(Vars.Servo[i] == 0 || fabs(Target - Vars.Servo[i]) <= Slew)
+         Vars.Servo[i] = Target;
+      else
+         Vars.Servo[i] += (Target > Vars.Servo[i]) ? Slew : -Slew;
+   }
+
+   Drive(Now);
+   Flywheels(Now);
+   Feeder(Now);
+   Lance();
+   Referee(Now);
+}
+
+/* Function: Drive
+  ------------------
+  Wheel speeds from the PWM and direction pins, with a deadband, a first
+  order lag and a small gain mismatch. The left motor is mounted mirrored.
+  Walls stop the knight and stall its wheels. Encoder edges for the
+  coming step go to the capture pins.
+*/
+static void Drive(HostTime_t Now)
+{
+   double Scale = TOP_SPEED * Vars.Pack / PACK_NOMINAL;
+   double Duty, Target, Speed, Turn, X, Y;
+
+   Duty = HostPWMDuty(1);
+   Target = (Duty < DEADBAND) ? 0 : Duty * Scale * Vars.GainRight;
+   if(!(PTU & RIGHT_DIR))
+      Target = -Target;
+   Vars.VRight += (Target - Vars.VRight) * DT / WHEEL_TAU;
+
+   Duty = HostPWMDuty(5);
+   Target = (Duty < DEADBAND) ? 0 : Duty * Scale * Vars.GainLeft;
+   if(PTU & LEFT_DIR)
+      Target = -Target;
+   Vars.VLeft += (Target - Vars.VLeft) * DT / WHEEL_TAU;
+
+   Speed = (Vars.VRight + Vars.VLeft) / 2;
+   Turn = (Vars.VRight - Vars.VLeft) / WHEELBASE;
+   X = Vars.Status.X + Speed * cos(Vars.Heading) * DT;
+   Y = Vars.Status.Y + Speed * sin(Vars.Heading) * DT;
+   if(X < BOT_RADIUS || X > FIELD_LENGTH - BOT_RADIUS ||
+      Y < DIVIDER + BOT_RADIUS || Y > Vars.Wall - BOT_RADIUS)
+   {
+      Vars.VRight = Vars.VLeft = 0;
+      return;
+   }
+   Vars.Status.X = X;
+   Vars.Status.Y = Y;
+   Vars.Heading = Wrap(Vars.Heading + Turn * DT);
+   if(X - BOT_RADIUS > MIDFIELD)
+      Vars.Status.CrossedMidfield = true;
+
+   Edges(Vars.RightTravel, Vars.RightTravel + fabs(Vars.VRight) * DT,
+         1.0 / TICKS_PER_INCH, HOST_TIM0, 4, Now);
+   Vars.RightTravel += fabs(Vars.VRight) * DT;
+   Edges(Vars.LeftTravel, Vars.LeftTravel + fabs(Vars.VLeft) * DT,
+         1.0 / TICKS_PER_INCH, HOST_TIM0, 5, Now);
+   Vars.LeftTravel += fabs(Vars.VLeft) * DT;
+}
+
+/* Function: Flywheels
+  ----------------------
+  Flywheel speed from PWM2 (left) and PWM3 (right), one tach edge per
+  revolution.
+*/
+static void Flywheels(HostTime_t Now)
+{
+   static const unsigned char Channels[2] = {2, 3};
+   static const unsigned char Tachs[2] = {4, 6};
+   double Target, Revs;
+   unsigned char i;
+
+   for(i = 0; i < 2; i++)
+   {
+      Target = HostPWMDuty(Channels[i]) * FLY_RPM_PER_DUTY *
+               Vars.Pack / PACK_NOMINAL;
+      Vars.FlyRPM[i] += (Target - Vars.FlyRPM[i]) * DT / FLY_TAU;
+      Revs = Vars.FlyRPM[i] / 60.0 * DT;
+      Edges(Vars.FlyRevs[i], Vars.FlyRevs[i] + Revs, 1.0, HOST_TIM2,
+            Tachs[i], Now);
+      Vars.FlyRevs[i] += Revs;
+   }
+}
+
+/* Function: Feeder
+  -------------------
+  The loaded ball goes once the pusher reaches FEED_WIDTH; a stroke that
+  gets there with none loaded is a dry push. With the pusher back past
+  the clearance width the next ball drops in front of it.
+*/
+static void Feeder(HostTime_t Now)
+{
+   if(Vars.Servo[FEEDER] < FEED_WIDTH)
+      Vars.Pushed = false;
+   else if(!Vars.Pushed)
+   {
+      Vars.Pushed = true;
+      if(!Vars.Loaded)
+         Vars.Status.DryPushes++;
+   }
+   if(Vars.Loaded && Vars.Servo[FEEDER] >= FEED_WIDTH)
+   {
+      Vars.Loaded = false;
+      Vars.DropStart = 0;
+      Fire();
+   }
+   if(!Vars.Loaded && Vars.Hopper > 0 && Vars.Servo[FEEDER] != 0 &&
+      Vars.Servo[FEEDER] < Vars.FeederClear)
+   {
+      if(Vars.DropStart == 0)
+         Vars.DropStart = Now;
+      else if(Now - Vars.DropStart >= HOST_MS(BALL_DROP))
+      {
+         Vars.Loaded = true;
+         Vars.Hopper--;
+      }
+   }
+   else
+      Vars.DropStart = 0;
+
+   if(Vars.Delivery != 0 && Now >= Vars.Delivery)
+   {
+      Vars.Delivery = 0;
+      if(Vars.Hopper + (Vars.Loaded ? 1 : 0) < MAX_BALLS)
+      {
+         Vars.Hopper++;
+         Vars.Status.BallsDelivered++;
+         if(Vars.Verbose)
+            printf("%8.3f depot delivers a ball\n", Seconds(Now));
+      }
+   }
+}
+
+/* Function: Fire
+  -----------------
+  A ball leaves along the turret at a range set by the slower flywheel.
+  It hits the opponent if it passes within their radius, else scores if
+  it reaches the end wall inside the goal mouth. Only counts in a round.
+*/
+static void Fire(void)
+{
+   ArenaStatus_t *Status = &Vars.Status;
+   double Angle = Vars.Heading + (TurretBearing() + Gauss(SHOT_SPREAD)) * DEG;
+   double RPM = (Vars.FlyRPM[0] < Vars.FlyRPM[1]) ? Vars.FlyRPM[0] :
+                                                   Vars.FlyRPM[1];
+   double Range = SHOT_RANGE * (RPM / SHOT_RPM) * (RPM / SHOT_RPM);
+   double Dx = cos(Angle), Dy = sin(Angle);
+   double Along, Across, ToWall, AtWall;
+
+   Status->BallsFired++;
+   if(Vars.Verbose)
+      printf("%8.3f ball fired, bearing %.1f range %.1f\n",
+             Seconds(HostNow()), Angle / DEG, Range);
+   if(Status->Phase != ArenaRound && Status->Phase != ArenaSuddenDeath)
+      return;
+
+   Along = (Vars.Opp.X - Status->X) * Dx + (Vars.Opp.Y - Status->Y) * Dy;
+   Across = fabs(-(Vars.Opp.X - Status->X) * Dy +
+                 (Vars.Opp.Y - Status->Y) * Dx);
+   if(!Status->Unhorsed[ARENA_THEM] && Along > 0 && Along <= Range &&
+      Across <= BOT_RADIUS)
+   {
+      Status->BallHits++;
+      Score(ARENA_US, BALL_POINTS, "ball hits the opponent");
+      return;
+   }
+   if(Dx > 0)
+   {
+      ToWall = (GOAL_X - Status->X) / Dx;
+      AtWall = Status->Y + ToWall * Dy;
+      if(ToWall <= Range && fabs(AtWall - GOAL_Y) <= GOAL_HALF_WIDTH)
+      {
+         Status->Goals++;
+         Score(ARENA_US, GOAL_POINTS, "ball in the goal");
+      }
+   }
+}
+
+/* Function: Lance
+  ------------------
+  A deployed lance reaches LANCE_REACH along the turret and lands a blow
+  when the opponent's head is within HEAD_RADIUS of it, once per drop.
+  A blow may unhorse.
+*/
+static void Lance(void)
+{
+   ArenaStatus_t *Status = &Vars.Status;
+   double Angle, Dx, Dy, Along, Across;
+
+   if(Vars.Servo[LANCE] == 0 || Vars.Servo[LANCE] > LANCE_DOWN)
+   {
+      Vars.LanceArmed = true;
+      return;
+   }
+   if(!Vars.LanceArmed || Status->Unhorsed[ARENA_THEM] ||
+      (Status->Phase != ArenaRound && Status->Phase != ArenaSuddenDeath))
+      return;
+   Angle = Vars.Heading + TurretBearing() * DEG;
+   Dx = Vars.Opp.X - Status->X;
+   Dy = Vars.Opp.Y - Status->Y;
+   Along = Dx * cos(Angle) + Dy * sin(Angle);
+   Across = fabs(-Dx * sin(Angle) + Dy * cos(Angle));
+   if(Along > 0 && Along <= LANCE_REACH + HEAD_RADIUS &&
+      Across <= HEAD_RADIUS)
+   {
+      Vars.LanceArmed = false;
+      Status->LanceHits++;
+      if(Uniform(0, 1) < OUR_UNHORSE_CHANCE)
+      {
+         Status->Unhorsed[ARENA_THEM] = true;
+         Score(ARENA_US, UNHORSE_POINTS, "lance unhorses the opponent");
+      }
+      else
+         Score(ARENA_US, LANCE_POINTS, "lance blow");
+   }
+}
+
+/* Function: Opponent
+  ---------------------
+  Waits its delay, then rides its lane to its destination home. Passing
+  us it may land a blow, and it may put a ball in our goal once a round.
+*/
+static void Opponent(double InPhase)
+{
+   ArenaStatus_t *Status = &Vars.Status;
+   Opponent_t *Opp = &Vars.Opp;
+
+   if(InPhase < Opp->Delay || Status->Unhorsed[ARENA_THEM])
+      return;
+   if(!InHome(Opp->X, ARENA_THEM))
+      Opp->X += Opp->Speed * DT;
+
+   if(!Opp->Passed && fabs(Opp->X - Status->X) < PASS_DISTANCE)
+   {
+      Opp->Passed = true;
+      if(Uniform(0, 1) < OPP_LANCE_CHANCE)
+      {
+         if(Uniform(0, 1) < OPP_UNHORSE_CHANCE)
+         {
+            Status->Unhorsed[ARENA_US] = true;
+            Score(ARENA_THEM, UNHORSE_POINTS, "opponent unhorses us");
+         }
+         else
+            Score(ARENA_THEM, LANCE_POINTS, "opponent lance blow");
+      }
+   }
+   if(Opp->GoalTime >= 0 && InPhase >= Opp->GoalTime)
+   {
+      Opp->GoalTime = -1;
+      Score(ARENA_THEM, GOAL_POINTS, "opponent ball in our goal");
+   }
+}
+
+/* Function: Referee
+  --------------------
+  Phase timing, the race home and the match end.
+*/
+static void Referee(HostTime_t Now)
+{
+   ArenaStatus_t *Status = &Vars.Status;
+   double InPhase = Seconds(Now - Status->PhaseStart);
+   unsigned char Round = Status->Round - 1;
+   bool UsHome, ThemHome;
+
+   switch(Status->Phase)
+   {
+      case ArenaWait:
+         if(!Vars.Scripted && InPhase >= START_WAIT)
+            StartPhase(ArenaRound, Now);
+         break;
+
+      case ArenaRound:
+      case ArenaSuddenDeath:
+         Opponent(InPhase);
+         if(Vars.Scripted)
+            ;
+         else if(Status->Unhorsed[ARENA_US] || Status->Unhorsed[ARENA_THEM])
+         {
+            StartPhase(ArenaEnd, Now);
+            break;
+         }
+         UsHome = InHome(Status->X, ARENA_US);
+         ThemHome = InHome(Vars.Opp.X, ARENA_THEM);
+         if(Status->HomeFirst[Round] == '-' && (UsHome || ThemHome))
+         {
+            Status->HomeFirst[Round] = UsHome ? 'U' : 'T';
+            if(UsHome)
+               Status->HomeTime[Round] = InPhase;
+            Score(UsHome ? ARENA_US : ARENA_THEM, HOME_POINTS,
+                  "first home");
+            if(!Vars.Scripted)
+               EndRound(Now);
+         }
+         else if(Vars.Scripted)
+            ;
+         else if(InPhase >= ROUND_TIME ||
+                 (Status->Phase == ArenaSuddenDeath &&
+                  Status->Score[ARENA_US] != Status->Score[ARENA_THEM]))
+            EndRound(Now);
+         break;
+
+      case ArenaRecess:
+         if(!Vars.Scripted && InPhase >= Vars.RecessLength)
+            StartPhase(ArenaRound, Now);
+         break;
+
+      default:
+         break;
+   }
+}
+
+/* Function: EndRound
+  ---------------------
+  Recess after rounds 1 and 2; after round 3 sudden death on a tie, else
+  the end, as after sudden death.
+*/
+static void EndRound(HostTime_t Now)
+{
+   ArenaStatus_t *Status = &Vars.Status;
+
+   if(Status->Round < 3)
+      StartPhase(ArenaRecess, Now);
+   else if(Status->Round == 3 &&
+           Status->Score[ARENA_US] == Status->Score[ARENA_THEM])
+      StartPhase(ArenaSuddenDeath, Now);
+   else
+      StartPhase(ArenaEnd, Now);
+}
+
+/* Function: StartPhase
+  -----------------------
+  New referee phase. Rounds set the opponent's run; recesses move the
+  walls in, pushing both knights, and open reloading after round 2.
+*/
+static void StartPhase(ArenaPhase_t Phase, HostTime_t Now)
+{
+   ArenaStatus_t *Status = &Vars.Status;
+   Opponent_t *Opp = &Vars.Opp;
+
+   Status->Phase = Phase;
+   Status->PhaseStart = Now;
+   Status->ReloadAllowed = false;
+   switch(Phase)
+   {
+      case ArenaRound:
+      case ArenaSuddenDeath:
+         Status->Round++;
+         Opp->Speed = Uniform(10.0, 20.0);
+         if(Status->Round % 2 == 1)
+            Opp->Speed = -Opp->Speed;
+         Opp->Delay = Uniform(0.0, 1.5);
+         Opp->GoalTime = (Uniform(0, 1) < OPP_GOAL_CHANCE) ?
+                         Uniform(5.0, ROUND_TIME) : -1;
+         Opp->Passed = false;
+         break;
+
+      case ArenaRecess:
+         Vars.RecessLength = Uniform(RECESS_MIN, RECESS_MAX);
+         Vars.Wall -= WALL_STEP;
+         if(Status->Y > Vars.Wall - BOT_RADIUS)
+            Status->Y = Vars.Wall - BOT_RADIUS;
+         if(Opp->Y < FIELD_LENGTH - Vars.Wall + BOT_RADIUS)
+            Opp->Y = FIELD_LENGTH - Vars.Wall + BOT_RADIUS;
+         Status->ReloadAllowed = (Status->Round == 2 &&
+                                  Status->CrossedMidfield);
+         break;
+
+      default:
+         break;
+   }
+   if(Vars.Verbose)
+   {
+      printf("%8.3f %s", Seconds(Now), PhaseNames[Phase]);
+      if(Phase == ArenaRound)
+         printf(" %u", Status->Round);
+      printf(", score %u-%u\n", Status->Score[ARENA_US],
+             Status->Score[ARENA_THEM]);
+   }
+}
+
+/* Function: Score
+  ------------------
+  Points to a knight.
+*/
+static void Score(unsigned char Knight, unsigned char Points,
+                  const char *What)
+{
+   Vars.Status.Score[Knight] += Points;
+   if(Vars.Verbose)
+      printf("%8.3f %s, +%u %s\n", Seconds(HostNow()), What, Points,
+             (Knight == ARENA_US) ? "us" : "them");
+}
+
+/* Function: Edges
+  ------------------
+  One capture edge for every multiple of PerEdge passed going From To
+  over the coming step, at the time it is passed.
+*/
+static void Edges(double From, double To, double PerEdge, unsigned char Timer,
+                  unsigned char Channel, HostTime_t Now)
+{
+   double Next = (floor(From / PerEdge) + 1) * PerEdge;
+
+   while(Next <= To && To > From)
+   {
+      HostCapture(Timer, Channel,
+                  Now + (HostTime_t)((Next - From) / (To - From) *
+                                     HOST_MS(STEP_MS)));
+      Next += PerEdge;
+   }
+}
+
+/* Function: InHome
+  -------------------
+  Whether a knight is all the way into its destination this round. Our
+  odd rounds end at Home B, theirs at our Home A end.
+*/
+static bool InHome(double X, unsigned char Knight)
+{
+   bool ToHighEnd = (Vars.Status.Round % 2 == 1);
+
+   if(Knight == ARENA_THEM)
+      ToHighEnd = !ToHighEnd;
+   if(ToHighEnd)
+      return X - BOT_RADIUS > GREEN_B;
+   return X + BOT_RADIUS < GREEN_A;
+}
+
+/* Function: TurretBearing
+  --------------------------
+  Where the turret points, degrees CCW from the heading.
+*/
+static double TurretBearing(void)
+{
+   return -(Vars.Servo[TURRET] - TURRET_AHEAD) * 180.0 / TURRET_SPAN;
+}
+
+/* Function: Wrap
+  -----------------
+  An angle in radians into -PI..PI.
+*/
+static double Wrap(double Angle)
+{
+   while(Angle > PI)
+      Angle -= 2*PI;
+   while(Angle < -PI)
+      Angle += 2*PI;
+   return Angle;
+}
+
+/* Function: ReadAD
+  -------------------
+  The A/D pins: IR detectors on 0 and 1, tape on 6, drive pack on 7.
+*/
+static short ReadAD(unsigned char Pin)
+{
+   switch(Pin)
+   {
+      case 0:
+         return ReadIR(IR_SQUINT);
+      case 1:
+         return ReadIR(-IR_SQUINT);
+      case 6:
+         return ReadTape();
+      case 7:
+         return (short)(Vars.Pack + Gauss(2.0));
+      default:
+         return 0;
+   }
+}
+
+/* Function: ReadIR
+  -------------------
+  A detector squinting off the turret reads the nearest beacon in its
+  cone, the opponent's head or their goal, else ambient light.
+*/
+static short ReadIR(double Squint)
+{
+   static const double Freqs[2] = {HEAD_FREQ, GOAL_FREQ};
+   ArenaStatus_t *Status = &Vars.Status;
+   double Axis = Vars.Heading + (TurretBearing() + Squint) * DEG;
+   double Xs[2], Ys[2], Dx, Dy, Distance, Best = 1e9, Reading = IR_AMBIENT;
+   unsigned char i;
+
+   Xs[0] = Vars.Opp.X;
+   Ys[0] = Vars.Opp.Y;
+   Xs[1] = GOAL_X;
+   Ys[1] = GOAL_Y;
+   for(i = 0; i < 2; i++)
+   {
+      if(i == 0 && Status->Unhorsed[ARENA_THEM])
+         continue;
+      Dx = Xs[i] - Status->X;
+      Dy = Ys[i] - Status->Y;
+      Distance = sqrt(Dx*Dx + Dy*Dy);
+      if(Distance < Best &&
+         fabs(Wrap(atan2(Dy, Dx) - Axis)) <= IR_HALF_ANGLE * DEG)
+      {
+         Best = Distance;
+         Reading = IR_GAIN * Freqs[i];
+      }
+   }
+   return (short)(Reading + Gauss(IR_NOISE));
+}
+
+/* Function: ReadTape
+  ---------------------
+  The tape sensor, right of centre: green at each Home line, red at
+  midfield, white elsewhere.
+*/
+static short ReadTape(void)
+{
+   double X = Vars.Status.X + TAPE_OFFSET * sin(Vars.Heading);
+   double Reading = TAPE_WHITE;
+
+   if(fabs(X - MIDFIELD) <= TAPE_HALF_WIDTH)
+      Reading = TAPE_RED;
+   else if(fabs(X - GREEN_A) <= TAPE_HALF_WIDTH ||
+           fabs(X - GREEN_B) <= TAPE_HALF_WIDTH)
+      Reading = TAPE_GREEN;
+   return (short)(Reading + Gauss(TAPE_NOISE));
+}
+
+/* Function: PinChange
+  ----------------------
+  Output compare pin edges. The IR LED on PT6 is what the depot watches:
+  ten good pulses with the LED aimed at it bring a ball 1-3s later, when
+  reloading is allowed and no ball is already coming.
+*/
+static void PinChange(unsigned char Timer, unsigned char Channel,
+                      unsigned char Level, HostTime_t When)
+{
+   ArenaStatus_t *Status = &Vars.Status;
+   double Dx, Dy, Length;
+   bool OnGood;
+
+   if(Timer != HOST_TIM0 || Channel != 6)
+      return;
+   if(Level)
+   {
+      Length = (double)(When - Vars.PulseFall) / HOST_CYCLES_PER_MS;
+      Vars.OffGood = (Vars.PulseFall != 0 &&
+                      fabs(Length - DEPOT_OFF) <= DEPOT_TOL);
+      Vars.PulseRise = When;
+      return;
+   }
+   Vars.PulseFall = When;
+   Length = (double)(When - Vars.PulseRise) / HOST_CYCLES_PER_MS;
+   OnGood = (fabs(Length - DEPOT_ON) <= DEPOT_TOL);
+
+   Dx = DEPOT_X - Status->X;
+   Dy = DEPOT_Y - Status->Y;
+   if(!OnGood || sqrt(Dx*Dx + Dy*Dy) > DEPOT_RANGE ||
+      fabs(Wrap(atan2(Dy, Dx) - Vars.Heading - TurretBearing() * DEG)) >
+      DEPOT_HALF_ANGLE * DEG)
+      Vars.Pulses = 0;
+   else if(Vars.Pulses == 0 || Vars.OffGood)
+      Vars.Pulses++;
+   else
+      Vars.Pulses = 1;
+
+   if(Vars.Pulses >= DEPOT_PULSES)
+   {
+      Vars.Pulses = 0;
+      if(Status->ReloadAllowed && Vars.Delivery == 0)
+         Vars.Delivery = When + HOST_MS(1000.0 * Uniform(1.0, 3.0));
+      if(Vars.Verbose)
+         printf("%8.3f depot request%s\n", Seconds(When),
+                Status->ReloadAllowed ? "" : " ignored, no reload allowed");
+   }
+}
+
+/* Function: Uniform
+  --------------------
+  xorshift64* draw between Lo and Hi.
+*/
+static double Uniform(double Lo, double Hi)
+{
+   unsigned long long Bits;
+
+   Vars.Random ^= Vars.Random >> 12;
+   Vars.Random ^= Vars.Random << 25;
+   Vars.Random ^= Vars.Random >> 27;
+   Bits = Vars.Random * 0x2545F4914F6CDD1DULL;
+   return Lo + (Hi - Lo) * ((Bits >> 11) * (1.0 / 9007199254740992.0));
+}
+
+/* Function: Gauss
+  ------------------
+  Normal draw, mean 0.
+*/
+static double Gauss(double Sigma)
+{
+   double U = Uniform(1e-12, 1.0);
+   double V = Uniform(0.0, 1.0);
+
+   return Sigma * sqrt(-2.0 * log(U)) * cos(2*PI*V);
+}
+
+/* Function: Seconds
+  --------------------
+  Bus cycles as seconds.
+*/
+static double Seconds(HostTime_t When)
+{
+   return (double)When / (HOST_CYCLES_PER_MS * 1000.0);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
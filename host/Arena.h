@@ -0,0 +1,54 @@
+/****************************************************************************
+  Header file for the simulated joust field: our knight's drive, turret,
+  flywheels, feeder and lance seen through the emulated hardware, the
+  opponent, the re-supply depot and the referee running the match.
+*****************************************************************************/
+#ifndef Arena_H
+#define Arena_H
+
+#include "ES_Types.h"
+#include "HostHW.h"
+
+//Knights, for the per knight arrays below
+#define ARENA_US 0
+#define ARENA_THEM 1
+
+//Rounds, the fourth being sudden death
+#define ARENA_ROUNDS 4
+
+typedef enum {ArenaWait, ArenaRound, ArenaRecess, ArenaSuddenDeath,
+              ArenaEnd} ArenaPhase_t;
+
+//What the referee knows, and our knight's pose
+typedef struct
+{
+   ArenaPhase_t Phase;
+   unsigned char Round;              //1-3, 4 in sudden death
+   HostTime_t PhaseStart;
+   unsigned char Score[2];
+   bool Unhorsed[2];
+   bool CrossedMidfield;             //our whole body, since the start
+   bool ReloadAllowed;               //ours, in the recess after round 2
+   char HomeFirst[ARENA_ROUNDS];     //'U', 'T' or '-' for each round
+   double HomeTime[ARENA_ROUNDS];    //seconds into the round, if ours
+   unsigned char Goals;              //our scoring, by kind
+   unsigned char BallHits;
+   unsigned char LanceHits;
+   unsigned char BallsFired;
+   unsigned char BallsDelivered;
+   unsigned char DryPushes;          //feeder strokes with no ball loaded
+   double X;                         //inches, x along the field
+   double Y;
+   double Heading;                   //degrees CCW from +x
+} ArenaStatus_t;
+
+// Public Function Prototypes
+void ArenaInit(unsigned long Seed, bool Verbose);
+const ArenaStatus_t *ArenaGetStatus(void);
+void ArenaCallPhase(ArenaPhase_t Phase);
+void ArenaReseed(unsigned long Seed);
+void ArenaPlace(double X, double Y, double Heading);
+void ArenaSetFeeder(double Slew, double ClearWidth);
+StateBlock_t ArenaGetVars(void);
+
+#endif /* Arena_H */
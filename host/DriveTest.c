@@ -0,0 +1,337 @@
+/****************************************************************************
+ Module
+   DriveTest.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host test of the drive (DCMotor.c). First straight driving: the
+   knight is put down in the middle of our half of the simulated field,
+   facing down it, and driven a set distance at a set duty, once with
+   driveStraight's heading hold and once open loop with translateMotor,
+   the way the rounds used to be driven. Each run is a new seed, so a new
+   pair of wheel gains (Arena.c gives each wheel up to 3% either way). How
+   far the knight ended up off the line it started on, per meter driven,
+   is the drift, as the mean over the seeds and the worst seed.
+   Then the stop on END (brakeMotorNow, from JSRcommand): the knight plays
+   a JSR timeline with END coming part way through round 1, later for
+   each seed, and the latency is from the SPI interrupt that ends the
+   reply carrying END to the main loop pass that writes the zero duties:
+
+     DriveTest: 60in straight, 8 seeds a duty
+       duty   heading hold            open loop
+        30%   drift 0.0 max 0.1mm/m   drift 47.9 max 98.1mm/m
+     ...
+       100%   drift 0.6 max 1.0mm/m   drift 47.9 max 98.1mm/m
+       END to wheels off: mean 179us max 179us, 8 seeds, 8 driving, all braked
+
+   Exits 1 if heading hold lets any run drift more than DRIFT_LIMIT, or
+   if any END leaves a wheel driven.
+
+   Usage: DriveTest [-n seeds] [-d inches]
+     -n  seeds, 8 by default
+     -d  distance to drive, 60in by default (the field allows about 70)
+
+ Notes
+   Every run starts from power-on: the firmware, the framework and the
+   hardware are put back from a snapshot (HostSnapshot.c) taken before
+   the first run, as a reset would, then booted as Match.c does. For the
+   drift the referee is held in the wait before the first round so the
+   Bot leaves the wheels alone, and the drive call is made from outside
+   the framework, between two passes of the main loop.
+   The arena's wheels do not slip and its encoders miss no edges, so the
+   drift is what the controller leaves over the wheel mismatch, not what
+   the floor adds on the field.
+   The stop latency runs on ES_Host.h's costs for a main loop pass: the
+   rest of the pass the interrupt lands in, the pass whose CheckSPI posts
+   SPIDone and JSRcommand's own. The few instructions of brakeMotorNow
+   itself take no host time and are not in the figure.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 21:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Host.h"
+#include "Arena.h"
+#include "SimJSR.h"
+#include "HostSnapshot.h"
+#include "DCMotor.h"
+#include "JSRcommand.h"
+#include "Servos.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define START_X 12.0            //inches, clear of the end and both walls
+#define START_Y 72.0
+#define SETTLE HOST_MS(500)     //after ES_Initialize, before the drive
+#define RUN_LIMIT HOST_MS(20000)
+#define DRIFT_LIMIT 10.0        //mm/m, heading hold's worst allowed
+#define ROUND_START 0.5         //seconds into the timeline
+#define END_FIRST 1.0           //seconds into the round, first seed's END
+#define END_STRIDE 0.2371      //later for each seed, off the query rhythm
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+   double Sum;
+   double Max;
+} DriftStats_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static double Drive(unsigned long Seed, signed int Duty, bool Hold,
+                    double Distance);
+static void AddDrift(DriftStats_t *Stats, double Drift);
+static void Reset(unsigned long Seed);
+static void Boot(void);
+static double Stop(unsigned long Seed);
+static void Select(HostTime_t When);
+static unsigned char Exchange(unsigned char Out, HostTime_t When);
+static void Release(HostTime_t When);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const signed int Duties[] = {30, 50, 75, 100};
+
+//The simulated JSR, seen through Release to time the replies
+static const HostSPISlave_t TimedJSR = {Select, Exchange, Release};
+
+//Running state, all in one place
+typedef struct
+{
+   unsigned char *PowerOn;      //everything as it was before any run
+   HostTime_t LastReply;        //when the last reply's SS was released
+   unsigned int Moving;         //ENDs that came with the wheels driven
+} DriveTestVars_t;
+
+static DriveTestVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+   unsigned int Seeds = 8, d, n;
+   double Distance = 60.0, Drift, Latency;
+   DriftStats_t Held, Open, Stops = {0, 0};
+   bool Failed = false;
+   int Option;
+
+   while((Option = getopt(argc, argv, "n:d:")) != -1)
+   {
+      switch(Option)
+      {
+         case 'n':
+            Seeds = strtoul(optarg, 0, 0);
+            break;
+         case 'd':
+            Distance = atof(optarg);
+            break;
+         default:
+            Seeds = 0;
+            break;
+      }
+   }
+   if(Seeds == 0 || Distance <= 0)
+   {
+      fprintf(stderr, "usage: %s [-n seeds] [-d inches]\n", argv[0]);
+      return 2;
+   }
+
+   if((Vars.PowerOn = malloc(HostSnapshotSize())) == 0)
+   {
+      fprintf(stderr, "no room for a snapshot\n");
+      return 1;
+   }
+   HostSaveSnapshot(Vars.PowerOn);
+
+   printf("DriveTest: %.0fin straight, %u seeds a duty\n", Distance, Seeds);
+   printf("  duty   heading hold            open loop\n");
+   for(d = 0; d < ARRAY_SIZE(Duties); d++)
+   {
+      Held.Sum = Held.Max = 0;
+      Open.Sum = Open.Max = 0;
+      for(n = 1; n <= Seeds; n++)
+      {
+         Drift = Drive(n, Duties[d], true, Distance);
+         if(Drift < 0 || Drift > DRIFT_LIMIT)
+            Failed = true;
+         AddDrift(&Held, Drift);
+         AddDrift(&Open, Drive(n, Duties[d], false, Distance));
+      }
+      printf("  %3d%%   drift %.1f max %.1fmm/m   drift %.1f max %.1fmm/m\n",
+             Duties[d], Held.Sum / Seeds, Held.Max, Open.Sum / Seeds,
+             Open.Max);
+   }
+   if(Failed)
+   {
+      printf("DriveTest: heading hold drifted over %.0fmm/m, or stalled\n",
+             DRIFT_LIMIT);
+      return 1;
+   }
+
+   for(n = 1; n <= Seeds; n++)
+   {
+      Latency = Stop(n);
+      if(Latency < 0)
+         Failed = true;
+      else
+         AddDrift(&Stops, Latency);
+   }
+   printf("  END to wheels off: mean %.0fus max %.0fus, %u seeds, %u "
+          "driving, %s\n", Stops.Sum / Seeds, Stops.Max, Seeds, Vars.Moving,
+          Failed ? "NOT ALL BRAKED" : "all braked");
+   return Failed ? 1 : 0;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Drive
+  ------------------
+  One run: boot, put the knight down, drive Distance inches at Duty
+  percent and stop. Returns the drift in mm/m, or -1 if the knight did
+  not get that far in RUN_LIMIT.
+*/
+static double Drive(unsigned long Seed, signed int Duty, bool Hold,
+                    double Distance)
+{
+   const ArenaStatus_t *Status;
+   HostTime_t Limit;
+   double Along = 0, Across = 0;
+
+   Reset(Seed);
+   Boot();
+   ES_HostRunUntil(SETTLE);
+
+   ArenaPlace(START_X, START_Y, 0.0);
+   HostEnterFirmware();
+   if(Hold)
+      driveStraight(Duty);
+   else
+      translateMotor(Duty);
+   HostLeaveFirmware();
+
+   Status = ArenaGetStatus();
+   Limit = HostNow() + RUN_LIMIT;
+   while(Along < Distance && HostNow() < Limit)
+   {
+      ES_HostStep();
+      Along = Status->X - START_X;
+      Across = Status->Y - START_Y;
+   }
+
+   HostEnterFirmware();
+   stopMotorNow();
+   HostLeaveFirmware();
+   if(Along < Distance)
+      return -1;
+   return fabs(Across) / Along * 1000.0;
+}
+
+/* Function: Stop
+  -----------------
+  One END: the knight plays round 1 of a timeline until END, a little
+  later for each seed. Returns the time in us from the SPI interrupt that
+  ended the reply carrying END to the pass that braked, or -1 if that
+  pass left a wheel driven or END never came.
+*/
+static double Stop(unsigned long Seed)
+{
+   char Timeline[160];
+   double End = ROUND_START + END_FIRST + (Seed - 1) * END_STRIDE;
+   FILE *File;
+   HostTime_t Pass;
+   bool Driven;
+
+   Reset(Seed);
+   snprintf(Timeline, sizeof(Timeline), "0 WAIT 0 0\n%.3f START_ROUND 0 0\n"
+            "%.4f END 0 0\n", ROUND_START, End);
+   File = fmemopen(Timeline, strlen(Timeline), "r");
+   if(File == 0 || !SimJSRLoad(File, "stop timeline"))
+      exit(1);
+   fclose(File);
+   Boot();
+
+   while(HostNow() < HOST_MS((End + 1.0) * 1000.0))
+   {
+      Pass = HostNow();
+      Driven = (HostPWMDuty(1) != 0 || HostPWMDuty(5) != 0);
+      ES_HostStep();
+      if(GetJSRSnapshot()->Command != END)
+         continue;
+      if(HostPWMDuty(1) != 0 || HostPWMDuty(5) != 0)
+         return -1;
+      if(Driven)
+         Vars.Moving++;
+      return (double)(Pass - Vars.LastReply) / HOST_CYCLES_PER_US;
+   }
+   return -1;
+}
+
+/* Function: Reset
+  ------------------
+  Everything back to power-on, and a new field for Seed with the referee
+  held in the wait.
+*/
+static void Reset(unsigned long Seed)
+{
+   HostRestoreSnapshot(Vars.PowerOn);
+   ES_HostReset();
+   ArenaInit(Seed, false);
+   ArenaCallPhase(ArenaWait);
+   SimJSRInit();
+}
+
+/* Function: Boot
+  -----------------
+  Start the firmware as main does on the target, on the simulated JSR.
+*/
+static void Boot(void)
+{
+   HostSetSPISlave(&TimedJSR);
+   InitServos();
+   if(ES_Initialize(ES_Timer_RATE_1mS) != Success)
+   {
+      fprintf(stderr, "ES_Initialize failed\n");
+      exit(1);
+   }
+}
+
+/* Function(s): Select, Exchange, Release
+  -------------------------------------------
+  The simulated JSR as it is, noting when the SPI interrupt after the
+  last byte of each reply releases SS.
+*/
+static void Select(HostTime_t When)
+{
+   SimJSRSlave.Select(When);
+}
+
+static unsigned char Exchange(unsigned char Out, HostTime_t When)
+{
+   return SimJSRSlave.Exchange(Out, When);
+}
+
+static void Release(HostTime_t When)
+{
+   Vars.LastReply = When;
+   SimJSRSlave.Release(When);
+}
+
+/* Function: AddDrift
+  ---------------------
+  One run's drift, or stop latency, into the mean and the worst.
+*/
+static void AddDrift(DriftStats_t *Stats, double Drift)
+{
+   Stats->Sum += Drift;
+   if(Drift > Stats->Max)
+      Stats->Max = Drift;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,582 @@
+/****************************************************************************
+ Module
+   ES_Host.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host stand-in for the Gen2 Events and Services framework, built from
+   the same ES_Configure.h as the target: one queue per service sized by
+   SERV_n_QUEUE_SIZE, the 16 timers posting ES_TIMEOUT to
+   TIMERn_RESP_FUNC, the EVENT_CHECK_LIST checkers and deferral queues.
+
+ Notes
+   Scheduling follows ES_Run. A pass either runs the highest numbered
+   service with an event waiting, one event, or when all queues are empty
+   polls the checkers until the first one reports an event. Each pass
+   then advances the hardware (HostHW.c) by ES_HOST_RUN_COST or
+   ES_HOST_CHECK_COST, which is where interrupts and the framework tick
+   happen.
+   The tick counts down the running timers and posts their timeouts
+   directly.
+   As in Gen2 the first element of a deferral block is its header, so a
+   block of N events holds N-1. The deferral blocks belong to the
+   services, so they are in the services' own snapshot blocks; the
+   queues, timers and keys here are in ES_HostGetVars'.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 20:00 PS      ES_HostSetPostHook, to watch every post
+ 04/30/14 19:00 PS      Queues and timers handed out for snapshots
+ 04/29/14 10:15 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_DeferRecall.h"
+#include "ES_ServiceHeaders.h"
+#include EVENT_CHECK_HEADER
+#include "ES_Host.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_QUEUE 8
+#define MAX_KEYS 32
+
+/*---------------------------- Module Types -------------------------------*/
+typedef bool (*pInitFunc)(uint8_t Priority);
+typedef ES_Event (*pRunFunc)(ES_Event ThisEvent);
+typedef bool (*pCheckFunc)(void);
+
+typedef struct
+{
+   ES_Event Events[MAX_QUEUE];
+   unsigned char Head;
+   unsigned char Count;
+   unsigned char MaxUsed;
+   unsigned int Lost;
+} ES_HostQueue_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Tick(HostTime_t Now);
+static bool Post(uint8_t WhichService, ES_Event ThisEvent, bool Front);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const pInitFunc Inits[NUM_SERVICES] =
+{
+   SERV_0_INIT,
+#if NUM_SERVICES > 1
+   SERV_1_INIT,
+#endif
+#if NUM_SERVICES > 2
+   SERV_2_INIT,
+#endif
+#if NUM_SERVICES > 3
+   SERV_3_INIT,
+#endif
+#if NUM_SERVICES > 4
+   SERV_4_INIT,
+#endif
+#if NUM_SERVICES > 5
+   SERV_5_INIT,
+#endif
+#if NUM_SERVICES > 6
+   SERV_6_INIT,
+#endif
+#if NUM_SERVICES > 7
+   SERV_7_INIT,
+#endif
+#if NUM_SERVICES > 8
+   SERV_8_INIT,
+#endif
+};
+
+static const pRunFunc Runs[NUM_SERVICES] =
+{
+   SERV_0_RUN,
+#if NUM_SERVICES > 1
+   SERV_1_RUN,
+#endif
+#if NUM_SERVICES > 2
+   SERV_2_RUN,
+#endif
+#if NUM_SERVICES > 3
+   SERV_3_RUN,
+#endif
+#if NUM_SERVICES > 4
+   SERV_4_RUN,
+#endif
+#if NUM_SERVICES > 5
+   SERV_5_RUN,
+#endif
+#if NUM_SERVICES > 6
+   SERV_6_RUN,
+#endif
+#if NUM_SERVICES > 7
+   SERV_7_RUN,
+#endif
+#if NUM_SERVICES > 8
+   SERV_8_RUN,
+#endif
+};
+
+static const unsigned char QueueSizes[NUM_SERVICES] =
+{
+   SERV_0_QUEUE_SIZE,
+#if NUM_SERVICES > 1
+   SERV_1_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 2
+   SERV_2_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 3
+   SERV_3_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 4
+   SERV_4_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 5
+   SERV_5_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 6
+   SERV_6_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 7
+   SERV_7_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 8
+   SERV_8_QUEUE_SIZE,
+#endif
+};
+
+static const pPostFunc TimerResponses[ES_NUM_TIMERS] =
+{
+   TIMER0_RESP_FUNC, TIMER1_RESP_FUNC, TIMER2_RESP_FUNC, TIMER3_RESP_FUNC,
+   TIMER4_RESP_FUNC, TIMER5_RESP_FUNC, TIMER6_RESP_FUNC, TIMER7_RESP_FUNC,
+   TIMER8_RESP_FUNC, TIMER9_RESP_FUNC, TIMER10_RESP_FUNC, TIMER11_RESP_FUNC,
+   TIMER12_RESP_FUNC, TIMER13_RESP_FUNC, TIMER14_RESP_FUNC, TIMER15_RESP_FUNC
+};
+
+static const pCheckFunc Checkers[] = {EVENT_CHECK_LIST};
+
+//Running state, all in one place
+typedef struct
+{
+   ES_HostQueue_t Queues[NUM_SERVICES];
+   uint16_t TimerCounts[ES_NUM_TIMERS];
+   uint16_t TimerActive;
+   unsigned int Time;
+   char Keys[MAX_KEYS];
+   unsigned char KeyHead;
+   unsigned char KeyCount;
+   pHostPostHook PostHook;
+} ES_HostVars_t;
+
+static ES_HostVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_HostReset
+
+ Description
+   Hardware back to reset and the framework empty, ready for a fresh
+   InitServos and ES_Initialize.
+****************************************************************************/
+void ES_HostReset(void)
+{
+   ES_HostVars_t Empty = {0};
+
+   HostResetHW();
+   Vars = Empty;
+}
+
+/****************************************************************************
+ Function
+   ES_Initialize
+
+ Parameters
+   TimerRate_t : ignored, the host tick is always ES_HOST_TICK
+
+ Returns
+   ES_Return_t, FailedInit if a service's init fails
+****************************************************************************/
+ES_Return_t ES_Initialize(TimerRate_t NewRate)
+{
+   uint8_t i;
+
+   (void)NewRate;
+   for(i = 0; i < NUM_SERVICES; i++)
+   {
+      Vars.Queues[i].Head = Vars.Queues[i].Count = 0;
+      if(QueueSizes[i] > MAX_QUEUE)
+         return FailedInit;
+   }
+   if(!HostAddPeriodic(Tick, ES_HOST_TICK))
+      return FailedInit;
+   for(i = 0; i < NUM_SERVICES; i++)
+   {
+      HostEnterFirmware();
+      if(!Inits[i](i))
+      {
+         HostLeaveFirmware();
+         return FailedInit;
+      }
+      HostLeaveFirmware();
+   }
+   return Success;
+}
+
+/****************************************************************************
+ Function
+   ES_HostStep
+
+ Description
+   One pass of the main loop, then the hardware advanced by what it cost.
+****************************************************************************/
+void ES_HostStep(void)
+{
+   ES_HostQueue_t *Queue;
+   ES_Event ThisEvent;
+   HostTime_t Cost = ES_HOST_CHECK_COST;
+   int i;
+   unsigned char c;
+
+   HostEnterFirmware();
+   for(i = NUM_SERVICES - 1; i >= 0; i--)
+   {
+      Queue = &Vars.Queues[i];
+      if(Queue->Count == 0)
+         continue;
+      ThisEvent = Queue->Events[Queue->Head];
+      Queue->Head = (Queue->Head + 1) % QueueSizes[i];
+      Queue->Count--;
+      Runs[i](ThisEvent);
+      Cost = ES_HOST_RUN_COST;
+      break;
+   }
+   if(i < 0)
+   {
+      for(c = 0; c < ARRAY_SIZE(Checkers); c++)
+      {
+         if(Checkers[c]())
+            break;
+      }
+   }
+   HostLeaveFirmware();
+   HostAdvance(HostNow() + Cost);
+}
+
+/****************************************************************************
+ Function
+   ES_HostRunUntil
+
+ Parameters
+   HostTime_t : time to stop at, in bus cycles
+****************************************************************************/
+void ES_HostRunUntil(HostTime_t Until)
+{
+   while(HostNow() < Until)
+      ES_HostStep();
+}
+
+/****************************************************************************
+ Function
+   ES_HostPressKey
+
+ Parameters
+   char : key, as if typed on the terminal
+
+ Description
+   Queues a key for IsNewKeyReady/GetNewKey; dropped if the queue is full.
+****************************************************************************/
+void ES_HostPressKey(char Key)
+{
+   if(Vars.KeyCount >= MAX_KEYS)
+      return;
+   Vars.Keys[(Vars.KeyHead + Vars.KeyCount) % MAX_KEYS] = Key;
+   Vars.KeyCount++;
+}
+
+/****************************************************************************
+ Function
+   ES_HostQueueStats
+
+ Parameters
+   uint8_t : service number
+
+ Returns
+   ES_HostQueueStats_t, the deepest the service's queue got and how many
+   posts to it were lost
+****************************************************************************/
+ES_HostQueueStats_t ES_HostQueueStats(uint8_t WhichService)
+{
+   ES_HostQueueStats_t Stats = {0, 0, 0};
+
+   if(WhichService < NUM_SERVICES)
+   {
+      Stats.Size = QueueSizes[WhichService];
+      Stats.MaxUsed = Vars.Queues[WhichService].MaxUsed;
+      Stats.Lost = Vars.Queues[WhichService].Lost;
+   }
+   return Stats;
+}
+
+/****************************************************************************
+ Function
+   ES_HostSetPostHook
+
+ Parameters
+   pHostPostHook : called with every post to a service, before it is
+   queued and whether or not there is room; 0 for none
+
+ Description
+   Lets a tool see the events the firmware posts. ES_HostReset takes the
+   hook off.
+****************************************************************************/
+void ES_HostSetPostHook(pHostPostHook Hook)
+{
+   Vars.PostHook = Hook;
+}
+
+/****************************************************************************
+ Function
+   ES_PostToService, ES_PostToServiceLIFO, ES_PostAll
+
+ Returns
+   bool, false if a queue was full or the service does not exist
+****************************************************************************/
+bool ES_PostToService(uint8_t WhichService, ES_Event TheEvent)
+{
+   return Post(WhichService, TheEvent, false);
+}
+
+bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event TheEvent)
+{
+   return Post(WhichService, TheEvent, true);
+}
+
+bool ES_PostAll(ES_Event ThisEvent)
+{
+   bool ReturnVal = true;
+   uint8_t i;
+
+   for(i = 0; i < NUM_SERVICES; i++)
+   {
+      if(!Post(i, ThisEvent, false))
+         ReturnVal = false;
+   }
+   return ReturnVal;
+}
+
+/****************************************************************************
+ Function
+   ES_Timer_InitTimer, ES_Timer_SetTimer, ES_Timer_StartTimer,
+   ES_Timer_StopTimer, ES_Timer_isActive, ES_Timer_GetTime
+
+ Description
+   The Gen2 timer calls: InitTimer sets and starts, SetTimer only sets,
+   StartTimer resumes whatever is left, StopTimer leaves it there.
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime)
+{
+   if(Num >= ES_NUM_TIMERS || NewTime == 0 || TimerResponses[Num] == 0)
+      return ES_Timer_ERR;
+   Vars.TimerCounts[Num] = NewTime;
+   Vars.TimerActive |= 1u << Num;
+   return ES_Timer_OK;
+}
+
+ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
+{
+   if(Num >= ES_NUM_TIMERS || NewTime == 0 || TimerResponses[Num] == 0)
+      return ES_Timer_ERR;
+   Vars.TimerCounts[Num] = NewTime;
+   return ES_Timer_OK;
+}
+
+ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
+{
+   if(Num >= ES_NUM_TIMERS || Vars.TimerCounts[Num] == 0)
+      return ES_Timer_ERR;
+   Vars.TimerActive |= 1u << Num;
+   return ES_Timer_OK;
+}
+
+ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
+{
+   if(Num >= ES_NUM_TIMERS)
+      return ES_Timer_ERR;
+   Vars.TimerActive &= ~(1u << Num);
+   return ES_Timer_OK;
+}
+
+ES_TimerReturn_t ES_Timer_isActive(uint8_t Num)
+{
+   if(Num >= ES_NUM_TIMERS)
+      return ES_Timer_ERR;
+   return (Vars.TimerActive & (1u << Num)) ? ES_Timer_ACTIVE :
+                                             ES_Timer_NOT_ACTIVE;
+}
+
+unsigned int ES_Timer_GetTime(void)
+{
+   return Vars.Time;
+}
+
+/****************************************************************************
+ Function
+   ES_InitDeferralQueueWith, ES_DeferEvent, ES_RecallEvents
+
+ Description
+   Deferral queues as in Gen2. Element 0 of a block is the header: the
+   block size in EventType, the first entry and the count in EventParam.
+   Recalled events go to the front of the service's queue, oldest ending
+   up first.
+****************************************************************************/
+bool ES_InitDeferralQueueWith(ES_Event *pBlock, unsigned char BlockSize)
+{
+   if(BlockSize < 2)
+      return false;
+   pBlock[0].EventType = (ES_EventTyp_t)BlockSize;
+   pBlock[0].EventParam = 0;
+   return true;
+}
+
+bool ES_DeferEvent(ES_Event *pBlock, ES_Event Event2Add)
+{
+   unsigned char Room = (unsigned char)pBlock[0].EventType - 1;
+   unsigned char First = pBlock[0].EventParam >> 8;
+   unsigned char Count = pBlock[0].EventParam & 0xFF;
+
+   if(Count >= Room)
+      return false;
+   pBlock[1 + (First + Count) % Room] = Event2Add;
+   pBlock[0].EventParam = (First << 8) | (Count + 1);
+   return true;
+}
+
+bool ES_RecallEvents(unsigned char WhichService, ES_Event *pBlock)
+{
+   unsigned char Room = (unsigned char)pBlock[0].EventType - 1;
+   unsigned char First = pBlock[0].EventParam >> 8;
+   unsigned char Count = pBlock[0].EventParam & 0xFF;
+   bool WereEventsPulled = (Count > 0);
+
+   while(Count > 0)
+   {
+      Count--;
+      ES_PostToServiceLIFO(WhichService,
+                           pBlock[1 + (First + Count) % Room]);
+   }
+   pBlock[0].EventParam = 0;
+   return WereEventsPulled;
+}
+
+/****************************************************************************
+ Function
+   IsNewKeyReady, GetNewKey
+
+ Description
+   The terminal, fed by ES_HostPressKey.
+****************************************************************************/
+bool IsNewKeyReady(void)
+{
+   return Vars.KeyCount > 0;
+}
+
+char GetNewKey(void)
+{
+   char Key;
+
+   if(Vars.KeyCount == 0)
+      return 0;
+   Key = Vars.Keys[Vars.KeyHead];
+   Vars.KeyHead = (Vars.KeyHead + 1) % MAX_KEYS;
+   Vars.KeyCount--;
+   return Key;
+}
+
+/****************************************************************************
+ Function
+   ES_HostGetVars
+
+ Returns
+   StateBlock_t, where the queues, the timers and the
+   key queue live
+****************************************************************************/
+StateBlock_t ES_HostGetVars(void)
+{
+   StateBlock_t Block;
+
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Tick
+  -----------------
+  The framework tick: count the time and the running timers, posting
+  ES_TIMEOUT for each that reaches zero.
+*/
+static void Tick(HostTime_t Now)
+{
+   ES_Event ThisEvent;
+   uint8_t i;
+
+   (void)Now;
+   Vars.Time++;
+   if(Vars.TimerActive == 0)
+      return;
+   HostEnterFirmware();
+   for(i = 0; i < ES_NUM_TIMERS; i++)
+   {
+      if(!(Vars.TimerActive & (1u << i)))
+         continue;
+      if(--Vars.TimerCounts[i] == 0)
+      {
+         Vars.TimerActive &= ~(1u << i);
+         ThisEvent.EventType = ES_TIMEOUT;
+         ThisEvent.EventParam = i;
+         TimerResponses[i](ThisEvent);
+      }
+   }
+   HostLeaveFirmware();
+}
+
+/* Function: Post
+  -----------------
+  Into a service's queue, at the back or the front.
+*/
+static bool Post(uint8_t WhichService, ES_Event ThisEvent, bool Front)
+{
+   ES_HostQueue_t *Queue;
+   unsigned char Size;
+
+   if(WhichService >= NUM_SERVICES)
+      return false;
+   if(Vars.PostHook != 0)
+      Vars.PostHook(WhichService, ThisEvent);
+   Queue = &Vars.Queues[WhichService];
+   Size = QueueSizes[WhichService];
+   if(Queue->Count >= Size)
+   {
+      Queue->Lost++;
+      return false;
+   }
+   if(Front)
+   {
+      Queue->Head = (Queue->Head + Size - 1) % Size;
+      Queue->Events[Queue->Head] = ThisEvent;
+   }
+   else
+      Queue->Events[(Queue->Head + Queue->Count) % Size] = ThisEvent;
+   Queue->Count++;
+   if(Queue->Count > Queue->MaxUsed)
+      Queue->MaxUsed = Queue->Count;
+   return true;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
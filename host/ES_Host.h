@@ -0,0 +1,40 @@
+/****************************************************************************
+  Header file for the host stand-in of the Gen2 Events and Services
+  framework. ES_Initialize and the posting, timer, deferral and keyboard
+  calls are the framework's own; ES_Run is replaced by the stepping calls
+  below so a simulation can interleave the firmware with its world.
+*****************************************************************************/
+#ifndef ES_Host_H
+#define ES_Host_H
+
+#include "ES_Framework.h"
+#include "HostHW.h"
+
+//Framework tick, the 1.024ms the E128 port runs its timers at
+#define ES_HOST_TICK 24576ULL
+
+//What one main loop pass is taken to cost: running a service, and
+//polling the event checkers
+#define ES_HOST_RUN_COST (50ULL * HOST_CYCLES_PER_US)
+#define ES_HOST_CHECK_COST (100ULL * HOST_CYCLES_PER_US)
+
+//Queue use of a service since ES_Initialize
+typedef struct
+{
+   unsigned char Size;
+   unsigned char MaxUsed;
+   unsigned int Lost;        //posts refused because the queue was full
+} ES_HostQueueStats_t;
+
+typedef void (*pHostPostHook)(uint8_t WhichService, ES_Event ThisEvent);
+
+// Public Function Prototypes
+void ES_HostReset(void);
+void ES_HostStep(void);
+void ES_HostRunUntil(HostTime_t Until);
+void ES_HostPressKey(char Key);
+void ES_HostSetPostHook(pHostPostHook Hook);
+ES_HostQueueStats_t ES_HostQueueStats(uint8_t WhichService);
+StateBlock_t ES_HostGetVars(void);
+
+#endif /* ES_Host_H */
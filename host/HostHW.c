@@ -0,0 +1,846 @@
+/****************************************************************************
+ Module
+   HostHW.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host emulation of the E128 peripherals, enough to run the unmodified
+   firmware modules against a simulated robot. Time is virtual, counted
+   in 24MHz bus cycles, and only moves in HostAdvance. What the hardware
+   does by itself (counting, output compare pin actions, input captures,
+   SPI shifts, periodic interrupts) happens at its own cycle and the
+   matching interrupt response is called there.
+
+ Notes
+   The firmware runs atomically. The main loop (ES_Host.c) makes one call
+   and then advances time by what that call is taken to cost; interrupts
+   falling inside that span run after it, at their own time. Interrupt
+   latency is therefore up to one main loop call, while the hardware
+   actions themselves (compare pin edges, captured counts) are exact.
+   Counters are the bus cycles shifted down by the prescale and do not
+   wrap within a run (see mc9s12e128.h), unless TCRE is set, when the
+   channel 7 compare resets the counter as on the part. Output compares
+   match on the low 16 bits like the part does. Channel 7 compares also
+   drive the pins set in OC7M, channel 7's own action last. PTIT reads
+   PTT, where the compare pins show. TIM0's pulse accumulator counts PT7
+   edges in event mode; only the compare pin actions move PT7 here. Timer and accumulator flags,
+   overflow toggles (TTOV) and the overflow interrupt are not modelled:
+   an enabled channel's response is called directly.
+   SPIDR reads back 0x100 | the last byte received, so a value below
+   0x100 after a firmware call means it was written, which starts a
+   transfer 8 bit times long at the SPIBR rate.
+   Input pins of PORTE and PTIAD are set again from HostSetPortE and
+   HostSetPortAD before each firmware call.
+   The registers are all laid out in the one host_regs section, so a
+   snapshot takes them as one block (HostGetRegisters).
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 23:00 PS      Counter reset on channel 7 (TCRE), OC7M and
+                        the pulse accumulator, and a count of interrupt
+                        responses
+ 04/30/14 19:00 PS      Registers and running state handed out for
+                        snapshots
+ 04/29/14 09:30 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <string.h>
+
+#define HOST_REG(Type, Name) \
+   volatile Type Name __attribute__((section("host_regs")));
+#include <mc9s12e128.h>
+#include "ADS12.h"
+#include "HostHW.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_EDGES 64
+#define NO_EVENT (~(HostTime_t)0)
+#define SPIDR_READ 0x100     //marks SPIDR as not written by the firmware
+#define SS_PIN 0x80          //PS7
+#define COMPARE_MASK 0xFFFFUL
+
+//What happens next
+enum {EV_COMPARE, EV_CAPTURE, EV_SPI, EV_PERIODIC};
+
+/*---------------------------- Module Types -------------------------------*/
+typedef void (*pResponse)(void);
+
+//Registers of one timer module
+typedef struct
+{
+   volatile unsigned char *TIOS;
+   volatile unsigned char *TCTL1;     //pin actions ch7-4
+   volatile unsigned char *TCTL2;     //pin actions ch3-0
+   volatile unsigned char *TIE;
+   volatile unsigned char *TSCR1;
+   volatile unsigned char *TSCR2;
+   volatile unsigned int *TCNT;
+   volatile unsigned int *TC[8];
+   volatile unsigned char *Port;      //where the compare pins show, or 0
+   pResponse Response[8];
+} HostTimer_t;
+
+typedef struct
+{
+   HostTime_t When;
+   unsigned char Timer;
+   unsigned char Channel;
+} HostEdge_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static unsigned char Prescale(unsigned char Timer);
+static unsigned char PinAction(unsigned char Timer, unsigned char Channel);
+static unsigned long CountBase(unsigned char Timer, unsigned long Raw);
+static HostTime_t NextCompare(unsigned char Timer);
+static void DoCompares(unsigned char Timer);
+static void DoAction(unsigned char Timer, unsigned char Channel,
+                     unsigned char Action);
+static void SetPin(unsigned char Timer, unsigned char Channel,
+                   unsigned char Level);
+static void DoCapture(void);
+static void DoSPI(void);
+static void RunResponse(pResponse Response);
+static HostTime_t SPIByteTime(void);
+
+//Bounds of the host_regs section, from the linker
+extern unsigned char __start_host_regs[];
+extern unsigned char __stop_host_regs[];
+
+//Interrupt responses of the firmware modules. Weak, so a tool linking
+//only some modules leaves the others' vectors empty
+extern void RightEncoder(void) __attribute__((weak));
+extern void LeftEncoder(void) __attribute__((weak));
+extern void WavePT6(void) __attribute__((weak));
+extern void WavePT7(void) __attribute__((weak));
+extern void WaveTrainEnd(void) __attribute__((weak));
+extern void LeftTach(void) __attribute__((weak));
+extern void RightTach(void) __attribute__((weak));
+extern void SPIByte(void) __attribute__((weak));
+
+/*---------------------------- Module Variables ---------------------------*/
+static const HostTimer_t Timers[HOST_NUM_TIMERS] =
+{
+   {&TIM0_TIOS, &TIM0_TCTL1, &TIM0_TCTL2, &TIM0_TIE, &TIM0_TSCR1,
+    &TIM0_TSCR2, &TIM0_TCNT,
+    {&TIM0_TC0, &TIM0_TC1, &TIM0_TC2, &TIM0_TC3,
+     &TIM0_TC4, &TIM0_TC5, &TIM0_TC6, &TIM0_TC7}, &PTT,
+    {0, 0, 0, 0, RightEncoder, LeftEncoder, WavePT6, WavePT7}},
+   {&TIM1_TIOS, &TIM1_TCTL1, &TIM1_TCTL2, &TIM1_TIE, &TIM1_TSCR1,
+    &TIM1_TSCR2, &TIM1_TCNT,
+    {&TIM1_TC0, &TIM1_TC1, &TIM1_TC2, &TIM1_TC3,
+     &TIM1_TC4, &TIM1_TC5, &TIM1_TC6, &TIM1_TC7}, 0,
+    {0, 0, 0, 0, 0, 0, 0, 0}},
+   {&TIM2_TIOS, &TIM2_TCTL1, &TIM2_TCTL2, &TIM2_TIE, &TIM2_TSCR1,
+    &TIM2_TSCR2, &TIM2_TCNT,
+    {&TIM2_TC0, &TIM2_TC1, &TIM2_TC2, &TIM2_TC3,
+     &TIM2_TC4, &TIM2_TC5, &TIM2_TC6, &TIM2_TC7}, 0,
+    {0, 0, 0, 0, LeftTach, 0, RightTach, 0}}
+};
+
+//Running state, all in one place
+typedef struct
+{
+   HostTime_t Now;
+   HostTime_t CompareDone[HOST_NUM_TIMERS];  //last compare instant handled
+   unsigned long Base[HOST_NUM_TIMERS];      //bus count of the last reset
+   unsigned long LastBase[HOST_NUM_TIMERS];  //and of the one before
+   bool PAOverflow;                          //response still to be run
+   unsigned long Interrupts;                 //responses run
+   unsigned char Level[HOST_NUM_TIMERS][8];  //compare pin levels
+   HostEdge_t Edges[MAX_EDGES];              //pending captures, by time
+   unsigned char NumEdges;
+   pHostPeriodic Periodic[HOST_MAX_PERIODIC];
+   HostTime_t Period[HOST_MAX_PERIODIC];
+   HostTime_t NextRun[HOST_MAX_PERIODIC];
+   unsigned char NumPeriodic;
+   bool SPIBusy;
+   HostTime_t SPIDone;
+   unsigned char SPITx;
+   unsigned char SPIRx;
+   bool Selected;
+   unsigned char PortEIn;
+   unsigned char PortADIn;
+   pHostADSource ADSource;
+   pHostPinHook PinHook;
+   const HostSPISlave_t *Slave;
+} HostHWVars_t;
+
+static HostHWVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   HostResetHW
+
+ Description
+   Registers to their reset values (zero, SPIDR empty), time back to 0 and
+   no sources, hooks or pending edges.
+****************************************************************************/
+void HostResetHW(void)
+{
+   unsigned char t, c;
+
+   memset(&Vars, 0, sizeof(Vars));
+   PORTE = DDRE = PTT = PTIT = DDRT = PTS = DDRS = PTP = DDRP = 0;
+   PTU = DDRU = PTIAD = MODRR = 0;
+   for(t = 0; t < HOST_NUM_TIMERS; t++)
+   {
+      *Timers[t].TIOS = *Timers[t].TCTL1 = *Timers[t].TCTL2 = 0;
+      *Timers[t].TIE = *Timers[t].TSCR1 = *Timers[t].TSCR2 = 0;
+      *Timers[t].TCNT = 0;
+      for(c = 0; c < 8; c++)
+         *Timers[t].TC[c] = 0;
+   }
+   TIM0_TCTL3 = TIM0_TCTL4 = TIM0_TFLG1 = TIM0_TTOV = 0;
+   TIM1_TCTL3 = TIM1_TCTL4 = TIM1_TFLG1 = TIM1_TTOV = 0;
+   TIM2_TCTL3 = TIM2_TCTL4 = TIM2_TFLG1 = TIM2_TTOV = 0;
+   TIM0_OC7M = TIM0_OC7D = TIM0_PACTL = TIM0_PAFLG = 0;
+   TIM0_PACNT = 0;
+   PWME = PWMPOL = PWMCLK = PWMPRCLK = PWMCAE = PWMCTL = 0;
+   PWMSCLA = PWMSCLB = 0;
+   PWMPER01 = PWMPER23 = PWMPER45 = PWMDTY01 = PWMDTY23 = PWMDTY45 = 0;
+   PWMPER2 = PWMPER3 = PWMDTY2 = PWMDTY3 = 0;
+   SPICR1 = SPIBR = SPISR = 0;
+   SPICR2 = _S12_MODFEN;
+   SPIDR = SPIDR_READ;
+   Vars.SPIRx = 0;
+}
+
+/****************************************************************************
+ Function
+   HostNow
+
+ Returns
+   HostTime_t, the current virtual time in bus cycles
+****************************************************************************/
+HostTime_t HostNow(void)
+{
+   return Vars.Now;
+}
+
+/****************************************************************************
+ Function
+   HostAdvance
+
+ Parameters
+   HostTime_t : time to run the hardware up to
+
+ Description
+   Carry out every hardware event up to and including Until, in time
+   order, calling the interrupt responses they raise.
+****************************************************************************/
+void HostAdvance(HostTime_t Until)
+{
+   HostTime_t Next, When;
+   unsigned char Kind, Which, i;
+
+   for(;;)
+   {
+      Next = NO_EVENT;
+      Kind = EV_COMPARE;
+      Which = 0;
+      for(i = 0; i < HOST_NUM_TIMERS; i++)
+      {
+         When = NextCompare(i);
+         if(When < Next)
+         {
+            Next = When;
+            Kind = EV_COMPARE;
+            Which = i;
+         }
+      }
+      if(Vars.NumEdges > 0 && Vars.Edges[0].When < Next)
+      {
+         Next = Vars.Edges[0].When;
+         Kind = EV_CAPTURE;
+      }
+      if(Vars.SPIBusy && Vars.SPIDone < Next)
+      {
+         Next = Vars.SPIDone;
+         Kind = EV_SPI;
+      }
+      for(i = 0; i < Vars.NumPeriodic; i++)
+      {
+         if(Vars.NextRun[i] < Next)
+         {
+            Next = Vars.NextRun[i];
+            Kind = EV_PERIODIC;
+            Which = i;
+         }
+      }
+      if(Next > Until)
+         break;
+
+      Vars.Now = Next;
+      switch(Kind)
+      {
+         case EV_COMPARE:
+            DoCompares(Which);
+            break;
+         case EV_CAPTURE:
+            DoCapture();
+            break;
+         case EV_SPI:
+            DoSPI();
+            break;
+         default:
+            Vars.NextRun[Which] += Vars.Period[Which];
+            Vars.Periodic[Which](Vars.Now);
+            break;
+      }
+   }
+   Vars.Now = Until;
+}
+
+/****************************************************************************
+ Function
+   HostEnterFirmware, HostLeaveFirmware
+
+ Description
+   Wrap every call into the firmware. Enter brings the counters and input
+   pins up to date, Leave acts on what the firmware wrote: the SS line and
+   SPIDR.
+****************************************************************************/
+void HostEnterFirmware(void)
+{
+   unsigned char t;
+
+   for(t = 0; t < HOST_NUM_TIMERS; t++)
+      *Timers[t].TCNT = (unsigned int)HostCounter(t, Vars.Now);
+   PORTE = (PORTE & DDRE) | (Vars.PortEIn & ~DDRE);
+   PTIT = PTT;
+   PTIAD = Vars.PortADIn;
+}
+
+void HostLeaveFirmware(void)
+{
+   bool Selected = (DDRS & SS_PIN) && !(PTS & SS_PIN);
+
+   if(Selected != Vars.Selected)
+   {
+      Vars.Selected = Selected;
+      if(Vars.Slave != 0)
+      {
+         if(Selected)
+            Vars.Slave->Select(Vars.Now);
+         else
+            Vars.Slave->Release(Vars.Now);
+      }
+   }
+
+   if(SPIDR < SPIDR_READ)
+   {
+      if(!Vars.SPIBusy && (SPICR1 & _S12_SPE) && (SPICR1 & _S12_MSTR))
+      {
+         Vars.SPITx = (unsigned char)SPIDR;
+         Vars.SPIBusy = true;
+         Vars.SPIDone = Vars.Now + SPIByteTime();
+         SPISR &= ~_S12_SPIF;
+      }
+      SPIDR = SPIDR_READ | Vars.SPIRx;
+   }
+}
+
+/****************************************************************************
+ Function
+   HostSetADSource, HostSetPinHook, HostSetSPISlave
+
+ Description
+   Connect the simulated world: where A/D readings come from, who hears
+   about output compare pin changes and what sits on the SPI port.
+****************************************************************************/
+void HostSetADSource(pHostADSource Source)
+{
+   Vars.ADSource = Source;
+}
+
+void HostSetPinHook(pHostPinHook Hook)
+{
+   Vars.PinHook = Hook;
+}
+
+void HostSetSPISlave(const HostSPISlave_t *Slave)
+{
+   Vars.Slave = Slave;
+}
+
+/****************************************************************************
+ Function
+   HostAddPeriodic
+
+ Parameters
+   pHostPeriodic : called every Period, first at Period
+   HostTime_t : period in bus cycles
+
+ Returns
+   bool, false if there is no room
+****************************************************************************/
+bool HostAddPeriodic(pHostPeriodic Periodic, HostTime_t Period)
+{
+   if(Vars.NumPeriodic >= HOST_MAX_PERIODIC || Period == 0)
+      return false;
+   Vars.Periodic[Vars.NumPeriodic] = Periodic;
+   Vars.Period[Vars.NumPeriodic] = Period;
+   Vars.NextRun[Vars.NumPeriodic] = Vars.Now + Period;
+   Vars.NumPeriodic++;
+   return true;
+}
+
+/****************************************************************************
+ Function
+   HostCapture
+
+ Parameters
+   unsigned char : timer module
+   unsigned char : channel
+   HostTime_t : when the edge arrives, not before now
+
+ Returns
+   bool, false if the edge can not be queued
+
+ Description
+   An active edge on an input capture pin. The count at that time is
+   latched and the channel's response called, if the channel is set up
+   for input capture with its interrupt enabled.
+****************************************************************************/
+bool HostCapture(unsigned char Timer, unsigned char Channel,
+                 HostTime_t When)
+{
+   unsigned char i;
+
+   if(Vars.NumEdges >= MAX_EDGES || When < Vars.Now)
+      return false;
+   i = Vars.NumEdges;
+   while(i > 0 && Vars.Edges[i - 1].When > When)
+   {
+      Vars.Edges[i] = Vars.Edges[i - 1];
+      i--;
+   }
+   Vars.Edges[i].When = When;
+   Vars.Edges[i].Timer = Timer;
+   Vars.Edges[i].Channel = Channel;
+   Vars.NumEdges++;
+   return true;
+}
+
+/****************************************************************************
+ Function
+   HostSetPortE, HostSetPortAD
+
+ Description
+   Levels on the input pins of PORTE (knight colour switch) and port AD.
+****************************************************************************/
+void HostSetPortE(unsigned char Inputs)
+{
+   Vars.PortEIn = Inputs;
+}
+
+void HostSetPortAD(unsigned char Inputs)
+{
+   Vars.PortADIn = Inputs;
+}
+
+/****************************************************************************
+ Function
+   HostCounter, HostCountTime
+
+ Description
+   Count of a timer module at a time, and the time a count is reached,
+   both since the counter was last reset.
+****************************************************************************/
+unsigned long HostCounter(unsigned char Timer, HostTime_t When)
+{
+   unsigned long Raw = (unsigned long)(When >> Prescale(Timer));
+
+   return Raw - CountBase(Timer, Raw);
+}
+
+HostTime_t HostCountTime(unsigned char Timer, unsigned long Count)
+{
+   return (HostTime_t)(Count + Vars.Base[Timer]) << Prescale(Timer);
+}
+
+/****************************************************************************
+ Function
+   HostInterrupts
+
+ Returns
+   unsigned long, interrupt responses run since HostResetHW
+****************************************************************************/
+unsigned long HostInterrupts(void)
+{
+   return Vars.Interrupts;
+}
+
+/****************************************************************************
+ Function
+   HostPWMDuty
+
+ Parameters
+   unsigned char : PWM channel, the high order one of a concatenated pair
+
+ Returns
+   double, fraction of the period the output is high, 0 when disabled
+****************************************************************************/
+double HostPWMDuty(unsigned char Channel)
+{
+   static volatile unsigned char * const Period8[6] =
+      {&PWMPER0, &PWMPER1, &PWMPER2, &PWMPER3, &PWMPER4, &PWMPER5};
+   static volatile unsigned char * const Duty8[6] =
+      {&PWMDTY0, &PWMDTY1, &PWMDTY2, &PWMDTY3, &PWMDTY4, &PWMDTY5};
+   unsigned char Bit = 1 << Channel;
+   unsigned long Period, Duty;
+   double High;
+
+   if(Channel > 5 || !(PWME & Bit))
+      return 0;
+   if(Channel == 1 && (PWMCTL & _S12_CON01))
+   {
+      Period = PWMPER01;
+      Duty = PWMDTY01;
+   }
+   else if(Channel == 3 && (PWMCTL & _S12_CON23))
+   {
+      Period = PWMPER23;
+      Duty = PWMDTY23;
+   }
+   else if(Channel == 5 && (PWMCTL & _S12_CON45))
+   {
+      Period = PWMPER45;
+      Duty = PWMDTY45;
+   }
+   else
+   {
+      Period = *Period8[Channel];
+      Duty = *Duty8[Channel];
+   }
+   if(Period == 0)
+      return 0;
+   High = (Duty >= Period) ? 1.0 : (double)Duty / Period;
+   return (PWMPOL & Bit) ? High : 1.0 - High;
+}
+
+/****************************************************************************
+ Function
+   HostServoWidth
+
+ Parameters
+   unsigned char : servo channel, 0-2 (TIM1 channels 4-6)
+
+ Returns
+   unsigned int, pulse width in us, 0 if the channel is not running
+
+ Description
+   Servos.c sets the pin at the compare and lets the overflow clear it, so
+   the pulse is the counts from the compare to the end of the count.
+****************************************************************************/
+unsigned int HostServoWidth(unsigned char Channel)
+{
+   unsigned char Ch = 4 + Channel;
+   unsigned long Counts;
+
+   if(!(TIM1_TSCR1 & _S12_TEN) || !(TIM1_TIOS & (1 << Ch)))
+      return 0;
+   Counts = COMPARE_MASK - (*Timers[HOST_TIM1].TC[Ch] & COMPARE_MASK);
+   return (unsigned int)((Counts << Prescale(HOST_TIM1)) /
+                         HOST_CYCLES_PER_US);
+}
+
+/****************************************************************************
+ Function
+   ADS12_Init, ADS12_ReadADPin
+
+ Description
+   The A/D library calls. Readings come from the installed source, 0 if
+   there is none.
+****************************************************************************/
+signed char ADS12_Init(char *Modes)
+{
+   (void)Modes;
+   return 0;
+}
+
+short ADS12_ReadADPin(unsigned char Pin)
+{
+   if(Vars.ADSource == 0)
+      return 0;
+   return Vars.ADSource(Pin);
+}
+
+/****************************************************************************
+ Function
+   HostGetHWVars
+
+ Returns
+   StateBlock_t, where the emulation's own running state
+   lives: time, pin levels, pending captures, periodic sources, SPI
+****************************************************************************/
+StateBlock_t HostGetHWVars(void)
+{
+   StateBlock_t Block;
+
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+
+/****************************************************************************
+ Function
+   HostGetRegisters
+
+ Returns
+   StateBlock_t, every emulated register (mc9s12e128.h)
+****************************************************************************/
+StateBlock_t HostGetRegisters(void)
+{
+   StateBlock_t Block;
+
+   Block.Data = __start_host_regs;
+   Block.Size = __stop_host_regs - __start_host_regs;
+   return Block;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Prescale
+  ---------------------
+  Prescale of a timer module as a shift.
+*/
+static unsigned char Prescale(unsigned char Timer)
+{
+   return *Timers[Timer].TSCR2 & (_S12_PR2 | _S12_PR1 | _S12_PR0);
+}
+
+/* Function: PinAction
+  ----------------------
+  OMn:OLn of a channel: 0 none, 1 toggle, 2 clear, 3 set.
+*/
+static unsigned char PinAction(unsigned char Timer, unsigned char Channel)
+{
+   const HostTimer_t *Tim = &Timers[Timer];
+
+   if(Channel >= 4)
+      return (*Tim->TCTL1 >> (2*(Channel - 4))) & 0x03;
+   return (*Tim->TCTL2 >> (2*Channel)) & 0x03;
+}
+
+/* Function: NextCompare
+  ------------------------
+  Time of the next compare instant still to be handled on a timer module
+  that has any channel with an interrupt or a pin action, or NO_EVENT.
+*/
+static HostTime_t NextCompare(unsigned char Timer)
+{
+   const HostTimer_t *Tim = &Timers[Timer];
+   HostTime_t Best = NO_EVENT, When;
+   unsigned long Raw, Base, From, Match;
+   unsigned char c;
+   bool Seven;
+
+   if(!(*Tim->TSCR1 & _S12_TEN) || *Tim->TIOS == 0)
+      return NO_EVENT;
+   Raw = (unsigned long)(Vars.Now >> Prescale(Timer));
+   if(((HostTime_t)Raw << Prescale(Timer)) < Vars.Now ||
+      Vars.CompareDone[Timer] == Vars.Now)
+      Raw++;
+   Base = CountBase(Timer, Raw);
+   From = Raw - Base;
+   Seven = (*Tim->TSCR2 & _S12_TCRE) ||
+           (Timer == HOST_TIM0 && TIM0_OC7M != 0);
+   for(c = 0; c < 8; c++)
+   {
+      if(!(*Tim->TIOS & (1 << c)))
+         continue;
+      if(!(*Tim->TIE & (1 << c)) && PinAction(Timer, c) == 0 &&
+         !(c == 7 && Seven))
+         continue;
+      Match = From + (((unsigned long)*Tim->TC[c] - From) & COMPARE_MASK);
+      When = (HostTime_t)(Match + Base) << Prescale(Timer);
+      if(When < Best)
+         Best = When;
+   }
+   return Best;
+}
+
+/* Function: CountBase
+  ----------------------
+  Bus count (cycles shifted down by the prescale) the counter was last
+  reset at, for a Raw count at or after the reset before that.
+*/
+static unsigned long CountBase(unsigned char Timer, unsigned long Raw)
+{
+   return (Raw >= Vars.Base[Timer]) ? Vars.Base[Timer] :
+                                      Vars.LastBase[Timer];
+}
+
+/* Function: DoCompares
+  -----------------------
+  Every channel of the timer module that matches now: pin actions first,
+  all at once as the hardware does them, with channel 7's OC7M pins and
+  counter reset last, then the interrupt responses in priority order
+  (channel 0 first) and the pulse accumulator's.
+*/
+static void DoCompares(unsigned char Timer)
+{
+   const HostTimer_t *Tim = &Timers[Timer];
+   unsigned long Count = HostCounter(Timer, Vars.Now);
+   unsigned char Matched = 0, c;
+
+   for(c = 0; c < 8; c++)
+   {
+      if((*Tim->TIOS & (1 << c)) &&
+         ((*Tim->TC[c] ^ Count) & COMPARE_MASK) == 0)
+         Matched |= 1 << c;
+   }
+   for(c = 0; c < 8; c++)
+   {
+      if(Matched & (1 << c))
+         DoAction(Timer, c, PinAction(Timer, c));
+   }
+   if(Matched & 0x80)
+   {
+      if(*Tim->TSCR2 & _S12_TCRE)
+      {
+         Vars.LastBase[Timer] = Vars.Base[Timer];
+         Vars.Base[Timer] = (unsigned long)(Vars.Now >> Prescale(Timer)) + 1;
+      }
+   }
+   Vars.CompareDone[Timer] = Vars.Now;
+   for(c = 0; c < 8; c++)
+   {
+      if((Matched & (1 << c)) && (*Tim->TIE & (1 << c)))
+         RunResponse(Tim->Response[c]);
+   }
+   if(Vars.PAOverflow)
+   {
+      Vars.PAOverflow = false;
+      RunResponse(WaveTrainEnd);
+   }
+}
+
+/* Function: DoAction
+  ---------------------
+  A compare's pin action on its own pin (0 none, 1 toggle, 2 clear,
+  3 set), and for TIM0 channel 7 the OC7D levels on the OC7M pins.
+*/
+static void DoAction(unsigned char Timer, unsigned char Channel,
+                     unsigned char Action)
+{
+   unsigned char c;
+
+   if(Action == 1)
+      SetPin(Timer, Channel, !Vars.Level[Timer][Channel]);
+   else if(Action != 0)
+      SetPin(Timer, Channel, Action == 3);
+   if(Timer != HOST_TIM0 || Channel != 7)
+      return;
+   for(c = 0; c < 8; c++)
+   {
+      if(TIM0_OC7M & (1 << c))
+         SetPin(Timer, c, (TIM0_OC7D >> c) & 1);
+   }
+}
+
+/* Function: SetPin
+  -------------------
+  Drive a compare pin, telling the pin hook and, for PT7, the pulse
+  accumulator when it changes.
+*/
+static void SetPin(unsigned char Timer, unsigned char Channel,
+                   unsigned char Level)
+{
+   const HostTimer_t *Tim = &Timers[Timer];
+   bool Rising;
+
+   if(Level == Vars.Level[Timer][Channel])
+      return;
+   Vars.Level[Timer][Channel] = Level;
+   if(Tim->Port != 0)
+   {
+      if(Level)
+         *Tim->Port |= 1 << Channel;
+      else
+         *Tim->Port &= ~(1 << Channel);
+   }
+   if(Vars.PinHook != 0)
+      Vars.PinHook(Timer, Channel, Level, Vars.Now);
+
+   if(Timer != HOST_TIM0 || Channel != 7 || !(TIM0_PACTL & _S12_PAEN) ||
+      (TIM0_PACTL & _S12_PAMOD))
+      return;
+   Rising = (TIM0_PACTL & _S12_PEDGE) != 0;
+   if((Level != 0) != Rising)
+      return;
+   TIM0_PACNT = (TIM0_PACNT + 1) & COMPARE_MASK;
+   if(TIM0_PACNT == 0 && (TIM0_PACTL & _S12_PAOVI))
+      Vars.PAOverflow = true;
+}
+
+/* Function: DoCapture
+  ----------------------
+  The earliest pending input capture edge.
+*/
+static void DoCapture(void)
+{
+   HostEdge_t Edge = Vars.Edges[0];
+   const HostTimer_t *Tim = &Timers[Edge.Timer];
+   unsigned char Bit = 1 << Edge.Channel;
+
+   Vars.NumEdges--;
+   memmove(&Vars.Edges[0], &Vars.Edges[1],
+           Vars.NumEdges * sizeof(Vars.Edges[0]));
+   if(!(*Tim->TSCR1 & _S12_TEN) || (*Tim->TIOS & Bit))
+      return;
+   *Tim->TC[Edge.Channel] = (unsigned int)HostCounter(Edge.Timer,
+                                                       Edge.When);
+   if(*Tim->TIE & Bit)
+      RunResponse(Tim->Response[Edge.Channel]);
+}
+
+/* Function: DoSPI
+  ------------------
+  Byte shifted: swap with the slave (0xFF from the pulled up MISO if
+  there is none), set SPIF and interrupt if enabled.
+*/
+static void DoSPI(void)
+{
+   Vars.SPIBusy = false;
+   if(Vars.Slave != 0 && Vars.Selected)
+      Vars.SPIRx = Vars.Slave->Exchange(Vars.SPITx, Vars.Now);
+   else
+      Vars.SPIRx = 0xFF;
+   SPIDR = SPIDR_READ | Vars.SPIRx;
+   SPISR |= _S12_SPIF;
+   if(SPICR1 & _S12_SPIE)
+      RunResponse(SPIByte);
+}
+
+/* Function: RunResponse
+  ------------------------
+  Call an interrupt response, if there is one linked in.
+*/
+static void RunResponse(pResponse Response)
+{
+   if(Response == 0)
+      return;
+   Vars.Interrupts++;
+   HostEnterFirmware();
+   Response();
+   HostLeaveFirmware();
+}
+
+/* Function: SPIByteTime
+  ------------------------
+  Eight bit times at the baud rate set in SPIBR.
+*/
+static HostTime_t SPIByteTime(void)
+{
+   unsigned int Sppr = (SPIBR >> 4) & 0x07;
+   unsigned int Spr = SPIBR & 0x07;
+
+   return 8ULL * (Sppr + 1) * (2ULL << Spr);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
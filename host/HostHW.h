@@ -0,0 +1,67 @@
+/****************************************************************************
+  Header file for the host emulation of the E128 peripherals the firmware
+  uses: ports, the three timer modules, PWM, SPI and the A/D.
+*****************************************************************************/
+#ifndef HostHW_H
+#define HostHW_H
+
+#include "ES_Types.h"
+#include "Snapshot.h"
+
+//Virtual time is counted in 24MHz bus cycles
+typedef unsigned long long HostTime_t;
+
+#define HOST_CYCLES_PER_MS 24000ULL
+#define HOST_CYCLES_PER_US 24ULL
+#define HOST_MS(ms) ((HostTime_t)((ms) * (double)HOST_CYCLES_PER_MS))
+
+//Timer modules
+#define HOST_TIM0 0
+#define HOST_TIM1 1
+#define HOST_TIM2 2
+#define HOST_NUM_TIMERS 3
+
+//Largest number of periodic sources (framework tick, arena physics...)
+#define HOST_MAX_PERIODIC 4
+
+typedef short (*pHostADSource)(unsigned char Pin);
+typedef void (*pHostPinHook)(unsigned char Timer, unsigned char Channel,
+                             unsigned char Level, HostTime_t When);
+typedef void (*pHostPeriodic)(HostTime_t Now);
+
+//A slave on the SPI port. Select and Release follow the SS line (PS7),
+//Exchange takes the byte the master shifted out and returns the one
+//shifted back
+typedef struct
+{
+   void (*Select)(HostTime_t When);
+   unsigned char (*Exchange)(unsigned char Out, HostTime_t When);
+   void (*Release)(HostTime_t When);
+} HostSPISlave_t;
+
+// Public Function Prototypes
+void HostResetHW(void);
+HostTime_t HostNow(void);
+void HostAdvance(HostTime_t Until);
+void HostEnterFirmware(void);
+void HostLeaveFirmware(void);
+
+void HostSetADSource(pHostADSource Source);
+void HostSetPinHook(pHostPinHook Hook);
+void HostSetSPISlave(const HostSPISlave_t *Slave);
+bool HostAddPeriodic(pHostPeriodic Periodic, HostTime_t Period);
+bool HostCapture(unsigned char Timer, unsigned char Channel,
+                 HostTime_t When);
+void HostSetPortE(unsigned char Inputs);
+void HostSetPortAD(unsigned char Inputs);
+
+unsigned long HostCounter(unsigned char Timer, HostTime_t When);
+HostTime_t HostCountTime(unsigned char Timer, unsigned long Count);
+unsigned long HostInterrupts(void);
+double HostPWMDuty(unsigned char Channel);
+unsigned int HostServoWidth(unsigned char Channel);
+
+StateBlock_t HostGetHWVars(void);
+StateBlock_t HostGetRegisters(void);
+
+#endif /* HostHW_H */
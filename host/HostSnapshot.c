@@ -0,0 +1,113 @@
+/****************************************************************************
+ Module
+   HostSnapshot.c
+
+ Revision
+   1.0.1
+
+ Description
+   Saves everything a host match runs on into one buffer and puts it
+   back: the firmware modules' Vars (SaveSnapshot), the framework's event
+   queues and timers (ES_Host.c), the emulated registers and hardware
+   state (HostHW.c), the field (Arena.c) and the JSR (SimJSR.c). After a
+   restore the match carries on exactly as it did from the save, so one
+   prefix can be run on many ways.
+
+ Notes
+   The buffer holds pointers to functions and module data, so it is only
+   good in the process that saved it. What is set once before the firmware
+   starts (fault rates, the sensor source, the JSR timeline) is not in it.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 19:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <string.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Host.h"
+#include "Snapshot.h"
+#include "Arena.h"
+#include "SimJSR.h"
+#include "HostSnapshot.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+typedef StateBlock_t (*pGetVars)(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+//The host's blocks, in the order they follow the firmware's in the buffer
+static const pGetVars Blocks[] =
+{
+   ES_HostGetVars,
+   HostGetHWVars,
+   HostGetRegisters,
+   ArenaGetVars,
+   SimJSRGetVars
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   HostSnapshotSize
+
+ Returns
+   unsigned int, bytes needed by HostSaveSnapshot
+****************************************************************************/
+unsigned int HostSnapshotSize(void)
+{
+   unsigned int Size = SnapshotSize();
+   unsigned char i;
+
+   for(i = 0; i < ARRAY_SIZE(Blocks); i++)
+      Size += Blocks[i]().Size;
+   return Size;
+}
+
+/****************************************************************************
+ Function
+   HostSaveSnapshot
+
+ Parameters
+   unsigned char* : at least HostSnapshotSize bytes
+****************************************************************************/
+void HostSaveSnapshot(unsigned char *Buf)
+{
+   StateBlock_t Block;
+   unsigned char i;
+
+   SaveSnapshot(Buf);
+   Buf += SnapshotSize();
+   for(i = 0; i < ARRAY_SIZE(Blocks); i++)
+   {
+      Block = Blocks[i]();
+      memcpy(Buf, Block.Data, Block.Size);
+      Buf += Block.Size;
+   }
+}
+
+/****************************************************************************
+ Function
+   HostRestoreSnapshot
+
+ Parameters
+   unsigned char* : a buffer filled by HostSaveSnapshot in this process
+****************************************************************************/
+void HostRestoreSnapshot(const unsigned char *Buf)
+{
+   StateBlock_t Block;
+   unsigned char i;
+
+   RestoreSnapshot(Buf);
+   Buf += SnapshotSize();
+   for(i = 0; i < ARRAY_SIZE(Blocks); i++)
+   {
+      Block = Blocks[i]();
+      memcpy(Block.Data, Buf, Block.Size);
+      Buf += Block.Size;
+   }
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,14 @@
+/****************************************************************************
+  Header file for whole host snapshots: the firmware's own (Snapshot.c)
+  together with the framework stand-in, the emulated hardware and the
+  simulated field and JSR, so a match can be carried on from any point.
+*****************************************************************************/
+#ifndef HostSnapshot_H
+#define HostSnapshot_H
+
+// Public Function Prototypes
+unsigned int HostSnapshotSize(void);
+void HostSaveSnapshot(unsigned char *Buf);
+void HostRestoreSnapshot(const unsigned char *Buf);
+
+#endif /* HostSnapshot_H */
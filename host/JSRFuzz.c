@@ -0,0 +1,294 @@
+/****************************************************************************
+ Module
+   JSRFuzz.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host fuzz harness and throughput benchmark for the JSR reply decoder
+   (JSRDecode.c). The fuzz run feeds the decoder made up queries and
+   replies, mostly well formed, some with bad framing, unknown queries,
+   bytes missing or bytes past the end, and checks every record it gives
+   (and every one it does not) against a model of the protocol written
+   from the JSR spec. The benchmark decodes good replies as fast as it can.
+
+     JSRFuzz: 1000000 frames, 843190 records, 0 mismatches
+     JSRFuzz: 20000000 frames in 0.644s, 31.1M frames/s (sum 2618493817)
+
+   Usage: JSRFuzz [-s seed] [-n frames] [-b frames]
+     -s  seed for the made up frames, 1 by default
+     -n  frames to fuzz, 1000000 by default
+     -b  frames to decode for the benchmark, none by default
+
+   Exits 1 on any mismatch.
+
+ Notes
+   A frame is one JSRDecodeStart and the bytes clocked back after it.
+   The model only says whether a frame gives a record and what it holds;
+   the decoder has to give it on the fourth byte and never after.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 14:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <S12E128bits.h>
+#include "ES_Framework.h"
+#include "JSRcommand.h"
+#include "JSRDecode.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_FRAME 8
+#define REPLY_BYTES 4
+#define BENCH_FRAMES 4096        //distinct frames the benchmark cycles over
+#define MAX_REPORTS 10
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+   unsigned char Query;
+   unsigned char ReloadMask;
+   unsigned char Length;
+   unsigned char Bytes[MAX_FRAME];
+} JSRFrame_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void MakeFrame(JSRFrame_t *Frame, bool Good);
+static bool Model(const JSRFrame_t *Frame, JSRRecord_t *Want);
+static bool CheckFrame(const JSRFrame_t *Frame);
+static void Report(const JSRFrame_t *Frame, const char *What);
+static void Bench(unsigned long Frames);
+static unsigned long Random(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place
+typedef struct
+{
+   unsigned long long Random;
+   unsigned long Records;
+   unsigned long Mismatches;
+} JSRFuzzVars_t;
+
+static JSRFuzzVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+   unsigned long Seed = 1, Frames = 1000000, BenchFrames = 0, i;
+   JSRFrame_t Frame;
+   int Option;
+
+   while((Option = getopt(argc, argv, "s:n:b:")) != -1)
+   {
+      switch(Option)
+      {
+         case 's':
+            Seed = strtoul(optarg, 0, 0);
+            break;
+         case 'n':
+            Frames = strtoul(optarg, 0, 0);
+            break;
+         case 'b':
+            BenchFrames = strtoul(optarg, 0, 0);
+            break;
+         default:
+            fprintf(stderr, "usage: %s [-s seed] [-n frames] [-b frames]\n",
+                    argv[0]);
+            return 2;
+      }
+   }
+
+   Vars.Random = Seed * 0x9E3779B97F4A7C15ULL + 1;
+   for(i = 0; i < Frames; i++)
+   {
+      MakeFrame(&Frame, (Random() % 4) != 0);
+      if(!CheckFrame(&Frame) && Vars.Mismatches >= MAX_REPORTS)
+         break;
+   }
+   printf("JSRFuzz: %lu frames, %lu records, %lu mismatches\n", i,
+          Vars.Records, Vars.Mismatches);
+   if(BenchFrames != 0)
+      Bench(BenchFrames);
+   return (Vars.Mismatches == 0) ? 0 : 1;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: MakeFrame
+  ----------------------
+  A good frame is a whole reply to a real query. Otherwise each part is
+  right most of the time, so the broken frames stay close to good ones.
+*/
+static void MakeFrame(JSRFrame_t *Frame, bool Good)
+{
+   unsigned char i;
+
+   Frame->Query = (Random() & 1) ? STATUS_QUERY : SCORE_QUERY;
+   Frame->ReloadMask = (Random() & 1) ? RED_RELOAD_STATUS :
+                                        DARK_RELOAD_STATUS;
+   Frame->Length = REPLY_BYTES;
+   for(i = 0; i < MAX_FRAME; i++)
+      Frame->Bytes[i] = Random();
+   Frame->Bytes[0] = 0x00;
+   Frame->Bytes[1] = 0xFF;
+   if(Good)
+      return;
+
+   if(Random() % 4 == 0)
+      Frame->Query = Random();
+   if(Random() % 4 == 0)
+      Frame->Length = Random() % (MAX_FRAME + 1);
+   if(Random() % 4 == 0)
+      Frame->Bytes[0] = Random();
+   if(Random() % 4 == 0)
+      Frame->Bytes[1] = Random();
+}
+
+/* Function: Model
+  ------------------
+  What the frame should decode to, from the protocol alone.
+*/
+static bool Model(const JSRFrame_t *Frame, JSRRecord_t *Want)
+{
+   const unsigned char *Bytes = Frame->Bytes;
+
+   if(Frame->Length < REPLY_BYTES || Bytes[0] != 0x00 || Bytes[1] != 0xFF)
+      return false;
+   if(Frame->Query == STATUS_QUERY)
+   {
+      Want->Kind = JSR_STATUS_RECORD;
+      Want->Command = Bytes[3] & (BIT0HI | BIT1HI | BIT2HI);
+      Want->HeadStatus = Bytes[3] & BIT7HI;
+      Want->ReloadStatus = Bytes[3] & Frame->ReloadMask;
+      return true;
+   }
+   if(Frame->Query == SCORE_QUERY)
+   {
+      Want->Kind = JSR_SCORE_RECORD;
+      Want->RedScore = Bytes[2];
+      Want->DarkScore = Bytes[3];
+      return true;
+   }
+   return false;
+}
+
+/* Function: CheckFrame
+  -----------------------
+  Decode one frame and hold it against the model. False on a mismatch.
+*/
+static bool CheckFrame(const JSRFrame_t *Frame)
+{
+   JSRDecoder_t Decoder;
+   JSRRecord_t Got, Want = {0};
+   bool Expected = Model(Frame, &Want);
+   unsigned char i, Given = 0, GivenAt = 0;
+
+   JSRDecodeStart(&Decoder, Frame->Query, Frame->ReloadMask);
+   for(i = 0; i < Frame->Length; i++)
+   {
+      if(JSRDecodeByte(&Decoder, Frame->Bytes[i], &Got))
+      {
+         Given++;
+         GivenAt = i;
+      }
+   }
+
+   if(!Expected && Given == 0)
+      return true;
+   if(!Expected)
+   {
+      Report(Frame, "record from a frame that should give none");
+      return false;
+   }
+   if(Given != 1 || GivenAt != REPLY_BYTES - 1)
+   {
+      Report(Frame, "record missing, repeated or early");
+      return false;
+   }
+   Vars.Records++;
+   if(Got.Kind != Want.Kind ||
+      (Want.Kind == JSR_STATUS_RECORD &&
+       (Got.Command != Want.Command || Got.HeadStatus != Want.HeadStatus ||
+        Got.ReloadStatus != Want.ReloadStatus)) ||
+      (Want.Kind == JSR_SCORE_RECORD &&
+       (Got.RedScore != Want.RedScore || Got.DarkScore != Want.DarkScore)))
+   {
+      Report(Frame, "wrong record");
+      return false;
+   }
+   return true;
+}
+
+/* Function: Report
+  -------------------
+  Count a mismatch, print the first few.
+*/
+static void Report(const JSRFrame_t *Frame, const char *What)
+{
+   unsigned char i;
+
+   if(Vars.Mismatches++ >= MAX_REPORTS)
+      return;
+   printf("JSRFuzz: %s: query %02X mask %02X bytes", What, Frame->Query,
+          Frame->ReloadMask);
+   for(i = 0; i < Frame->Length; i++)
+      printf(" %02X", Frame->Bytes[i]);
+   printf("\n");
+}
+
+/* Function: Bench
+  ------------------
+  Decode good frames back to back and print the rate.
+*/
+static void Bench(unsigned long Frames)
+{
+   static JSRFrame_t Set[BENCH_FRAMES];
+   JSRDecoder_t Decoder;
+   JSRRecord_t Record = {0};
+   const JSRFrame_t *Frame;
+   struct timespec Start, End;
+   unsigned long i, Sum = 0;
+   unsigned char b;
+   double Seconds;
+
+   for(i = 0; i < BENCH_FRAMES; i++)
+      MakeFrame(&Set[i], true);
+
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+   for(i = 0; i < Frames; i++)
+   {
+      Frame = &Set[i % BENCH_FRAMES];
+      JSRDecodeStart(&Decoder, Frame->Query, Frame->ReloadMask);
+      for(b = 0; b < REPLY_BYTES; b++)
+      {
+         if(JSRDecodeByte(&Decoder, Frame->Bytes[b], &Record))
+            Sum += Record.Command + Record.DarkScore;
+      }
+   }
+   clock_gettime(CLOCK_MONOTONIC, &End);
+
+   Seconds = (End.tv_sec - Start.tv_sec) +
+             (End.tv_nsec - Start.tv_nsec) / 1e9;
+   printf("JSRFuzz: %lu frames in %.3fs, %.1fM frames/s (sum %lu)\n",
+          Frames, Seconds, Frames / Seconds / 1e6, Sum);
+}
+
+/* Function: Random
+  -------------------
+  xorshift64*, so a seed gives the same frames everywhere.
+*/
+static unsigned long Random(void)
+{
+   Vars.Random ^= Vars.Random >> 12;
+   Vars.Random ^= Vars.Random << 25;
+   Vars.Random ^= Vars.Random >> 27;
+   return (unsigned long)((Vars.Random * 0x2545F4914F6CDD1DULL) >> 32);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,359 @@
+/****************************************************************************
+ Module
+   Match.c
+
+ Revision
+   1.0.1
+
+ Description
+   Runs the unmodified firmware through one simulated match on the host
+   and prints how it went as one RESULT line:
+
+     RESULT seed=7 us=14 them=11 win=1 home=UT-- homet=6.39,-,-,-
+            goals=1 hits=0 lance=1 lost=0 jsrbad=0
+
+   home gives who got home first in each round (U us, T them, - nobody),
+   homet how many seconds into the round we got there, where we did,
+   lost the events dropped on full service queues, jsrbad the JSR
+   queries that broke its timing or mode rules.
+
+   Usage: Match [-v] [-s seed] [-j timeline] [-f faults] [-d]
+                [-c seconds [-k branches]]
+     -v  print the referee's calls and the scoring as they happen
+     -s  seed for the arena, 1 by default
+     -j  play a JSR timeline (see SimJSR.c) instead of the referee's own
+         timing; the arena calls its phases from the timeline
+     -f  fault rates, FAULT_INJECT builds only (Fault.c), as a list of
+         name=value from spike, spikesize, spicorrupt, spidrop, postdrop,
+         delay and delayticks; the chances are in 256ths, spikesize in
+         A/D counts and delayticks in timer ticks:
+           -f spike=8,spikesize=200,spicorrupt=4,postdrop=2
+     -d  dump the sensor recording (Recorder.c) before the RESULT line,
+         SENSOR_RECORD builds only; Replay.c plays it back
+     -c  snapshot the match this many seconds in and play it out from
+         there once per branch, one RESULT line each with branch= last
+     -k  branches, 2 by default. Branch b draws from seed*65536+b from
+         the snapshot on. Branch 0 carries on with the arena's own draws
+         and is played last, after the others, so it plays the same match
+         as a run without -c only if the snapshot put everything back
+
+ Notes
+   Boots as main does on the target: InitServos, then ES_Initialize. The
+   phases reach the Bot the way they do on the field, through JSRcommand
+   querying the simulated JSR over SPI.
+   The faults are seeded from the arena's seed, so a seed gives the same
+   faults at the same points every time it is run with the same rates.
+   A snapshot (HostSnapshot.c) takes the firmware, the framework's queues
+   and timers, the hardware and the field, so the branches share the
+   prefix and only pay for the rest of the match.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 20:00 PS      -d dumps the sensor recording
+ 04/30/14 19:00 PS      -c and -k branch a match from a snapshot
+ 04/30/14 18:00 PS      -f sets the fault rates in FAULT_INJECT builds
+ 04/30/14 17:00 PS      homet, our home times, on the RESULT line
+ 04/30/14 11:00 PS      Phases reach the Bot over SPI from the simulated JSR,
+                        -j plays a JSR timeline
+ 04/29/14 16:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Host.h"
+#include "Fault.h"
+#include "Recorder.h"
+#include "Arena.h"
+#include "JSRcommand.h"
+#include "SimJSR.h"
+#include "HostSnapshot.h"
+#include "Servos.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MATCH_LIMIT 240.0     //seconds, well past any real match
+#define END_RUN_ON 1.0        //seconds run after the end
+#define BRANCH_SEED_SHIFT 16
+#define FAULT_SEED_STRIDE 0x9E37u  //keeps near seeds' fault streams apart
+
+/*---------------------------- Module Types -------------------------------*/
+//A -f name and the FaultRates_t field it sets
+typedef struct
+{
+   const char *Name;
+   size_t Offset;
+   bool Wide;                  //an unsigned int, else a chance in 256ths
+} MatchFault_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Play(HostTime_t Until);
+static void Report(unsigned long Seed, int Branch);
+static ArenaPhase_t TimelinePhase(void);
+static bool ParseFaults(char *List, FaultRates_t *Rates);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const MatchFault_t Faults[] =
+{
+   {"spike", offsetof(FaultRates_t, SensorSpike), false},
+   {"spikesize", offsetof(FaultRates_t, SpikeSize), true},
+   {"spicorrupt", offsetof(FaultRates_t, SPICorrupt), false},
+   {"spidrop", offsetof(FaultRates_t, SPIDrop), false},
+   {"postdrop", offsetof(FaultRates_t, PostDrop), false},
+   {"delay", offsetof(FaultRates_t, TimerDelay), false},
+   {"delayticks", offsetof(FaultRates_t, DelayTicks), true}
+};
+
+//Running state, all in one place
+typedef struct
+{
+   bool Timeline;             //phases called from a JSR timeline
+   HostTime_t EndTime;        //when to stop, once the match is over
+   bool Dump;                 //dump the sensor recording with the result
+} MatchVars_t;
+
+static MatchVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+   unsigned long Seed = 1;
+   bool Verbose = false;
+   FILE *Timeline;
+   const char *TimelineName = 0;
+   char *FaultList = 0;
+   FaultRates_t Rates = {0};
+   double Checkpoint = -1.0;
+   int Branches = 2, b;
+   MatchVars_t Saved;
+   unsigned char *Snapshot;
+   int Option;
+
+   while((Option = getopt(argc, argv, "vs:j:f:dc:k:")) != -1)
+   {
+      switch(Option)
+      {
+         case 'v':
+            Verbose = true;
+            break;
+         case 's':
+            Seed = strtoul(optarg, 0, 0);
+            break;
+         case 'j':
+            TimelineName = optarg;
+            break;
+         case 'f':
+            FaultList = optarg;
+            break;
+         case 'd':
+            Vars.Dump = true;
+            break;
+         case 'c':
+            Checkpoint = atof(optarg);
+            break;
+         case 'k':
+            Branches = atoi(optarg);
+            break;
+         default:
+            fprintf(stderr, "usage: %s [-v] [-s seed] [-j timeline] "
+                    "[-f faults] [-d] [-c seconds [-k branches]]\n",
+                    argv[0]);
+            return 2;
+      }
+   }
+   if(FaultList != 0 && !ParseFaults(FaultList, &Rates))
+      return 2;
+   if(Branches < 1)
+      Branches = 1;
+#ifndef SENSOR_RECORD
+   if(Vars.Dump)
+   {
+      fprintf(stderr, "-d needs a SENSOR_RECORD build\n");
+      return 2;
+   }
+#endif
+
+   ES_HostReset();
+   ArenaInit(Seed, Verbose);
+   SimJSRInit();
+   if(TimelineName != 0)
+   {
+      if((Timeline = fopen(TimelineName, "r")) == 0)
+      {
+         perror(TimelineName);
+         return 1;
+      }
+      if(!SimJSRLoad(Timeline, TimelineName))
+         return 1;
+      fclose(Timeline);
+   }
+   HostSetSPISlave(&SimJSRSlave);
+   InitServos();
+#ifdef FAULT_INJECT
+   InitFault((unsigned int)(Seed * FAULT_SEED_STRIDE) & 0xFFFFu, &Rates);
+#endif
+   if(ES_Initialize(ES_Timer_RATE_1mS) != Success)
+   {
+      fprintf(stderr, "ES_Initialize failed\n");
+      return 1;
+   }
+
+   Vars.Timeline = (TimelineName != 0);
+   if(Checkpoint < 0.0)
+   {
+      Play(HOST_MS(MATCH_LIMIT * 1000.0));
+      Report(Seed, -1);
+      return 0;
+   }
+
+   Play(HOST_MS(Checkpoint * 1000.0));
+   if((Snapshot = malloc(HostSnapshotSize())) == 0)
+   {
+      fprintf(stderr, "no room for a snapshot\n");
+      return 1;
+   }
+   HostSaveSnapshot(Snapshot);
+   Saved = Vars;
+   for(b = Branches - 1; b >= 0; b--)
+   {
+      HostRestoreSnapshot(Snapshot);
+      Vars = Saved;
+      if(b != 0)
+         ArenaReseed((Seed << BRANCH_SEED_SHIFT) + b);
+      Play(HOST_MS(MATCH_LIMIT * 1000.0));
+      Report(Seed, b);
+   }
+   free(Snapshot);
+   return 0;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Play
+  -----------------
+  Run the firmware and the field until Until, or until a second after the
+  match ends, whichever comes first.
+*/
+static void Play(HostTime_t Until)
+{
+   const ArenaStatus_t *Status = ArenaGetStatus();
+
+   while(HostNow() < Until)
+   {
+      if(Vars.EndTime != 0 && HostNow() >= Vars.EndTime)
+         break;
+      ES_HostStep();
+      if(Vars.Timeline)
+         ArenaCallPhase(TimelinePhase());
+      if(Vars.EndTime == 0 && Status->Phase == ArenaEnd)
+         Vars.EndTime = HostNow() + HOST_MS(END_RUN_ON * 1000.0);
+   }
+}
+
+/* Function: Report
+  -------------------
+  The RESULT line, with the branch number last when there is one, after
+  the sensor recording if it is wanted.
+*/
+static void Report(unsigned long Seed, int Branch)
+{
+   const ArenaStatus_t *Status = ArenaGetStatus();
+   SimJSRStats_t JSR = SimJSRGetStats();
+   char HomeTimes[ARENA_ROUNDS * 8] = "";
+   char *Next = HomeTimes;
+   unsigned int Lost = 0;
+   unsigned char i;
+
+#ifdef SENSOR_RECORD
+   if(Vars.Dump)
+      DumpRecording();
+#endif
+   for(i = 0; i < NUM_SERVICES; i++)
+      Lost += ES_HostQueueStats(i).Lost;
+   for(i = 0; i < ARENA_ROUNDS; i++)
+   {
+      if(Status->HomeFirst[i] == 'U')
+         Next += sprintf(Next, "%s%.2f", i ? "," : "", Status->HomeTime[i]);
+      else
+         Next += sprintf(Next, "%s-", i ? "," : "");
+   }
+   printf("RESULT seed=%lu us=%u them=%u win=%d home=%.4s homet=%s "
+          "goals=%u hits=%u lance=%u lost=%u jsrbad=%lu", Seed,
+          Status->Score[ARENA_US], Status->Score[ARENA_THEM],
+          Status->Score[ARENA_US] > Status->Score[ARENA_THEM],
+          Status->HomeFirst, HomeTimes, Status->Goals, Status->BallHits,
+          Status->LanceHits, Lost,
+          JSR.TooSoon + JSR.TooFast + JSR.BadMode + JSR.BadQuery);
+   if(Branch >= 0)
+      printf(" branch=%d", Branch);
+   printf("\n");
+}
+
+/* Function: TimelinePhase
+  --------------------------
+  The arena phase for the command the timeline has the JSR reporting now.
+*/
+static ArenaPhase_t TimelinePhase(void)
+{
+   switch(SimJSRStatus() & SIMJSR_COMMAND)
+   {
+      case START_ROUND:
+         return ArenaRound;
+      case RECESS:
+         return ArenaRecess;
+      case SUDDEN_DEATH:
+         return ArenaSuddenDeath;
+      case END:
+         return ArenaEnd;
+      default:
+         return ArenaWait;
+   }
+}
+
+/* Function: ParseFaults
+  ------------------------
+  Fault rates from a -f list. False, with a message, if the list is bad
+  or the build has no fault injection.
+*/
+static bool ParseFaults(char *List, FaultRates_t *Rates)
+{
+   char *Item, *Value, *End;
+   unsigned long Number;
+   unsigned char i;
+
+#ifndef FAULT_INJECT
+   fprintf(stderr, "-f needs a FAULT_INJECT build\n");
+   return false;
+#endif
+   for(Item = strtok(List, ","); Item != 0; Item = strtok(0, ","))
+   {
+      Value = strchr(Item, '=');
+      if(Value != 0)
+         *Value++ = '\0';
+      for(i = 0; i < ARRAY_SIZE(Faults); i++)
+      {
+         if(strcmp(Faults[i].Name, Item) == 0)
+            break;
+      }
+      Number = (Value != 0) ? strtoul(Value, &End, 0) : 0;
+      if(i == ARRAY_SIZE(Faults) || Value == 0 || *Value == '\0' ||
+         *End != '\0' || Number > (Faults[i].Wide ? 0xFFFFu : 255u))
+      {
+         fprintf(stderr, "bad fault %s, expected name=value with a name "
+                 "from spike, spikesize, spicorrupt, spidrop, postdrop, "
+                 "delay, delayticks\n", Item);
+         return false;
+      }
+      if(Faults[i].Wide)
+         *(unsigned int *)((char *)Rates + Faults[i].Offset) = Number;
+      else
+         *(unsigned char *)((char *)Rates + Faults[i].Offset) = Number;
+   }
+   return true;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
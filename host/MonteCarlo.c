@@ -0,0 +1,375 @@
+/****************************************************************************
+ Module
+   MonteCarlo.c
+
+ Revision
+   1.0.1
+
+ Description
+   Runs many simulated matches of one or more host builds of the firmware
+   and sums them up per build. A build is a parameter set: its own
+   firmware settings (DEFS=) or round scripts (SCRIPTS=) compiled into
+   its own Match. Each match is a seed, and the seed sets the start
+   poses, the wheel gains, the sensor noise and everything the opponent
+   and the referee do (Arena.c), so every build meets the same matches.
+
+     MonteCarlo -n 1000 build/Match build/Joust/Match
+
+     build                    matches  win% +-95%     us   them goals ...
+     host/build/Match            1000  85.3   2.2   20.1    8.2  1.73 ...
+       home first 50.6% of 2383 rounds, 630 from the start, home time
+       mean 3.59s sd 0.52s max 7.73s
+     ...
+
+   Usage: MonteCarlo [-n matches] [-s first seed] [-j jobs] [-f faults]
+                     Match...
+     -n  matches per build, 100 by default
+     -s  seed of the first match, 1 by default
+     -j  matches run at once, one per core by default
+     -f  fault rates handed to every match (Match.c -f), for FAULT_INJECT
+         builds
+
+ Notes
+   Every match is its own Match process, so no module statics are shared
+   between simulations however many run at once. The processes are spread
+   over the cores by the OS. A match whose process fails, or prints no
+   RESULT line, is counted apart and left out of the figures. wall is the
+   mean real time a match took.
+   Home times count from the start of the round. Rounds we were already
+   home at the start (time 0, the far end reached the round before) are
+   counted "from the start" and kept out of the home time figures.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 18:00 PS      -f runs the matches with faults
+ 04/30/14 17:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "ES_Types.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_BUILDS 16
+#define MAX_JOBS 256
+#define ROUNDS 4
+#define MAX_OUTPUT 1024
+
+/*---------------------------- Module Types -------------------------------*/
+//Sums for one build
+typedef struct
+{
+   const char *Match;
+   unsigned long Matches;
+   unsigned long Failed;
+   unsigned long Wins;
+   double Us, Them;
+   double Goals, Lance;
+   unsigned long Rounds;           //rounds someone got home first
+   unsigned long HomeFirst;        //of those, rounds we did
+   unsigned long HomeAtStart;      //of those, rounds we started home
+   double HomeTime, HomeTime2, HomeTimeMax;
+   unsigned long Lost, JSRBad;
+   double Wall;
+} MonteCarloBuild_t;
+
+//A match being run
+typedef struct
+{
+   pid_t Pid;
+   int Pipe;
+   unsigned char Build;
+   unsigned long Seed;
+   struct timespec Start;
+} MonteCarloJob_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool StartMatch(MonteCarloJob_t *Job, unsigned char Build,
+                       unsigned long Seed);
+static void FinishMatch(MonteCarloJob_t *Job, int Status);
+static bool Parse(MonteCarloBuild_t *Build, const char *Output);
+static void Summary(const MonteCarloBuild_t *Build);
+static double Since(const struct timespec *Start);
+
+/*---------------------------- Module Variables ---------------------------*/
+//Running state, all in one place
+typedef struct
+{
+   MonteCarloBuild_t Builds[MAX_BUILDS];
+   unsigned char NumBuilds;
+   MonteCarloJob_t Jobs[MAX_JOBS];
+   const char *Faults;             //-f list, or none
+} MonteCarloVars_t;
+
+static MonteCarloVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+   unsigned long Matches = 100, FirstSeed = 1, Next = 0, Total, Done = 0;
+   long NumJobs = sysconf(_SC_NPROCESSORS_ONLN);
+   unsigned int Running = 0, j;
+   struct timespec Start;
+   int Option, Status;
+   pid_t Pid;
+
+   while((Option = getopt(argc, argv, "n:s:j:f:")) != -1)
+   {
+      switch(Option)
+      {
+         case 'n':
+            Matches = strtoul(optarg, 0, 0);
+            break;
+         case 's':
+            FirstSeed = strtoul(optarg, 0, 0);
+            break;
+         case 'j':
+            NumJobs = strtol(optarg, 0, 0);
+            break;
+         case 'f':
+            Vars.Faults = optarg;
+            break;
+         default:
+            optind = argc + 1;
+            break;
+      }
+   }
+   if(optind >= argc || argc - optind > MAX_BUILDS)
+   {
+      fprintf(stderr, "usage: %s [-n matches] [-s first seed] [-j jobs] "
+              "[-f faults] Match...\n", argv[0]);
+      return 2;
+   }
+   if(NumJobs < 1)
+      NumJobs = 1;
+   if(NumJobs > MAX_JOBS)
+      NumJobs = MAX_JOBS;
+   for(; optind < argc; optind++)
+      Vars.Builds[Vars.NumBuilds++].Match = argv[optind];
+
+   //Seeds in the outer loop, so every build gets through the same ones
+   Total = Matches * Vars.NumBuilds;
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+   while(Done < Total)
+   {
+      while(Next < Total && Running < NumJobs)
+      {
+         for(j = 0; Vars.Jobs[j].Pid != 0; j++)
+            ;
+         if(!StartMatch(&Vars.Jobs[j], Next % Vars.NumBuilds,
+                        FirstSeed + Next / Vars.NumBuilds))
+            return 1;
+         Next++;
+         Running++;
+      }
+      Pid = wait(&Status);
+      if(Pid < 0)
+      {
+         perror("wait");
+         return 1;
+      }
+      for(j = 0; j < NumJobs && Vars.Jobs[j].Pid != Pid; j++)
+         ;
+      if(j == NumJobs)
+         continue;
+      FinishMatch(&Vars.Jobs[j], Status);
+      Running--;
+      Done++;
+   }
+
+   printf("%lu matches a build, seeds %lu-%lu, %ld at once, %.1fs\n",
+          Matches, FirstSeed, FirstSeed + Matches - 1, NumJobs,
+          Since(&Start));
+   if(Vars.Faults != 0)
+      printf("faults %s\n", Vars.Faults);
+   printf("%-24s %7s %5s %5s %6s %6s %5s %5s %6s\n", "build", "matches",
+          "win%", "+-95%", "us", "them", "goals", "lance", "wall");
+   for(j = 0; j < Vars.NumBuilds; j++)
+      Summary(&Vars.Builds[j]);
+   return 0;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: StartMatch
+  -----------------------
+  Run one Match process, its output to a pipe of its own. A RESULT line
+  is far less than a pipe holds, so the match never waits on us.
+*/
+static bool StartMatch(MonteCarloJob_t *Job, unsigned char Build,
+                       unsigned long Seed)
+{
+   char SeedArg[24];
+   int Fds[2];
+
+   if(pipe(Fds) != 0)
+   {
+      perror("pipe");
+      return false;
+   }
+   snprintf(SeedArg, sizeof(SeedArg), "%lu", Seed);
+   Job->Build = Build;
+   Job->Seed = Seed;
+   clock_gettime(CLOCK_MONOTONIC, &Job->Start);
+   Job->Pid = fork();
+   if(Job->Pid < 0)
+   {
+      perror("fork");
+      return false;
+   }
+   if(Job->Pid == 0)
+   {
+      close(Fds[0]);
+      dup2(Fds[1], STDOUT_FILENO);
+      close(Fds[1]);
+      if(Vars.Faults != 0)
+         execl(Vars.Builds[Build].Match, Vars.Builds[Build].Match, "-s",
+               SeedArg, "-f", Vars.Faults, (char *)0);
+      else
+         execl(Vars.Builds[Build].Match, Vars.Builds[Build].Match, "-s",
+               SeedArg, (char *)0);
+      perror(Vars.Builds[Build].Match);
+      _exit(127);
+   }
+   close(Fds[1]);
+   Job->Pipe = Fds[0];
+   return true;
+}
+
+/* Function: FinishMatch
+  ------------------------
+  The match's process has ended: read what it printed and add it in.
+*/
+static void FinishMatch(MonteCarloJob_t *Job, int Status)
+{
+   MonteCarloBuild_t *Build = &Vars.Builds[Job->Build];
+   char Output[MAX_OUTPUT];
+   size_t Length = 0;
+   ssize_t Got;
+
+   while(Length < sizeof(Output) - 1 &&
+         (Got = read(Job->Pipe, Output + Length,
+                     sizeof(Output) - 1 - Length)) > 0)
+      Length += Got;
+   Output[Length] = '\0';
+   close(Job->Pipe);
+   Job->Pid = 0;
+
+   if(!WIFEXITED(Status) || WEXITSTATUS(Status) != 0 ||
+      !Parse(Build, Output))
+   {
+      fprintf(stderr, "%s -s %lu failed\n", Build->Match, Job->Seed);
+      Build->Failed++;
+      return;
+   }
+   Build->Wall += Since(&Job->Start);
+}
+
+/* Function: Parse
+  ------------------
+  Add a RESULT line (Match.c) to the build's sums.
+*/
+static bool Parse(MonteCarloBuild_t *Build, const char *Output)
+{
+   const char *Line = strstr(Output, "RESULT ");
+   unsigned int Us, Them, Win, Goals, Hits, Lance, Lost;
+   unsigned long JSRBad;
+   char Home[ROUNDS + 1], HomeTimes[64], *Field;
+   unsigned char r;
+   double Time;
+
+   if(Line == 0 ||
+      sscanf(Line, "RESULT seed=%*u us=%u them=%u win=%u home=%4s "
+             "homet=%63s goals=%u hits=%u lance=%u lost=%u jsrbad=%lu",
+             &Us, &Them, &Win, Home, HomeTimes, &Goals, &Hits, &Lance,
+             &Lost, &JSRBad) != 10)
+      return false;
+
+   Build->Matches++;
+   Build->Wins += Win;
+   Build->Us += Us;
+   Build->Them += Them;
+   Build->Goals += Goals;
+   Build->Lance += Lance;
+   Build->Lost += Lost;
+   Build->JSRBad += JSRBad;
+   for(r = 0; r < ROUNDS && Home[r] != '\0'; r++)
+   {
+      if(Home[r] != '-')
+         Build->Rounds++;
+      if(Home[r] == 'U')
+         Build->HomeFirst++;
+   }
+   for(Field = strtok(HomeTimes, ","); Field != 0; Field = strtok(0, ","))
+   {
+      if(*Field == '-')
+         continue;
+      Time = atof(Field);
+      if(Time == 0.0)
+      {
+         Build->HomeAtStart++;
+         continue;
+      }
+      Build->HomeTime += Time;
+      Build->HomeTime2 += Time * Time;
+      if(Time > Build->HomeTimeMax)
+         Build->HomeTimeMax = Time;
+   }
+   return true;
+}
+
+/* Function: Summary
+  --------------------
+  One build's figures: the win rate with its 95% margin, mean scores per
+  match, and how often and how fast we got home first.
+*/
+static void Summary(const MonteCarloBuild_t *Build)
+{
+   double n = Build->Matches, p, Mean, Sd;
+   unsigned long Timed;
+
+   if(Build->Matches == 0)
+   {
+      printf("%-24s %7u, all %lu failed\n", Build->Match, 0, Build->Failed);
+      return;
+   }
+   p = Build->Wins / n;
+   printf("%-24s %7lu %5.1f %5.1f %6.1f %6.1f %5.2f %5.2f %5.2fs\n",
+          Build->Match, Build->Matches, 100.0 * p,
+          100.0 * 1.96 * sqrt(p * (1.0 - p) / n), Build->Us / n,
+          Build->Them / n, Build->Goals / n, Build->Lance / n,
+          Build->Wall / n);
+   if(Build->HomeFirst > Build->HomeAtStart)
+   {
+      Timed = Build->HomeFirst - Build->HomeAtStart;
+      Mean = Build->HomeTime / Timed;
+      Sd = sqrt(fmax(0.0, Build->HomeTime2 / Timed - Mean * Mean));
+      printf("  home first %.1f%% of %lu rounds, %lu from the start, "
+             "home time mean %.2fs sd %.2fs max %.2fs\n",
+             100.0 * Build->HomeFirst / Build->Rounds, Build->Rounds,
+             Build->HomeAtStart, Mean, Sd, Build->HomeTimeMax);
+   }
+   if(Build->Failed != 0 || Build->Lost != 0 || Build->JSRBad != 0)
+      printf("  failed %lu, events lost %lu, bad JSR queries %lu\n",
+             Build->Failed, Build->Lost, Build->JSRBad);
+}
+
+/* Function: Since
+  ------------------
+  Real seconds since Start.
+*/
+static double Since(const struct timespec *Start)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+   return (Now.tv_sec - Start->tv_sec) + (Now.tv_nsec - Start->tv_nsec) / 1e9;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
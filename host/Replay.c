@@ -0,0 +1,338 @@
+/****************************************************************************
+ Module
+   Replay.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host replay of a sensor recording (Recorder.c, as DumpRecording prints
+   it over the SCI or Match -d prints it) through the unmodified event
+   checkers that classify the analog sensors: CheckIRSensor (IR_Detect.c)
+   and Check4RightTape (Orientation.c). The recording is played as fast
+   as the checkers run, not in real time, and every event they post is
+   printed with the recording time it came at and how long the checker
+   call that posted it took:
+
+     Replay: seed1.rec, 1783 readings over 30.106s, 10 polls a tick
+       0.000s Check4RightTape Right_Tape 0 to service 5, 164ns
+       2.465s Check4RightTape Right_Tape 2 to service 5, 144ns
+       2.963s CheckIRSensor LeftOnly 1250 to service 0, 167ns
+     ...
+     Replay: 588020 polls, 149 events in 0.074s
+       CheckIRSensor      mean 74ns max 3851.1us, 142 events
+       Check4RightTape    mean 58ns max 101.9us, 7 events
+
+   Usage: Replay [-p polls] [-q] recording
+     -p  checker polls per timer tick of the recording, 10 by default
+         (ES_Host.c polls about every 100us)
+     -q  only the summary
+   A recording of - is read from stdin.
+
+ Notes
+   The services are started (ES_Initialize) but never run, so the
+   checkers see them as just started: IR_Detect looks for the other
+   bot's beacon. Events are caught on their way into the queues
+   (ES_HostSetPostHook); the queues soon fill, which does not matter.
+   A sensor reads as its first reading in the recording until then, as
+   in StartReplay. Times are host nanoseconds per checker call, taken
+   with the monotonic clock around each call, so very short calls are
+   mostly the clock's own cost, and the max takes in whatever the OS did
+   meanwhile.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 20:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Host.h"
+#include "Sensors.h"
+#include "IR_Detect.h"
+#include "Orientation.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_ENTRIES 4096
+#define MAX_POSTS 8                 //events one checker call can post
+#define TICK_SECONDS 0.001024       //an ES timer tick
+#define TIME_MASK 0xFFFFu           //entry times are 16 bits
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+   unsigned int Time;               //ticks after the first entry
+   unsigned char Sensor;
+   short Reading;
+} ReplayEntry_t;
+
+typedef struct
+{
+   const char *Name;
+   bool (*Check)(void);
+   unsigned long Calls;
+   unsigned long Events;
+   double Total;                    //ns
+   double Max;
+} ReplayChecker_t;
+
+typedef struct
+{
+   uint8_t Service;
+   ES_Event Event;
+} ReplayPost_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool Load(FILE *File, const char *Name);
+static short RecordedSensor(unsigned char Sensor);
+static void Posted(uint8_t WhichService, ES_Event ThisEvent);
+static void Poll(ReplayChecker_t *Checker, unsigned int Tick, bool Quiet);
+static const char *EventName(ES_EventTyp_t Event);
+static double Since(const struct timespec *Start);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const char *const EventNames[] =
+{
+#include "EventNames.h"
+};
+
+//Running state, all in one place
+typedef struct
+{
+   ReplayEntry_t Entries[MAX_ENTRIES];
+   unsigned int NumEntries;
+   short Current[NUM_SENSORS];      //what each sensor reads now
+   ReplayPost_t Posts[MAX_POSTS];   //posted by the checker call under way
+   unsigned char NumPosts;
+   ReplayChecker_t Checkers[2];
+} ReplayVars_t;
+
+static ReplayVars_t Vars =
+{
+   .Checkers = {{"CheckIRSensor", CheckIRSensor},
+                {"Check4RightTape", Check4RightTape}}
+};
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+   unsigned int Polls = 10, Tick, Last, n = 0, p, s;
+   unsigned long Events = 0;
+   bool Quiet = false, Seen[NUM_SENSORS] = {false};
+   struct timespec Start;
+   const char *Name;
+   FILE *File;
+   ReplayChecker_t *Checker;
+   int Option;
+
+   while((Option = getopt(argc, argv, "p:q")) != -1)
+   {
+      switch(Option)
+      {
+         case 'p':
+            Polls = strtoul(optarg, 0, 0);
+            break;
+         case 'q':
+            Quiet = true;
+            break;
+         default:
+            optind = argc;
+            break;
+      }
+   }
+   if(optind != argc - 1 || Polls == 0)
+   {
+      fprintf(stderr, "usage: %s [-p polls] [-q] recording\n", argv[0]);
+      return 2;
+   }
+   Name = argv[optind];
+   if(strcmp(Name, "-") == 0)
+      File = stdin;
+   else if((File = fopen(Name, "r")) == 0)
+   {
+      perror(Name);
+      return 1;
+   }
+   if(!Load(File, Name))
+      return 1;
+   if(File != stdin)
+      fclose(File);
+
+   //First reading of each sensor until its first entry comes up
+   for(n = 0; n < Vars.NumEntries; n++)
+   {
+      s = Vars.Entries[n].Sensor;
+      if(!Seen[s])
+      {
+         Vars.Current[s] = Vars.Entries[n].Reading;
+         Seen[s] = true;
+      }
+   }
+
+   ES_HostReset();
+   if(ES_Initialize(ES_Timer_RATE_1mS) != Success)
+   {
+      fprintf(stderr, "ES_Initialize failed\n");
+      return 1;
+   }
+   SetSensorSource(RecordedSensor);
+   ES_HostSetPostHook(Posted);
+
+   Last = Vars.Entries[Vars.NumEntries - 1].Time;
+   printf("Replay: %s, %u readings over %.3fs, %u polls a tick\n", Name,
+          Vars.NumEntries, Last * TICK_SECONDS, Polls);
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+   n = 0;
+   for(Tick = 0; Tick <= Last; Tick++)
+   {
+      for(; n < Vars.NumEntries && Vars.Entries[n].Time <= Tick; n++)
+         Vars.Current[Vars.Entries[n].Sensor] = Vars.Entries[n].Reading;
+      for(p = 0; p < Polls; p++)
+      {
+         for(Checker = Vars.Checkers;
+             Checker < Vars.Checkers + ARRAY_SIZE(Vars.Checkers); Checker++)
+            Poll(Checker, Tick, Quiet);
+      }
+   }
+
+   for(Checker = Vars.Checkers;
+       Checker < Vars.Checkers + ARRAY_SIZE(Vars.Checkers); Checker++)
+      Events += Checker->Events;
+   printf("Replay: %lu polls, %lu events in %.3fs\n",
+          Vars.Checkers[0].Calls * ARRAY_SIZE(Vars.Checkers), Events,
+          Since(&Start));
+   for(Checker = Vars.Checkers;
+       Checker < Vars.Checkers + ARRAY_SIZE(Vars.Checkers); Checker++)
+      printf("  %-18s mean %.0fns max %.1fus, %lu events\n", Checker->Name,
+             Checker->Total / Checker->Calls, Checker->Max / 1000.0,
+             Checker->Events);
+   return 0;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Load
+  -----------------
+  Read a dump: whatever comes before the "REC n" line, then n lines of
+  "time sensor reading". Entry times become ticks after the first entry.
+*/
+static bool Load(FILE *File, const char *Name)
+{
+   char Line[80];
+   unsigned int Count = 0, Time, Sensor, Reading, First = 0, LineNum = 0;
+   bool Found = false;
+   ReplayEntry_t *Entry;
+
+   while(fgets(Line, sizeof(Line), File) != 0)
+   {
+      LineNum++;
+      if(!Found)
+      {
+         Found = (sscanf(Line, "REC %u", &Count) == 1);
+         continue;
+      }
+      if(Vars.NumEntries == Count)
+         break;
+      if(sscanf(Line, "%u %u %u", &Time, &Sensor, &Reading) != 3 ||
+         Sensor >= NUM_SENSORS || Vars.NumEntries >= MAX_ENTRIES)
+      {
+         fprintf(stderr, "%s:%u: expected time, sensor and reading\n", Name,
+                 LineNum);
+         return false;
+      }
+      if(Vars.NumEntries == 0)
+         First = Time;
+      Entry = &Vars.Entries[Vars.NumEntries++];
+      Entry->Time = (Time - First) & TIME_MASK;
+      Entry->Sensor = Sensor;
+      Entry->Reading = Reading;
+   }
+   if(Vars.NumEntries == 0 || Vars.NumEntries != Count)
+   {
+      fprintf(stderr, "%s: %s\n", Name, Found ? "recording cut short" :
+              "no REC line");
+      return false;
+   }
+   return true;
+}
+
+/* Function: RecordedSensor
+  ---------------------------
+  Sensor source for the checkers.
+*/
+static short RecordedSensor(unsigned char Sensor)
+{
+   return Vars.Current[Sensor];
+}
+
+/* Function: Posted
+  -------------------
+  Post hook: note what the checker call under way posts.
+*/
+static void Posted(uint8_t WhichService, ES_Event ThisEvent)
+{
+   if(Vars.NumPosts < MAX_POSTS)
+   {
+      Vars.Posts[Vars.NumPosts].Service = WhichService;
+      Vars.Posts[Vars.NumPosts].Event = ThisEvent;
+      Vars.NumPosts++;
+   }
+}
+
+/* Function: Poll
+  -----------------
+  One timed call of a checker, and the events it posted.
+*/
+static void Poll(ReplayChecker_t *Checker, unsigned int Tick, bool Quiet)
+{
+   struct timespec Start;
+   double Ns;
+   unsigned char i;
+
+   Vars.NumPosts = 0;
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+   Checker->Check();
+   Ns = Since(&Start) * 1e9;
+
+   Checker->Calls++;
+   Checker->Total += Ns;
+   if(Ns > Checker->Max)
+      Checker->Max = Ns;
+   Checker->Events += Vars.NumPosts;
+   for(i = 0; i < Vars.NumPosts && !Quiet; i++)
+      printf("  %.3fs %s %s %u to service %u, %.0fns\n",
+             Tick * TICK_SECONDS, Checker->Name,
+             EventName(Vars.Posts[i].Event.EventType),
+             Vars.Posts[i].Event.EventParam, Vars.Posts[i].Service, Ns);
+}
+
+/* Function: EventName
+  ----------------------
+  The event's name from ES_Configure.h.
+*/
+static const char *EventName(ES_EventTyp_t Event)
+{
+   if(Event < ARRAY_SIZE(EventNames))
+      return EventNames[Event];
+   return "?";
+}
+
+/* Function: Since
+  ------------------
+  Real seconds since Start.
+*/
+static double Since(const struct timespec *Start)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+   return (Now.tv_sec - Start->tv_sec) + (Now.tv_nsec - Start->tv_nsec) / 1e9;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,258 @@
+/****************************************************************************
+ Module
+   ShotTest.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host test of the ball feed (Shoot.c) on the simulated feeder and
+   flywheels (Arena.c). With the wheels up to speed and five balls in the
+   magazine, the magazine is emptied twice: once the way Shoot.c fed
+   before the pipelined sequencer, push, wait, retract, wait, with fixed
+   waits, and once by the firmware's own sequencer from one Shoot_Ball.
+   The time is from the command to the fifth ball leaving the wheels.
+   Then the pipelined run again on feeders other than the one Shoot.c's
+   travel model is written for, slower or needing the pusher further back
+   before the next ball drops, to show how much room its SERVO_SLEW and
+   CLEAR_WIDTH leave:
+
+     ShotTest: empty a full magazine, wheels at speed
+       feeder            sequence     fired  time    dry pushes
+       stock             fixed waits  5      5.834s  0
+       stock             pipelined    5      1.270s  0  (estimate 1.260s)
+       ...
+       30% slower        pipelined    0      0.000s  0
+       ...
+       clears at 740us   pipelined    1      0.101s  4
+
+   A dry push is a stroke that reaches the wheels with no ball in front of
+   the pusher, so the ball it was meant for is left behind. A feeder too
+   slow for the push time does not reach the wheels at all. Exits 1 if the
+   pipelined sequence on the stock feeder leaves a ball or pushes dry.
+
+ Notes
+   Every run starts from power-on (a snapshot taken before the first, as
+   in DriveTest.c) with the referee held in the wait before the first
+   round. The wheels are started with StartShootingMotors and given
+   SPIN_UP to get to speed. The fixed waits are played from here on the
+   feeder servo with SetServo, the way the old ShootTimer and Feeder_Timer
+   timeouts moved it.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 22:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Host.h"
+#include "Arena.h"
+#include "SimJSR.h"
+#include "HostSnapshot.h"
+#include "Shoot.h"
+#include "Servos.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define BALLS 5
+#define SPIN_UP HOST_MS(3000)
+#define RUN_LIMIT HOST_MS(15000)
+#define SEED 1
+
+//The old fixed wait feed, as Shoot.c had it
+#define FEEDER_SERVO 0
+#define OLD_SHOOT_WIDTH 970
+#define OLD_RETRACT_WIDTH 700
+#define OLD_WAIT_TIME 700       //timer ticks, after each push and retract
+
+//The stock feeder (Arena.c)
+#define STOCK_SLEW 2.5          //us of width per ms
+#define STOCK_CLEAR 800.0
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+   const char *Name;
+   double Slew;
+   double ClearWidth;
+} ShotFeeder_t;
+
+typedef struct
+{
+   unsigned char Fired;
+   unsigned char DryPushes;
+   double Seconds;              //to the last ball fired
+} ShotResult_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static ShotResult_t Empty(const ShotFeeder_t *Feeder, bool Pipelined,
+                          double *Estimate);
+static void Reset(void);
+static void Post(ES_EventTyp_t EventType, uint16_t Param);
+static void Print(const ShotFeeder_t *Feeder, const char *Sequence,
+                  ShotResult_t Result);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const ShotFeeder_t Feeders[] =
+{
+   {"stock", STOCK_SLEW, STOCK_CLEAR},
+   {"10% faster", STOCK_SLEW * 1.1, STOCK_CLEAR},
+   {"10% slower", STOCK_SLEW * 0.9, STOCK_CLEAR},
+   {"25% slower", STOCK_SLEW * 0.75, STOCK_CLEAR},
+   {"30% slower", STOCK_SLEW * 0.7, STOCK_CLEAR},
+   {"clears at 760us", STOCK_SLEW, 760.0},
+   {"clears at 750us", STOCK_SLEW, 750.0},
+   {"clears at 740us", STOCK_SLEW, 740.0}
+};
+
+//Running state, all in one place
+typedef struct
+{
+   unsigned char *PowerOn;      //everything as it was before any run
+} ShotTestVars_t;
+
+static ShotTestVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(void)
+{
+   ShotResult_t Result;
+   double Estimate;
+   unsigned char f;
+   bool Failed;
+
+   if((Vars.PowerOn = malloc(HostSnapshotSize())) == 0)
+   {
+      fprintf(stderr, "no room for a snapshot\n");
+      return 1;
+   }
+   HostSaveSnapshot(Vars.PowerOn);
+
+   printf("ShotTest: empty a full magazine, wheels at speed\n");
+   printf("  feeder            sequence     fired  time    dry pushes\n");
+   Print(&Feeders[0], "fixed waits", Empty(&Feeders[0], false, 0));
+   printf("\n");
+   Result = Empty(&Feeders[0], true, &Estimate);
+   Failed = (Result.Fired != BALLS || Result.DryPushes != 0);
+   Print(&Feeders[0], "pipelined", Result);
+   printf("  (estimate %.3fs)\n", Estimate);
+   for(f = 1; f < ARRAY_SIZE(Feeders); f++)
+   {
+      Print(&Feeders[f], "pipelined", Empty(&Feeders[f], true, 0));
+      printf("\n");
+   }
+   if(Failed)
+   {
+      printf("ShotTest: pipelined feed left a ball on the stock feeder\n");
+      return 1;
+   }
+   return 0;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Empty
+  ------------------
+  One magazine, on Feeder, by the pipelined sequencer or the old fixed
+  waits. Estimate, if given, gets EstimateShootTime's seconds for it.
+*/
+static ShotResult_t Empty(const ShotFeeder_t *Feeder, bool Pipelined,
+                          double *Estimate)
+{
+   const ArenaStatus_t *Status = ArenaGetStatus();
+   ShotResult_t Result = {0, 0, 0};
+   HostTime_t Start, Wait = OLD_WAIT_TIME * ES_HOST_TICK, Move;
+   unsigned char Moves = 0;
+
+   Reset();
+   ArenaSetFeeder(Feeder->Slew, Feeder->ClearWidth);
+   Post(StartShootingMotors, 0);
+   ES_HostRunUntil(HostNow() + SPIN_UP);
+
+   Start = HostNow();
+   if(Pipelined)
+   {
+      if(Estimate != 0)
+      {
+         HostEnterFirmware();
+         *Estimate = EstimateShootTime(BALLS) * ES_HOST_TICK /
+                     (HOST_CYCLES_PER_MS * 1000.0);
+         HostLeaveFirmware();
+      }
+      Post(Shoot_Ball, BALLS);
+   }
+   Move = Start;
+   while(Status->BallsFired < BALLS && HostNow() < Start + RUN_LIMIT)
+   {
+      if(!Pipelined && HostNow() >= Move && Moves < 2 * BALLS)
+      {
+         HostEnterFirmware();
+         SetServo(FEEDER_SERVO, (Moves % 2 == 0) ? OLD_SHOOT_WIDTH :
+                                                   OLD_RETRACT_WIDTH);
+         HostLeaveFirmware();
+         Moves++;
+         Move += Wait;
+      }
+      ES_HostStep();
+      if(Status->BallsFired > Result.Fired)
+      {
+         Result.Fired = Status->BallsFired;
+         Result.Seconds = (double)(HostNow() - Start) /
+                          (HOST_CYCLES_PER_MS * 1000.0);
+      }
+   }
+   Result.DryPushes = Status->DryPushes;
+   return Result;
+}
+
+/* Function: Reset
+  ------------------
+  Everything back to power-on, then booted with the referee held in the
+  wait.
+*/
+static void Reset(void)
+{
+   HostRestoreSnapshot(Vars.PowerOn);
+   ES_HostReset();
+   ArenaInit(SEED, false);
+   ArenaCallPhase(ArenaWait);
+   SimJSRInit();
+   HostSetSPISlave(&SimJSRSlave);
+   InitServos();
+   if(ES_Initialize(ES_Timer_RATE_1mS) != Success)
+   {
+      fprintf(stderr, "ES_Initialize failed\n");
+      exit(1);
+   }
+}
+
+/* Function: Post
+  -----------------
+  An event to Shoot, from outside the framework.
+*/
+static void Post(ES_EventTyp_t EventType, uint16_t Param)
+{
+   ES_Event ThisEvent;
+
+   ThisEvent.EventType = EventType;
+   ThisEvent.EventParam = Param;
+   HostEnterFirmware();
+   PostShoot(ThisEvent);
+   HostLeaveFirmware();
+}
+
+/* Function: Print
+  ------------------
+  One line of the table, left open for a note.
+*/
+static void Print(const ShotFeeder_t *Feeder, const char *Sequence,
+                  ShotResult_t Result)
+{
+   printf("  %-17s %-12s %-6u %.3fs  %u", Feeder->Name, Sequence,
+          Result.Fired, Result.Seconds, Result.DryPushes);
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,381 @@
+/****************************************************************************
+ Module
+   SimJSR.c
+
+ Revision
+   1.0.1
+
+ Description
+   The Joust Status Reporter as an SPI slave on the emulated port, so the
+   firmware's own JSR path (SPIEngine, JSRDecode, JSRcommand) runs
+   unchanged on the host. Bytes are exchanged as the master clocks them,
+   at the SPIBR rate: the first byte of a reply goes out while the query
+   byte is still coming in, so it is always 0x00, then 0xFF, then the
+   answer to STATUS_QUERY or SCORE_QUERY.
+   The game state comes from the arena's referee (live), or from a
+   timeline file of steps:
+
+     # seconds  command       red  dark  bits
+       0        WAIT          0    0
+       3        START_ROUND   0    0
+       33       RECESS        2    1     RED_RELOAD DARK_RELOAD
+       125      SUDDEN_DEATH  4    5     HEAD
+
+   Commands are WAIT, START_ROUND, RECESS, SUDDEN_DEATH and END, bits
+   RED_RELOAD, DARK_RELOAD and HEAD. Each step is in force from its time
+   on, counted from reset.
+
+ Notes
+   Like the JSR, the reply is latched when SS falls. A query with SS high
+   under 2ms before it, or bytes clocked faster than the JSR's 1.43MHz, is
+   answered with 0xFF from there on, and counted in the stats along with
+   queries made in the wrong SPI mode.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 19:00 PS      SimJSRGetVars, for snapshots
+ 04/30/14 10:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+#include <mc9s12e128.h>
+#include <S12E128bits.h>
+#include "ES_Framework.h"
+#include "JSRcommand.h"
+#include "Arena.h"
+#include "SimJSR.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_STEPS 64
+#define SS_GAP HOST_MS(2)
+#define MIN_BYTE_TIME ((HostTime_t)(8 * 24000000.0 / 1430000.0))
+#define SPI_MODE (_S12_CPOL | _S12_CPHA)
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+   HostTime_t When;
+   unsigned char Status;
+   unsigned char RedScore;
+   unsigned char DarkScore;
+} SimJSRStep_t;
+
+typedef struct
+{
+   const char *Name;
+   unsigned char Value;
+} SimJSRWord_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Select(HostTime_t When);
+static unsigned char Exchange(unsigned char Out, HostTime_t When);
+static void Release(HostTime_t When);
+static void Current(unsigned char *Status, unsigned char *Red,
+                    unsigned char *Dark);
+static bool Lookup(const SimJSRWord_t *Words, unsigned char NumWords,
+                   const char *Name, unsigned char *Value);
+
+/*---------------------------- Module Variables ---------------------------*/
+const HostSPISlave_t SimJSRSlave = {Select, Exchange, Release};
+
+static const SimJSRWord_t Commands[] =
+{
+   {"WAIT", WAIT}, {"START_ROUND", START_ROUND}, {"RECESS", RECESS},
+   {"SUDDEN_DEATH", SUDDEN_DEATH}, {"END", END}
+};
+
+static const SimJSRWord_t Bits[] =
+{
+   {"RED_RELOAD", RED_RELOAD_STATUS}, {"DARK_RELOAD", DARK_RELOAD_STATUS},
+   {"HEAD", SIMJSR_HEAD}
+};
+
+//Running state, all in one place
+typedef struct
+{
+   SimJSRStep_t Steps[MAX_STEPS];
+   unsigned char NumSteps;          //0 to follow the referee
+   bool Released;                   //SS has been released before
+   HostTime_t ReleaseTime;
+   HostTime_t LastByte;
+   unsigned char Status;            //latched when SS fell
+   unsigned char RedScore;
+   unsigned char DarkScore;
+   unsigned char Query;
+   unsigned char ByteNum;
+   bool Garbled;                    //rest of this query reads 0xFF
+   bool TooSoon;
+   bool TooFast;
+   SimJSRStats_t Stats;
+} SimJSRVars_t;
+
+static SimJSRVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   SimJSRInit
+
+ Description
+   Fresh JSR following the arena's referee, no timeline and no queries
+   yet. Install it with HostSetSPISlave(&SimJSRSlave).
+****************************************************************************/
+void SimJSRInit(void)
+{
+   memset(&Vars, 0, sizeof(Vars));
+}
+
+/****************************************************************************
+ Function
+   SimJSRLoad
+
+ Parameters
+   FILE * : timeline, as in the module description
+   const char * : its name, for messages
+
+ Returns
+   bool, false with a message on stderr if the timeline is bad
+
+ Description
+   Play the timeline instead of following the referee.
+****************************************************************************/
+bool SimJSRLoad(FILE *Timeline, const char *Name)
+{
+   char Line[160], Command[32], Bit[32];
+   char *Rest;
+   double Second;
+   unsigned int Red, Dark, LineNum = 0;
+   unsigned char Value;
+   int Used;
+   SimJSRStep_t *Step;
+
+   Vars.NumSteps = 0;
+   while(fgets(Line, sizeof(Line), Timeline) != 0)
+   {
+      LineNum++;
+      Rest = Line + strspn(Line, " \t\r\n");
+      if(*Rest == '#' || *Rest == '\0')
+         continue;
+      if(Vars.NumSteps >= MAX_STEPS)
+      {
+         fprintf(stderr, "%s:%u: more than %u steps\n", Name, LineNum,
+                 MAX_STEPS);
+         return false;
+      }
+      Step = &Vars.Steps[Vars.NumSteps];
+      if(sscanf(Rest, "%lf %31s %u %u%n", &Second, Command, &Red, &Dark,
+                &Used) != 4 || Second < 0 || Red > 255 || Dark > 255 ||
+         !Lookup(Commands, ARRAY_SIZE(Commands), Command, &Step->Status))
+      {
+         fprintf(stderr, "%s:%u: expected seconds, command, red and dark "
+                 "scores\n", Name, LineNum);
+         return false;
+      }
+      Rest += Used;
+      while(sscanf(Rest, "%31s%n", Bit, &Used) == 1)
+      {
+         if(!Lookup(Bits, ARRAY_SIZE(Bits), Bit, &Value))
+         {
+            fprintf(stderr, "%s:%u: unknown bit %s\n", Name, LineNum, Bit);
+            return false;
+         }
+         Step->Status |= Value;
+         Rest += Used;
+      }
+      Step->When = HOST_MS(Second * 1000.0);
+      Step->RedScore = Red;
+      Step->DarkScore = Dark;
+      if(Vars.NumSteps > 0 && Step->When < Step[-1].When)
+      {
+         fprintf(stderr, "%s:%u: steps out of order\n", Name, LineNum);
+         return false;
+      }
+      Vars.NumSteps++;
+   }
+   if(Vars.NumSteps == 0)
+   {
+      fprintf(stderr, "%s: no steps\n", Name);
+      return false;
+   }
+   return true;
+}
+
+/****************************************************************************
+ Function
+   SimJSRStatus
+
+ Returns
+   unsigned char, the status byte the JSR would answer with now
+****************************************************************************/
+unsigned char SimJSRStatus(void)
+{
+   unsigned char Status, Red, Dark;
+
+   Current(&Status, &Red, &Dark);
+   return Status;
+}
+
+/****************************************************************************
+ Function
+   SimJSRGetStats
+
+ Returns
+   SimJSRStats_t, queries so far and how many broke the JSR's rules
+****************************************************************************/
+SimJSRStats_t SimJSRGetStats(void)
+{
+   return Vars.Stats;
+}
+
+/****************************************************************************
+ Function
+   SimJSRGetVars
+
+ Returns
+   StateBlock_t, where the JSR's running state lives
+****************************************************************************/
+StateBlock_t SimJSRGetVars(void)
+{
+   StateBlock_t Block;
+
+   Block.Data = &Vars;
+   Block.Size = sizeof(Vars);
+   return Block;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: Select
+  -------------------
+  SS fell: latch the reply and check the gap and mode.
+*/
+static void Select(HostTime_t When)
+{
+   Current(&Vars.Status, &Vars.RedScore, &Vars.DarkScore);
+   Vars.ByteNum = 0;
+   Vars.LastByte = When;
+   Vars.TooSoon = Vars.Released && When - Vars.ReleaseTime < SS_GAP;
+   Vars.TooFast = false;
+   Vars.Garbled = Vars.TooSoon;
+   if((SPICR1 & SPI_MODE) != SPI_MODE)
+   {
+      Vars.Stats.BadMode++;
+      Vars.Garbled = true;
+   }
+}
+
+/* Function: Exchange
+  ---------------------
+  One byte shifted each way. The byte just taken in is only looked at
+  once it is complete, so it shapes the following bytes.
+*/
+static unsigned char Exchange(unsigned char Out, HostTime_t When)
+{
+   unsigned char Reply;
+
+   if(When - Vars.LastByte < MIN_BYTE_TIME)
+   {
+      Vars.TooFast = true;
+      Vars.Garbled = true;
+   }
+   Vars.LastByte = When;
+
+   if(Vars.ByteNum == 0)
+   {
+      Vars.Query = Out;
+      if(Out != STATUS_QUERY && Out != SCORE_QUERY)
+         Vars.Stats.BadQuery++;
+   }
+
+   if(Vars.Garbled)
+      Reply = 0xFF;
+   else if(Vars.ByteNum == 0)
+      Reply = 0x00;
+   else if(Vars.ByteNum == 1)
+      Reply = 0xFF;
+   else if(Vars.Query == STATUS_QUERY)
+      Reply = (Vars.ByteNum == 2) ? 0x00 : Vars.Status;
+   else if(Vars.Query == SCORE_QUERY)
+      Reply = (Vars.ByteNum == 2) ? Vars.RedScore : Vars.DarkScore;
+   else
+      Reply = 0x00;
+
+   if(Vars.ByteNum < 255)
+      Vars.ByteNum++;
+   return Reply;
+}
+
+/* Function: Release
+  --------------------
+  SS rose: one query done.
+*/
+static void Release(HostTime_t When)
+{
+   Vars.Released = true;
+   Vars.ReleaseTime = When;
+   Vars.Stats.Queries++;
+   if(Vars.TooSoon)
+      Vars.Stats.TooSoon++;
+   if(Vars.TooFast)
+      Vars.Stats.TooFast++;
+}
+
+/* Function: Current
+  --------------------
+  Game state now: the timeline step in force, or the referee's view. We
+  are the red knight; the dark knight may reload whenever we may be
+  offered it, in the recess after round 2.
+*/
+static void Current(unsigned char *Status, unsigned char *Red,
+                    unsigned char *Dark)
+{
+   static const unsigned char PhaseCommands[] =
+      {WAIT, START_ROUND, RECESS, SUDDEN_DEATH, END};
+   const ArenaStatus_t *Arena;
+   HostTime_t Now = HostNow();
+   unsigned char n = 0;
+
+   if(Vars.NumSteps > 0)
+   {
+      while(n + 1 < Vars.NumSteps && Vars.Steps[n + 1].When <= Now)
+         n++;
+      *Status = Vars.Steps[n].Status;
+      *Red = Vars.Steps[n].RedScore;
+      *Dark = Vars.Steps[n].DarkScore;
+      return;
+   }
+   Arena = ArenaGetStatus();
+   *Status = PhaseCommands[Arena->Phase];
+   if(Arena->ReloadAllowed)
+      *Status |= RED_RELOAD_STATUS;
+   if(Arena->Phase == ArenaRecess && Arena->Round == 2)
+      *Status |= DARK_RELOAD_STATUS;
+   if(Arena->Unhorsed[ARENA_US])
+      *Status |= SIMJSR_HEAD;
+   *Red = Arena->Score[ARENA_US];
+   *Dark = Arena->Score[ARENA_THEM];
+}
+
+/* Function: Lookup
+  -------------------
+  Value of a timeline word.
+*/
+static bool Lookup(const SimJSRWord_t *Words, unsigned char NumWords,
+                   const char *Name, unsigned char *Value)
+{
+   unsigned char i;
+
+   for(i = 0; i < NumWords; i++)
+   {
+      if(strcmp(Words[i].Name, Name) == 0)
+      {
+         *Value = Words[i].Value;
+         return true;
+      }
+   }
+   return false;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
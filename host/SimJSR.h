@@ -0,0 +1,37 @@
+/****************************************************************************
+  Header file for the simulated Joust Status Reporter, an SPI slave on the
+  emulated port (HostHW.c). It follows the arena's referee, or plays a
+  scripted timeline loaded from a file.
+*****************************************************************************/
+#ifndef SimJSR_H
+#define SimJSR_H
+
+#include <stdio.h>
+
+#include "ES_Types.h"
+#include "HostHW.h"
+
+//Status byte bits besides the command (JSRcommand.h has the reload bits)
+#define SIMJSR_HEAD 0x80
+#define SIMJSR_COMMAND 0x0F
+
+//How the master has treated the JSR
+typedef struct
+{
+   unsigned long Queries;
+   unsigned long TooSoon;      //SS asserted under 2ms after release
+   unsigned long TooFast;      //bytes closer than the JSR's clock allows
+   unsigned long BadMode;      //not SPI mode 3
+   unsigned long BadQuery;     //first byte neither query
+} SimJSRStats_t;
+
+extern const HostSPISlave_t SimJSRSlave;
+
+// Public Function Prototypes
+void SimJSRInit(void);
+bool SimJSRLoad(FILE *Timeline, const char *Name);
+unsigned char SimJSRStatus(void);
+SimJSRStats_t SimJSRGetStats(void);
+StateBlock_t SimJSRGetVars(void);
+
+#endif /* SimJSR_H */
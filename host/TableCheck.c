@@ -0,0 +1,348 @@
+/****************************************************************************
+ Module
+   TableCheck.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host check of the tables of the table driven state machines (FSM.c).
+   Starts each service the way ES_Initialize would and checks the rows
+   and cells of every machine it hands to InitFSM:
+
+     - rows or cells naming a row or next state that does not exist, and
+       Else chains that loop (bad)
+     - rows that can never fire, because no cell or Else leads to them, or
+       the row before them in an Else chain has no guard (bad)
+     - states that can not be reached from the initial state (bad)
+     - state x event cells with no row, for the events the table uses;
+       the machine ignores that event in that state
+     - cells whose rows are all guarded, where the event is ignored
+       whenever every guard fails
+
+     TableCheck: InitIR_Detect, 5 states, 8 rows
+       state 0 takes ES_TIMEOUT only through a guard
+       state 4 ignores LeftOnly
+       ...
+     TableCheck: 1 machines, 0 bad
+
+   Exits 1 if any table is bad. Ignored events are only reported, since a
+   machine often means to ignore them.
+
+ Notes
+   Linked with --wrap=InitFSM so the firmware's own InitFSM calls come
+   here first. States and rows are printed by number, rows from 1 as the
+   cells give them, events by their ES_Configure.h names (EventNames.h is
+   made from the event list at build time).
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 05/01/14 09:00 PS      Checks the state x event cells and Else chains
+ 04/30/14 15:00 PS      First pass, replaces the on-target FSM_CHECK_TABLES
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_ServiceHeaders.h"
+#include "ES_Host.h"
+#include "FSM.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_MACHINES 8
+#define STATE_BIT(s) (1u << (s))
+#define NAME(Init) NAME_OF(Init)
+#define NAME_OF(Init) #Init
+
+/*---------------------------- Module Types -------------------------------*/
+typedef bool (*pInitFunc)(uint8_t Priority);
+
+typedef struct
+{
+   const char *Name;
+   pInitFunc Init;
+} TableCheckService_t;
+
+//What a service handed to InitFSM
+typedef struct
+{
+   const char *Service;
+   const FSMRow_t *Rows;
+   unsigned char NumRows;
+   const unsigned char *Cells;
+   unsigned char NumStates;
+   unsigned char Initial;
+} TableCheckMachine_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+bool __real_InitFSM(FSM_t *Machine, const FSMRow_t *Rows,
+                    unsigned char NumRows, const unsigned char *Cells,
+                    unsigned char NumStates, unsigned char Initial);
+bool __wrap_InitFSM(FSM_t *Machine, const FSMRow_t *Rows,
+                    unsigned char NumRows, const unsigned char *Cells,
+                    unsigned char NumStates, unsigned char Initial);
+static unsigned int CheckMachine(const TableCheckMachine_t *Machine);
+static unsigned int CheckRow(const TableCheckMachine_t *Machine,
+                             unsigned char Row, const char *Where);
+static const char *EventName(ES_EventTyp_t Event);
+
+/*---------------------------- Module Variables ---------------------------*/
+static const TableCheckService_t Services[NUM_SERVICES] =
+{
+   {NAME(SERV_0_INIT), SERV_0_INIT},
+#if NUM_SERVICES > 1
+   {NAME(SERV_1_INIT), SERV_1_INIT},
+#endif
+#if NUM_SERVICES > 2
+   {NAME(SERV_2_INIT), SERV_2_INIT},
+#endif
+#if NUM_SERVICES > 3
+   {NAME(SERV_3_INIT), SERV_3_INIT},
+#endif
+#if NUM_SERVICES > 4
+   {NAME(SERV_4_INIT), SERV_4_INIT},
+#endif
+#if NUM_SERVICES > 5
+   {NAME(SERV_5_INIT), SERV_5_INIT},
+#endif
+#if NUM_SERVICES > 6
+   {NAME(SERV_6_INIT), SERV_6_INIT},
+#endif
+#if NUM_SERVICES > 7
+   {NAME(SERV_7_INIT), SERV_7_INIT},
+#endif
+#if NUM_SERVICES > 8
+   {NAME(SERV_8_INIT), SERV_8_INIT},
+#endif
+};
+
+static const char *const EventNames[] =
+{
+#include "EventNames.h"
+};
+
+//Running state, all in one place
+typedef struct
+{
+   const char *Service;        //service being started
+   TableCheckMachine_t Machines[MAX_MACHINES];
+   unsigned char NumMachines;
+} TableCheckVars_t;
+
+static TableCheckVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(void)
+{
+   unsigned char i, Bad = 0;
+
+   if(ARRAY_SIZE(EventNames) != NUM_EVENT_TYPES)
+   {
+      printf("TableCheck: EventNames.h is out of step with ES_Configure.h\n");
+      return 1;
+   }
+   ES_HostReset();
+   for(i = 0; i < NUM_SERVICES; i++)
+   {
+      Vars.Service = Services[i].Name;
+      HostEnterFirmware();
+      Services[i].Init(i);
+      HostLeaveFirmware();
+   }
+
+   for(i = 0; i < Vars.NumMachines; i++)
+   {
+      if(CheckMachine(&Vars.Machines[i]) != 0)
+         Bad++;
+   }
+   printf("TableCheck: %u machines, %u bad\n", Vars.NumMachines, Bad);
+   return (Bad == 0) ? 0 : 1;
+}
+
+/****************************************************************************
+ Function
+   __wrap_InitFSM
+
+ Description
+   Takes the firmware's InitFSM calls: note the table, then start the
+   machine as usual.
+****************************************************************************/
+bool __wrap_InitFSM(FSM_t *Machine, const FSMRow_t *Rows,
+                    unsigned char NumRows, const unsigned char *Cells,
+                    unsigned char NumStates, unsigned char Initial)
+{
+   TableCheckMachine_t *Seen;
+
+   if(Vars.NumMachines < MAX_MACHINES)
+   {
+      Seen = &Vars.Machines[Vars.NumMachines++];
+      Seen->Service = Vars.Service;
+      Seen->Rows = Rows;
+      Seen->NumRows = NumRows;
+      Seen->Cells = Cells;
+      Seen->NumStates = NumStates;
+      Seen->Initial = Initial;
+   }
+   return __real_InitFSM(Machine, Rows, NumRows, Cells, NumStates, Initial);
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: CheckMachine
+  -------------------------
+  Print what is wrong with one machine's tables. Returns the faults that
+  make it bad.
+*/
+static unsigned int CheckMachine(const TableCheckMachine_t *Machine)
+{
+   const FSMRow_t *Rows = Machine->Rows;
+   unsigned int Reached = STATE_BIT(Machine->Initial);
+   unsigned int LastReached = 0, Bad = 0;
+   bool Fires[256] = {false}, Used, Unguarded;
+   unsigned char Row, Steps, s;
+   ES_EventTyp_t Event;
+   char Where[48];
+
+   printf("TableCheck: %s, %u states, %u rows\n", Machine->Service,
+          Machine->NumStates, Machine->NumRows);
+   if(Machine->NumStates == 0 || Machine->NumStates > 16 ||
+      Machine->Initial >= Machine->NumStates)
+   {
+      printf("  initial state %u of %u states\n", Machine->Initial,
+             Machine->NumStates);
+      return 1;
+   }
+
+   for(Row = 1; Row <= Machine->NumRows; Row++)
+   {
+      if(Rows[Row - 1].Next != FSM_SAME_STATE &&
+         Rows[Row - 1].Next >= Machine->NumStates)
+      {
+         printf("  row %u: no state %u\n", Row, Rows[Row - 1].Next);
+         Bad++;
+      }
+      snprintf(Where, sizeof(Where), "row %u: else", Row);
+      Bad += CheckRow(Machine, Rows[Row - 1].Else, Where);
+      if(Rows[Row - 1].Guard == 0 && Rows[Row - 1].Else != FSM_NO_ROW)
+      {
+         printf("  row %u: else never taken, the row has no guard\n", Row);
+         Bad++;
+      }
+   }
+
+   //Every cell, and the Else chain from it
+   for(Event = 0; Event < NUM_EVENT_TYPES; Event++)
+   {
+      Used = false;
+      for(s = 0; s < Machine->NumStates; s++)
+         Used |= (Machine->Cells[Event * Machine->NumStates + s] !=
+                  FSM_NO_ROW);
+      if(!Used)
+         continue;
+      for(s = 0; s < Machine->NumStates; s++)
+      {
+         Row = Machine->Cells[Event * Machine->NumStates + s];
+         snprintf(Where, sizeof(Where), "state %u %s", s, EventName(Event));
+         if(Row == FSM_NO_ROW)
+         {
+            printf("  state %u ignores %s\n", s, EventName(Event));
+            continue;
+         }
+         if(CheckRow(Machine, Row, Where) != 0)
+         {
+            Bad++;
+            continue;
+         }
+         Unguarded = false;
+         for(Steps = 0; Row != FSM_NO_ROW && Row <= Machine->NumRows &&
+             Steps <= Machine->NumRows; Steps++)
+         {
+            Fires[Row] = true;
+            if(Rows[Row - 1].Guard == 0)
+            {
+               Unguarded = true;
+               break;
+            }
+            Row = Rows[Row - 1].Else;
+         }
+         if(Steps > Machine->NumRows)
+         {
+            printf("  %s: else chain loops\n", Where);
+            Bad++;
+         }
+         else if(!Unguarded)
+            printf("  state %u takes %s only through a guard\n", s,
+                   EventName(Event));
+      }
+   }
+   for(Row = 1; Row <= Machine->NumRows; Row++)
+   {
+      if(!Fires[Row])
+      {
+         printf("  row %u: never fires, no cell leads to it\n", Row);
+         Bad++;
+      }
+   }
+
+   //A row taken in a reached state reaches its next state
+   while(Reached != LastReached)
+   {
+      LastReached = Reached;
+      for(Event = 0; Event < NUM_EVENT_TYPES; Event++)
+      {
+         for(s = 0; s < Machine->NumStates; s++)
+         {
+            if((Reached & STATE_BIT(s)) == 0)
+               continue;
+            for(Row = Machine->Cells[Event * Machine->NumStates + s], Steps = 0;
+                Row != FSM_NO_ROW && Row <= Machine->NumRows &&
+                Steps <= Machine->NumRows;
+                Row = Rows[Row - 1].Else, Steps++)
+            {
+               if(Rows[Row - 1].Next < Machine->NumStates)
+                  Reached |= STATE_BIT(Rows[Row - 1].Next);
+               if(Rows[Row - 1].Guard == 0)
+                  break;
+            }
+         }
+      }
+   }
+   for(s = 0; s < Machine->NumStates; s++)
+   {
+      if((Reached & STATE_BIT(s)) == 0)
+      {
+         printf("  state %u: unreachable from state %u\n", s,
+                Machine->Initial);
+         Bad++;
+      }
+   }
+   return Bad;
+}
+
+/* Function: CheckRow
+  ---------------------
+  Print it if Row, named by Where, is neither a row nor FSM_NO_ROW.
+  Returns 1 if so.
+*/
+static unsigned int CheckRow(const TableCheckMachine_t *Machine,
+                             unsigned char Row, const char *Where)
+{
+   if(Row == FSM_NO_ROW || Row <= Machine->NumRows)
+      return 0;
+   printf("  %s: no row %u\n", Where, Row);
+   return 1;
+}
+
+/* Function: EventName
+  ----------------------
+  The event's name from ES_Configure.h.
+*/
+static const char *EventName(ES_EventTyp_t Event)
+{
+   if(Event < ARRAY_SIZE(EventNames))
+      return EventNames[Event];
+   return "?";
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
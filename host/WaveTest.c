@@ -0,0 +1,335 @@
+/****************************************************************************
+ Module
+   WaveTest.c
+
+ Revision
+   1.0.1
+
+ Description
+   Host test of the waveform generator (Waveform.c): plays waveform tables
+   on the emulated TIM0 output compare pins and checks every pin edge
+   against the edges the table calls for, level and time, to within one
+   timer tick. Each case also has to post WaveformDone to its requester
+   and leave the channel idle and low, and a pulse train the timer plays
+   by itself may take no more than its one interrupt. The depot request
+   is started at several points of the counter, before the pulse compare,
+   between it and the period end, past the period end and right at the
+   pulse compare (armed a pass later):
+
+     WaveTest: depot request, 20 edges ok, 1 interrupt
+     ...
+     WaveTest: 7 cases, 126 edges, 0 failed
+
+   Exits 1 if any edge or case failed.
+
+ Notes
+   The edges are taken from the pin hook, at the bus cycle the compare
+   drove the pin. The table's edges are counted from the first edge seen
+   on the pin, so the lead from the start request is not part of the
+   check, only what follows from the table. A pulse train is done at the
+   end of its last pulse, so the low segment after that is not waited
+   for.
+   CheckWaveform is run every STEP_US, more often than the main loop
+   gets to it, so a train armed late is armed on the next pass.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 04/30/14 23:00 PS      Pulse trains the timer plays by itself: start
+                        points around the period, interrupts counted,
+                        edges from the first one seen
+ 04/30/14 13:00 PS      First pass
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+#include <mc9s12e128.h>
+#include <S12E128bits.h>
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "HostHW.h"
+#include "Waveform.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define MAX_EDGES 512
+#define TICK_CYCLES 16ULL        //one TIM0 count at /16
+#define STEP_US 50               //how often the done checker runs
+#define RUN_ON HOST_MS(50)       //watched after the last waveform ends
+#define CASE_LIMIT HOST_MS(5000)
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct
+{
+   unsigned char Level;
+   HostTime_t When;
+} WaveEdge_t;
+
+//Waveforms started on each channel, how long after the case starts (a
+//multiple of STEP_US), and the most interrupts allowed, 0 for any number
+typedef struct
+{
+   const char *Name;
+   const Waveform_t *Wave[NUM_WAVE_CHANNELS];
+   unsigned long StartUs[NUM_WAVE_CHANNELS];
+   unsigned long MaxInterrupts;
+} WaveCase_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool RunCase(const WaveCase_t *Case);
+static unsigned int CheckChannel(const WaveCase_t *Case,
+                                 unsigned char Channel);
+static void PinEdge(unsigned char Timer, unsigned char Channel,
+                    unsigned char Level, HostTime_t When);
+static bool PostDone(ES_Event ThisEvent);
+
+/*---------------------------- Module Variables ---------------------------*/
+//The depot request as IRemitter.c sends it
+static const WaveSegment_t DepotPulse[] =
+{
+   {WAVE_HIGH, 10 * WAVE_COUNTS_PER_MS},
+   {WAVE_LOW,  30 * WAVE_COUNTS_PER_MS}
+};
+static const Waveform_t Depot = {DepotPulse, ARRAY_SIZE(DepotPulse), 10};
+
+//Shortest and longest segments, a level held across two segments, and
+//a compare that wraps the 16 bit counter
+static const WaveSegment_t MixedSegments[] =
+{
+   {WAVE_HIGH, 60},
+   {WAVE_HIGH, 200},
+   {WAVE_LOW,  60},
+   {WAVE_HIGH, 65535},
+   {WAVE_LOW,  1000}
+};
+static const Waveform_t Mixed = {MixedSegments, ARRAY_SIZE(MixedSegments), 3};
+
+//Starts low and ends high, so the final edge low is the generator's own
+static const WaveSegment_t LowFirstSegments[] =
+{
+   {WAVE_LOW,  500},
+   {WAVE_HIGH, 300}
+};
+static const Waveform_t LowFirst =
+   {LowFirstSegments, ARRAY_SIZE(LowFirstSegments), 0};
+
+//The depot request starts at counts 0, 46500, 61500 and 44925, the last
+//within WAVE_LEAD of its pulse compare at 44999. With PT7 playing it is
+//played edge by edge
+static const WaveCase_t Cases[] =
+{
+   {"depot request", {&Depot, 0}, {0, 0}, 1},
+   {"mixed segments", {0, &Mixed}, {0, 0}, 0},
+   {"low first, repeat 0", {&LowFirst, 0}, {0, 0}, 0},
+   {"depot request, after the pulse compare", {&Depot, 0}, {31000, 0}, 1},
+   {"depot request, past the period end", {&Depot, 0}, {41000, 0}, 1},
+   {"depot request, at the pulse compare", {&Depot, 0}, {29950, 0}, 1},
+   {"both channels", {&Depot, &Mixed}, {7000, 0}, 0}
+};
+
+//Running state, all in one place
+typedef struct
+{
+   WaveEdge_t Edges[NUM_WAVE_CHANNELS][MAX_EDGES];
+   unsigned int NumEdges[NUM_WAVE_CHANNELS];
+   unsigned char Done;         //WaveformDone seen, a bit per channel
+   unsigned int Checked;
+} WaveTestVars_t;
+
+static WaveTestVars_t Vars;
+
+/*------------------------------ Module Code ------------------------------*/
+int main(void)
+{
+   unsigned char i, Bad = 0;
+
+   for(i = 0; i < ARRAY_SIZE(Cases); i++)
+   {
+      if(!RunCase(&Cases[i]))
+         Bad++;
+   }
+   printf("WaveTest: %u cases, %u edges, %u failed\n",
+          (unsigned int)ARRAY_SIZE(Cases), Vars.Checked, Bad);
+   return (Bad == 0) ? 0 : 1;
+}
+
+/*----------------------------- Private Functions -------------------------*/
+/* Function: RunCase
+  --------------------
+  Fresh hardware, start each waveform at its time, run until every one
+  has posted WaveformDone and a while after, then check the edges and
+  the interrupts taken.
+*/
+static bool RunCase(const WaveCase_t *Case)
+{
+   unsigned char Wanted = 0, c;
+   unsigned long Us;
+   unsigned int Bad = 0, Edges = 0;
+   HostTime_t EndTime = 0;
+
+   memset(Vars.NumEdges, 0, sizeof(Vars.NumEdges));
+   Vars.Done = 0;
+   HostResetHW();
+   HostSetPinHook(PinEdge);
+   HostEnterFirmware();
+   InitWaveform();
+   HostLeaveFirmware();
+
+   for(Us = 0; HostNow() < CASE_LIMIT; Us += STEP_US)
+   {
+      HostEnterFirmware();
+      for(c = 0; c < NUM_WAVE_CHANNELS; c++)
+      {
+         if(Case->Wave[c] == 0 || Case->StartUs[c] != Us)
+            continue;
+         if(!StartWaveform(c, Case->Wave[c], PostDone))
+         {
+            printf("WaveTest: %s, channel %u would not start\n",
+                   Case->Name, c);
+            Bad++;
+         }
+         Wanted |= 1 << c;
+      }
+      CheckWaveform();
+      HostLeaveFirmware();
+
+      if(EndTime == 0 && Wanted != 0 && Vars.Done == Wanted)
+         EndTime = HostNow() + RUN_ON;
+      if(EndTime != 0 && HostNow() >= EndTime)
+         break;
+      HostAdvance(HostNow() + STEP_US * HOST_CYCLES_PER_US);
+   }
+
+   for(c = 0; c < NUM_WAVE_CHANNELS; c++)
+   {
+      if(Case->Wave[c] == 0)
+         continue;
+      if(!(Vars.Done & (1 << c)))
+      {
+         printf("WaveTest: %s, channel %u never posted WaveformDone\n",
+                Case->Name, c);
+         Bad++;
+      }
+      if(IsWaveformBusy(c) || (PTT & (c == WAVE_PT6 ? BIT6HI : BIT7HI)))
+      {
+         printf("WaveTest: %s, channel %u not left idle and low\n",
+                Case->Name, c);
+         Bad++;
+      }
+      Bad += CheckChannel(Case, c);
+      Edges += Vars.NumEdges[c];
+   }
+   if(Case->MaxInterrupts != 0 && HostInterrupts() > Case->MaxInterrupts)
+   {
+      printf("WaveTest: %s, %lu interrupts, wanted at most %lu\n",
+             Case->Name, HostInterrupts(), Case->MaxInterrupts);
+      Bad++;
+   }
+   if(Bad == 0)
+      printf("WaveTest: %s, %u edges ok, %lu interrupt%s\n", Case->Name,
+             Edges, HostInterrupts(), (HostInterrupts() == 1) ? "" : "s");
+   return Bad == 0;
+}
+
+/* Function: CheckChannel
+  -------------------------
+  Walk the table from the first edge seen and match each change of level
+  against the next edge seen on the pin. Returns the failures, and adds
+  the edges checked to the count.
+*/
+static unsigned int CheckChannel(const WaveCase_t *Case,
+                                 unsigned char Channel)
+{
+   const Waveform_t *Wave = Case->Wave[Channel];
+   const WaveEdge_t *Seen = Vars.Edges[Channel];
+   unsigned int NumSeen = Vars.NumEdges[Channel];
+   unsigned char Repeats = (Wave->Repeat == 0) ? 1 : Wave->Repeat;
+   unsigned char Level = WAVE_LOW, Want, r, s;
+   unsigned long Count = 0, Origin = 0;
+   unsigned int n = 0, Bad = 0;
+   HostTime_t When, Off;
+
+   if(NumSeen == 0)
+   {
+      printf("WaveTest: %s, channel %u no edges\n", Case->Name, Channel);
+      return 1;
+   }
+   //the first edge seen is the end of any low the table starts with
+   for(s = 0; s < Wave->NumSegments &&
+               Wave->Segments[s].Level == WAVE_LOW; s++)
+      Origin += Wave->Segments[s].Duration;
+
+   for(r = 0; r <= Repeats; r++)
+   {
+      for(s = 0; s < Wave->NumSegments; s++)
+      {
+         //one pass past the last repeat, for the final edge low only
+         Want = (r < Repeats) ? Wave->Segments[s].Level : WAVE_LOW;
+         if(Want != Level)
+         {
+            When = Seen[0].When + (Count - Origin) * TICK_CYCLES;
+            Vars.Checked++;
+            if(n >= NumSeen)
+            {
+               printf("WaveTest: %s, channel %u edge %u to %u at %llu "
+                      "missing\n", Case->Name, Channel, n, Want, When);
+               return Bad + 1;
+            }
+            Off = (Seen[n].When > When) ? Seen[n].When - When :
+                                          When - Seen[n].When;
+            if(Seen[n].Level != Want || Off > TICK_CYCLES)
+            {
+               printf("WaveTest: %s, channel %u edge %u to %u at %llu, "
+                      "wanted %u at %llu\n", Case->Name, Channel, n,
+                      Seen[n].Level, Seen[n].When, Want, When);
+               Bad++;
+            }
+            Level = Want;
+            n++;
+         }
+         if(r == Repeats)
+            break;
+         Count += Wave->Segments[s].Duration;
+      }
+   }
+   if(n < NumSeen)
+   {
+      printf("WaveTest: %s, channel %u %u edges past the table's end\n",
+             Case->Name, Channel, NumSeen - n);
+      Bad++;
+   }
+   return Bad;
+}
+
+/* Function: PinEdge
+  --------------------
+  Pin hook: log the edges of the two waveform pins.
+*/
+static void PinEdge(unsigned char Timer, unsigned char Channel,
+                    unsigned char Level, HostTime_t When)
+{
+   unsigned char Wave;
+
+   if(Timer != HOST_TIM0 || (Channel != 6 && Channel != 7))
+      return;
+   Wave = (Channel == 6) ? WAVE_PT6 : WAVE_PT7;
+   if(Vars.NumEdges[Wave] < MAX_EDGES)
+   {
+      Vars.Edges[Wave][Vars.NumEdges[Wave]].Level = Level;
+      Vars.Edges[Wave][Vars.NumEdges[Wave]].When = When;
+      Vars.NumEdges[Wave]++;
+   }
+}
+
+/* Function: PostDone
+  ---------------------
+  Requester of every waveform.
+*/
+static bool PostDone(ES_Event ThisEvent)
+{
+   if(ThisEvent.EventType == WaveformDone)
+      Vars.Done |= 1 << ThisEvent.EventParam;
+   return true;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,11 @@
+/****************************************************************************
+  Host stand-in for the ADS12 A/D library. Readings come from the source
+  installed with HostSetADSource (HostHW.c).
+*****************************************************************************/
+#ifndef ADS12_H
+#define ADS12_H
+
+signed char ADS12_Init(char *Modes);
+short ADS12_ReadADPin(unsigned char Pin);
+
+#endif /* ADS12_H */
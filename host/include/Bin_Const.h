@@ -0,0 +1,4 @@
+/****************************************************************************
+  Host stand-in for Bin_Const.h. Nothing in the firmware uses the binary
+  constants, so it is empty.
+*****************************************************************************/
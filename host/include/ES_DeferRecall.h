@@ -0,0 +1,13 @@
+/****************************************************************************
+  Host copy of the Gen2 framework ES_DeferRecall.h.
+*****************************************************************************/
+#ifndef ES_DEFERRECALL_H
+#define ES_DEFERRECALL_H
+
+#include "ES_Events.h"
+
+bool ES_InitDeferralQueueWith(ES_Event *pBlock, unsigned char BlockSize);
+bool ES_DeferEvent(ES_Event *pBlock, ES_Event Event2Add);
+bool ES_RecallEvents(unsigned char WhichService, ES_Event *pBlock);
+
+#endif /* ES_DEFERRECALL_H */
@@ -0,0 +1,19 @@
+/****************************************************************************
+  Host copy of the Gen2 framework ES_Events.h.
+*****************************************************************************/
+#ifndef ES_EVENTS_H
+#define ES_EVENTS_H
+
+#include "ES_Types.h"
+#include "ES_Configure.h"
+
+typedef struct ES_Event_t
+{
+   ES_EventTyp_t EventType;
+   uint16_t EventParam;
+} ES_Event;
+
+typedef bool PostFunc(ES_Event);
+typedef PostFunc (*pPostFunc);
+
+#endif /* ES_EVENTS_H */
@@ -0,0 +1,29 @@
+/****************************************************************************
+  Host version of the Gen2 framework ES_Framework.h. ES_Run is replaced 
+  by the stepping calls in ES_Host.h.
+*****************************************************************************/
+#ifndef ES_FRAMEWORK_H
+#define ES_FRAMEWORK_H
+
+#include "ES_Configure.h"
+#include "ES_Events.h"
+#include "ES_Timers.h"
+#include "ES_Port.h"
+
+#define ARRAY_SIZE(x) (sizeof(x)/sizeof(x[0]))
+
+typedef enum
+{
+   Success = 0,
+   FailedPost = 1,
+   FailedPointer,
+   FailedIndex,
+   FailedInit
+} ES_Return_t;
+
+ES_Return_t ES_Initialize(TimerRate_t NewRate);
+bool ES_PostAll(ES_Event ThisEvent);
+bool ES_PostToService(uint8_t WhichService, ES_Event TheEvent);
+bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event TheEvent);
+
+#endif /* ES_FRAMEWORK_H */
@@ -0,0 +1,23 @@
+/****************************************************************************
+  Host version of the Gen2 framework ES_Port.h.
+  Interrupt responses only run between calls into the firmware (HostHW.c),
+  so a critical section needs no masking.
+*****************************************************************************/
+#ifndef ES_PORT_H
+#define ES_PORT_H
+
+#include "ES_Types.h"
+
+#define EnterCritical() do { } while(0)
+#define ExitCritical() do { } while(0)
+
+typedef enum
+{
+   ES_Timer_RATE_OFF = 0,
+   ES_Timer_RATE_1mS
+} TimerRate_t;
+
+bool IsNewKeyReady(void);
+char GetNewKey(void);
+
+#endif /* ES_PORT_H */
@@ -0,0 +1,10 @@
+/****************************************************************************
+  Host copy of the Gen2 framework ES_PostList.h. No distribution lists are
+  configured (NUM_DIST_LISTS is 0).
+*****************************************************************************/
+#ifndef ES_POSTLIST_H
+#define ES_POSTLIST_H
+
+#include "ES_Events.h"
+
+#endif /* ES_POSTLIST_H */
@@ -0,0 +1,39 @@
+/****************************************************************************
+  Host copy of the Gen2 framework ES_ServiceHeaders.h: the header of every
+  configured service.
+*****************************************************************************/
+#ifndef ES_SERVICEHEADERS_H
+#define ES_SERVICEHEADERS_H
+
+#include "ES_Configure.h"
+
+#include SERV_0_HEADER
+#if NUM_SERVICES > 1
+#include SERV_1_HEADER
+#endif
+#if NUM_SERVICES > 2
+#include SERV_2_HEADER
+#endif
+#if NUM_SERVICES > 3
+#include SERV_3_HEADER
+#endif
+#if NUM_SERVICES > 4
+#include SERV_4_HEADER
+#endif
+#if NUM_SERVICES > 5
+#include SERV_5_HEADER
+#endif
+#if NUM_SERVICES > 6
+#include SERV_6_HEADER
+#endif
+#if NUM_SERVICES > 7
+#include SERV_7_HEADER
+#endif
+#if NUM_SERVICES > 8
+#include SERV_8_HEADER
+#endif
+#if NUM_SERVICES > 9
+#error Host framework stand-in is set up for at most 9 services
+#endif
+
+#endif /* ES_SERVICEHEADERS_H */
@@ -0,0 +1,29 @@
+/****************************************************************************
+  Host version of the Gen2 framework ES_Timers.h.
+  ES_Timer_GetTime returns unsigned int, 16 bits on the target and 32 
+  here. The host count does not wrap within a run, so differences taken
+  by the firmware match the target's (see mc9s12e128.h).
+*****************************************************************************/
+#ifndef ES_TIMERS_H
+#define ES_TIMERS_H
+
+#include "ES_Events.h"
+
+#define ES_NUM_TIMERS 16
+
+typedef enum
+{
+   ES_Timer_ERR = -1,
+   ES_Timer_ACTIVE = 1,
+   ES_Timer_OK = 0,
+   ES_Timer_NOT_ACTIVE = 0
+} ES_TimerReturn_t;
+
+ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime);
+ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime);
+ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num);
+ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num);
+ES_TimerReturn_t ES_Timer_isActive(uint8_t Num);
+unsigned int ES_Timer_GetTime(void);
+
+#endif /* ES_TIMERS_H */
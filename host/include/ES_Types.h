@@ -0,0 +1,10 @@
+/****************************************************************************
+  Host copy of the Gen2 framework ES_Types.h: fixed width types and bool.
+*****************************************************************************/
+#ifndef ES_TYPES_H
+#define ES_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* ES_TYPES_H */
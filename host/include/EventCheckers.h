@@ -0,0 +1,18 @@
+/****************************************************************************
+  Host version of EventCheckers.h (EVENT_CHECK_HEADER), which is not in the
+  tree: the prototype of every checker in EVENT_CHECK_LIST.
+*****************************************************************************/
+#ifndef EventCheckers_H
+#define EventCheckers_H
+
+#include "ES_Types.h"
+
+bool Check4Keystroke(void);
+bool CheckSPI(void);
+bool CheckIRSensor(void);
+bool Check4RightTape(void);
+bool CheckRamp(void);
+bool CheckWaveform(void);
+bool CheckBattery(void);
+
+#endif /* EventCheckers_H */
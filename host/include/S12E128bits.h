@@ -0,0 +1,25 @@
+/****************************************************************************
+  Host copy of the S12E128bits.h bit masks.
+*****************************************************************************/
+#ifndef S12E128BITS_H
+#define S12E128BITS_H
+
+#define BIT0HI 0x01
+#define BIT1HI 0x02
+#define BIT2HI 0x04
+#define BIT3HI 0x08
+#define BIT4HI 0x10
+#define BIT5HI 0x20
+#define BIT6HI 0x40
+#define BIT7HI 0x80
+
+#define BIT0LO 0xFE
+#define BIT1LO 0xFD
+#define BIT2LO 0xFB
+#define BIT3LO 0xF7
+#define BIT4LO 0xEF
+#define BIT5LO 0xDF
+#define BIT6LO 0xBF
+#define BIT7LO 0x7F
+
+#endif /* S12E128BITS_H */
@@ -0,0 +1,17 @@
+/****************************************************************************
+  Host stand-in for S12eVec.h. Vector numbers are dropped, HostHW.c holds
+  the table of which interrupt response goes with which channel.
+*****************************************************************************/
+#ifndef S12EVEC_H
+#define S12EVEC_H
+
+#define _Vec_spi
+#define _Vec_tim0ch4
+#define _Vec_tim0ch5
+#define _Vec_tim0ch6
+#define _Vec_tim0ch7
+#define _Vec_tim0paovf
+#define _Vec_tim2ch4
+#define _Vec_tim2ch6
+
+#endif /* S12EVEC_H */
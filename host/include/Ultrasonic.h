@@ -0,0 +1,4 @@
+/****************************************************************************
+  Host stand-in for Ultrasonic.h. The ranger module is not in the tree and
+  nothing calls it, so it is empty.
+*****************************************************************************/
@@ -0,0 +1,4 @@
+/****************************************************************************
+  Lower case spelling of ADS12.h, as some modules include it.
+*****************************************************************************/
+#include "ADS12.h"
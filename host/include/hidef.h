@@ -0,0 +1,13 @@
+/****************************************************************************
+  Host stand-in for the CodeWarrior hidef.h. Interrupt responses become
+  plain functions that the hardware emulation (HostHW.c) calls, and the
+  interrupt mask is not needed since they never preempt the main loop.
+*****************************************************************************/
+#ifndef HIDEF_H
+#define HIDEF_H
+
+#define interrupt
+#define EnableInterrupts
+#define DisableInterrupts
+
+#endif /* HIDEF_H */
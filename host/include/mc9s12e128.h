@@ -0,0 +1,311 @@
+/****************************************************************************
+  Host stand-in for mc9s12e128.h, the E128 register map.
+  Every register the firmware uses is a plain variable, defined once in
+  HostHW.c, which keeps the timer counters and the SPI data register up
+  to date around each call into the firmware and acts on what it writes.
+  Bit masks are the real ones.
+  Differences from the part:
+  - 16 bit registers (timer counts and compares, concatenated PWM) are
+    unsigned int, 32 bits here. The free running counters do not wrap
+    within a run, so the firmware's unsigned int differences between two
+    counts or two ES timer times come out the same as the 16 bit ones do
+    on the target. Output compares still match on the low 16 bits, so a
+    count's distance to a compare needs masking to 16 bits. A counter
+    reset by channel 7 (TCRE) does go back to 0.
+  - SPIDR is wider than a byte so a write can be told apart from what
+    was last received (HostHW.c).
+  - Concatenated PWM registers (PWMDTY01 and so on) are separate from the
+    8 bit ones they overlay on the part.
+*****************************************************************************/
+#ifndef MC9S12E128_H
+#define MC9S12E128_H
+
+#ifndef HOST_REG
+#define HOST_REG(Type, Name) extern volatile Type Name;
+#endif
+
+/* Ports */
+HOST_REG(unsigned char, PORTA)
+HOST_REG(unsigned char, DDRA)
+HOST_REG(unsigned char, PORTB)
+HOST_REG(unsigned char, DDRB)
+HOST_REG(unsigned char, PORTE)
+HOST_REG(unsigned char, DDRE)
+HOST_REG(unsigned char, PTT)
+HOST_REG(unsigned char, PTIT)
+HOST_REG(unsigned char, DDRT)
+HOST_REG(unsigned char, PTS)
+HOST_REG(unsigned char, DDRS)
+HOST_REG(unsigned char, PTP)
+HOST_REG(unsigned char, DDRP)
+HOST_REG(unsigned char, PTU)
+HOST_REG(unsigned char, DDRU)
+HOST_REG(unsigned char, PTM)
+HOST_REG(unsigned char, DDRM)
+HOST_REG(unsigned char, PTAD)
+HOST_REG(unsigned char, DDRAD)
+HOST_REG(unsigned char, PTIAD)
+HOST_REG(unsigned char, MODRR)
+
+/* Enhanced capture timers TIM0..TIM2 */
+HOST_REG(unsigned char, TIM0_TIOS)
+HOST_REG(unsigned char, TIM0_TCTL1)
+HOST_REG(unsigned char, TIM0_TCTL2)
+HOST_REG(unsigned char, TIM0_TCTL3)
+HOST_REG(unsigned char, TIM0_TCTL4)
+HOST_REG(unsigned char, TIM0_TIE)
+HOST_REG(unsigned char, TIM0_TFLG1)
+HOST_REG(unsigned char, TIM0_TFLG2)
+HOST_REG(unsigned char, TIM0_TSCR1)
+HOST_REG(unsigned char, TIM0_TSCR2)
+HOST_REG(unsigned char, TIM0_TTOV)
+HOST_REG(unsigned int, TIM0_TCNT)
+HOST_REG(unsigned int, TIM0_TC0)
+HOST_REG(unsigned int, TIM0_TC1)
+HOST_REG(unsigned int, TIM0_TC2)
+HOST_REG(unsigned int, TIM0_TC3)
+HOST_REG(unsigned int, TIM0_TC4)
+HOST_REG(unsigned int, TIM0_TC5)
+HOST_REG(unsigned int, TIM0_TC6)
+HOST_REG(unsigned int, TIM0_TC7)
+HOST_REG(unsigned char, TIM0_OC7M)
+HOST_REG(unsigned char, TIM0_OC7D)
+HOST_REG(unsigned char, TIM0_PACTL)
+HOST_REG(unsigned char, TIM0_PAFLG)
+HOST_REG(unsigned int, TIM0_PACNT)
+
+HOST_REG(unsigned char, TIM1_TIOS)
+HOST_REG(unsigned char, TIM1_TCTL1)
+HOST_REG(unsigned char, TIM1_TCTL2)
+HOST_REG(unsigned char, TIM1_TCTL3)
+HOST_REG(unsigned char, TIM1_TCTL4)
+HOST_REG(unsigned char, TIM1_TIE)
+HOST_REG(unsigned char, TIM1_TFLG1)
+HOST_REG(unsigned char, TIM1_TFLG2)
+HOST_REG(unsigned char, TIM1_TSCR1)
+HOST_REG(unsigned char, TIM1_TSCR2)
+HOST_REG(unsigned char, TIM1_TTOV)
+HOST_REG(unsigned int, TIM1_TCNT)
+HOST_REG(unsigned int, TIM1_TC0)
+HOST_REG(unsigned int, TIM1_TC1)
+HOST_REG(unsigned int, TIM1_TC2)
+HOST_REG(unsigned int, TIM1_TC3)
+HOST_REG(unsigned int, TIM1_TC4)
+HOST_REG(unsigned int, TIM1_TC5)
+HOST_REG(unsigned int, TIM1_TC6)
+HOST_REG(unsigned int, TIM1_TC7)
+
+HOST_REG(unsigned char, TIM2_TIOS)
+HOST_REG(unsigned char, TIM2_TCTL1)
+HOST_REG(unsigned char, TIM2_TCTL2)
+HOST_REG(unsigned char, TIM2_TCTL3)
+HOST_REG(unsigned char, TIM2_TCTL4)
+HOST_REG(unsigned char, TIM2_TIE)
+HOST_REG(unsigned char, TIM2_TFLG1)
+HOST_REG(unsigned char, TIM2_TFLG2)
+HOST_REG(unsigned char, TIM2_TSCR1)
+HOST_REG(unsigned char, TIM2_TSCR2)
+HOST_REG(unsigned char, TIM2_TTOV)
+HOST_REG(unsigned int, TIM2_TCNT)
+HOST_REG(unsigned int, TIM2_TC0)
+HOST_REG(unsigned int, TIM2_TC1)
+HOST_REG(unsigned int, TIM2_TC2)
+HOST_REG(unsigned int, TIM2_TC3)
+HOST_REG(unsigned int, TIM2_TC4)
+HOST_REG(unsigned int, TIM2_TC5)
+HOST_REG(unsigned int, TIM2_TC6)
+HOST_REG(unsigned int, TIM2_TC7)
+
+/* PWM */
+HOST_REG(unsigned char, PWME)
+HOST_REG(unsigned char, PWMPOL)
+HOST_REG(unsigned char, PWMCLK)
+HOST_REG(unsigned char, PWMPRCLK)
+HOST_REG(unsigned char, PWMCAE)
+HOST_REG(unsigned char, PWMCTL)
+HOST_REG(unsigned char, PWMSCLA)
+HOST_REG(unsigned char, PWMSCLB)
+HOST_REG(unsigned char, PWMPER0)
+HOST_REG(unsigned char, PWMPER1)
+HOST_REG(unsigned char, PWMPER2)
+HOST_REG(unsigned char, PWMPER3)
+HOST_REG(unsigned char, PWMPER4)
+HOST_REG(unsigned char, PWMPER5)
+HOST_REG(unsigned int, PWMPER01)
+HOST_REG(unsigned int, PWMPER23)
+HOST_REG(unsigned int, PWMPER45)
+HOST_REG(unsigned char, PWMDTY0)
+HOST_REG(unsigned char, PWMDTY1)
+HOST_REG(unsigned char, PWMDTY2)
+HOST_REG(unsigned char, PWMDTY3)
+HOST_REG(unsigned char, PWMDTY4)
+HOST_REG(unsigned char, PWMDTY5)
+HOST_REG(unsigned int, PWMDTY01)
+HOST_REG(unsigned int, PWMDTY23)
+HOST_REG(unsigned int, PWMDTY45)
+HOST_REG(unsigned char, PWMCNT0)
+HOST_REG(unsigned char, PWMCNT1)
+HOST_REG(unsigned char, PWMCNT2)
+HOST_REG(unsigned char, PWMCNT3)
+HOST_REG(unsigned char, PWMCNT4)
+HOST_REG(unsigned char, PWMCNT5)
+HOST_REG(unsigned int, PWMCNT01)
+HOST_REG(unsigned int, PWMCNT23)
+HOST_REG(unsigned int, PWMCNT45)
+
+/* SPI */
+HOST_REG(unsigned char, SPICR1)
+HOST_REG(unsigned char, SPICR2)
+HOST_REG(unsigned char, SPIBR)
+HOST_REG(unsigned char, SPISR)
+HOST_REG(unsigned int, SPIDR)
+
+/* Timer bits */
+#define _S12_IOS0 0x01
+#define _S12_IOS1 0x02
+#define _S12_IOS2 0x04
+#define _S12_IOS3 0x08
+#define _S12_IOS4 0x10
+#define _S12_IOS5 0x20
+#define _S12_IOS6 0x40
+#define _S12_IOS7 0x80
+#define _S12_C0I 0x01
+#define _S12_C1I 0x02
+#define _S12_C2I 0x04
+#define _S12_C3I 0x08
+#define _S12_C4I 0x10
+#define _S12_C5I 0x20
+#define _S12_C6I 0x40
+#define _S12_C7I 0x80
+#define _S12_C0F 0x01
+#define _S12_C1F 0x02
+#define _S12_C2F 0x04
+#define _S12_C3F 0x08
+#define _S12_C4F 0x10
+#define _S12_C5F 0x20
+#define _S12_C6F 0x40
+#define _S12_C7F 0x80
+#define _S12_TOV0 0x01
+#define _S12_TOV1 0x02
+#define _S12_TOV2 0x04
+#define _S12_TOV3 0x08
+#define _S12_TOV4 0x10
+#define _S12_TOV5 0x20
+#define _S12_TOV6 0x40
+#define _S12_TOV7 0x80
+#define _S12_OM4 0x02
+#define _S12_OL4 0x01
+#define _S12_OM5 0x08
+#define _S12_OL5 0x04
+#define _S12_OM6 0x20
+#define _S12_OL6 0x10
+#define _S12_OM7 0x80
+#define _S12_OL7 0x40
+#define _S12_OM0 0x02
+#define _S12_OL0 0x01
+#define _S12_OM1 0x08
+#define _S12_OL1 0x04
+#define _S12_OM2 0x20
+#define _S12_OL2 0x10
+#define _S12_OM3 0x80
+#define _S12_OL3 0x40
+#define _S12_EDG4B 0x02
+#define _S12_EDG4A 0x01
+#define _S12_EDG5B 0x08
+#define _S12_EDG5A 0x04
+#define _S12_EDG6B 0x20
+#define _S12_EDG6A 0x10
+#define _S12_EDG7B 0x80
+#define _S12_EDG7A 0x40
+#define _S12_EDG0B 0x02
+#define _S12_EDG0A 0x01
+#define _S12_EDG1B 0x08
+#define _S12_EDG1A 0x04
+#define _S12_EDG2B 0x20
+#define _S12_EDG2A 0x10
+#define _S12_EDG3B 0x80
+#define _S12_EDG3A 0x40
+#define _S12_TEN 0x80
+#define _S12_TSFRZ 0x20
+#define _S12_TFFCA 0x10
+#define _S12_TOI 0x80
+#define _S12_TCRE 0x08
+#define _S12_PR2 0x04
+#define _S12_PR1 0x02
+#define _S12_PR0 0x01
+#define _S12_OC7M6 0x40
+#define _S12_OC7M7 0x80
+#define _S12_OC7D6 0x40
+#define _S12_OC7D7 0x80
+#define _S12_PAEN 0x40
+#define _S12_PAMOD 0x20
+#define _S12_PEDGE 0x10
+#define _S12_PAOVI 0x02
+#define _S12_PAI 0x01
+#define _S12_PAOVF 0x02
+#define _S12_PAIF 0x01
+
+/* PWM bits */
+#define _S12_PWME0 0x01
+#define _S12_PWME1 0x02
+#define _S12_PWME2 0x04
+#define _S12_PWME3 0x08
+#define _S12_PWME4 0x10
+#define _S12_PWME5 0x20
+#define _S12_PPOL0 0x01
+#define _S12_PPOL1 0x02
+#define _S12_PPOL2 0x04
+#define _S12_PPOL3 0x08
+#define _S12_PPOL4 0x10
+#define _S12_PPOL5 0x20
+#define _S12_PCLK0 0x01
+#define _S12_PCLK1 0x02
+#define _S12_PCLK2 0x04
+#define _S12_PCLK3 0x08
+#define _S12_PCLK4 0x10
+#define _S12_PCLK5 0x20
+#define _S12_CAE0 0x01
+#define _S12_CAE1 0x02
+#define _S12_CAE2 0x04
+#define _S12_CAE3 0x08
+#define _S12_CAE4 0x10
+#define _S12_CAE5 0x20
+#define _S12_CON45 0x40
+#define _S12_CON23 0x20
+#define _S12_CON01 0x10
+#define _S12_PCKB2 0x40
+#define _S12_PCKB1 0x20
+#define _S12_PCKB0 0x10
+#define _S12_PCKA2 0x04
+#define _S12_PCKA1 0x02
+#define _S12_PCKA0 0x01
+
+/* Port routing */
+#define _S12_MODRR0 0x01
+#define _S12_MODRR1 0x02
+#define _S12_MODRR2 0x04
+
+/* SPI bits */
+#define _S12_SPIE 0x80
+#define _S12_SPE 0x40
+#define _S12_SPTIE 0x20
+#define _S12_MSTR 0x10
+#define _S12_CPOL 0x08
+#define _S12_CPHA 0x04
+#define _S12_SSOE 0x02
+#define _S12_LSBFE 0x01
+#define _S12_MODFEN 0x10
+#define _S12_BIDIROE 0x08
+#define _S12_SPISWAI 0x02
+#define _S12_SPC0 0x01
+#define _S12_SPPR2 0x40
+#define _S12_SPPR1 0x20
+#define _S12_SPPR0 0x10
+#define _S12_SPR2 0x04
+#define _S12_SPR1 0x02
+#define _S12_SPR0 0x01
+#define _S12_SPIF 0x80
+#define _S12_SPTEF 0x20
+#define _S12_MODF 0x10
+
+#endif /* MC9S12E128_H */
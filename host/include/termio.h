@@ -0,0 +1,9 @@
+/****************************************************************************
+  Host stand-in for termio.h. printf goes to stdout through stdio.
+*****************************************************************************/
+#ifndef TERMIO_H
+#define TERMIO_H
+
+#include <stdio.h>
+
+#endif /* TERMIO_H */
@@ -0,0 +1,31 @@
+/****************************************************************************
+  Round scripts for Bot.c (build with ROUND_SCRIPTS="scripts/Joust.h"):
+  every round is an attack with the lance, no shooting and no reload. The
+  flywheels stay off and the turret stays on the opponent in the recess.
+*****************************************************************************/
+static const unsigned char JoustScript[] =
+{
+   RS_TAPE(GREEN),
+   RS_MOTORS_OFF(),
+   RS_HOME_BY(HOME_MARGIN),
+   RS_ALIGN(BOT_FREQ),
+   RS_DRIVE(75),
+   RS_END()
+};
+
+static const unsigned char WatchScript[] =
+{
+   RS_MOTORS_OFF(),
+   RS_ALIGN(BOT_FREQ),
+   RS_END()
+};
+
+static const unsigned char * const RoundScripts[NUM_ROUNDS] =
+{
+   JoustScript, JoustScript, JoustScript, JoustScript
+};
+
+static const unsigned char * const RecessScripts[NUM_ROUNDS] =
+{
+   WatchScript, WatchScript, WatchScript, 0
+};